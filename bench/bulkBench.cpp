@@ -0,0 +1,495 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include "../cmdLogger/blockStore.h"
+#include "../cmdLogger/bulkSink.h"
+#include "../cmdLogger/commandBlock.h"
+#include "../cmdLogger/commandManager.h"
+#include "../cmdLogger/segmentStore.h"
+#include "../cmdReader/commandParser.h"
+#include "../cmdReader/lineScanner.h"
+
+// Набор воспроизводимых замеров bulk: разбор, сборка блоков, сохранение
+// и сквозная обработка потока. Все потоки команд генерируются с фиксированным
+// зерном, поэтому результаты разных сборок сравнимы между собой.
+
+namespace {
+
+std::atomic<size_t> g_allocations{0}; /**< Количество вызовов operator new. */
+
+}
+
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+
+    if (void* ptr = std::malloc(size > 0 ? size : 1)) {
+        return ptr;
+    }
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+namespace {
+
+/**
+ * @brief Вид генерируемого потока команд.
+ */
+enum class StreamKind {
+    Static,  /**< Только статические команды. */
+    Dynamic, /**< Только динамические блоки. */
+    Mixed    /**< Статические команды вперемешку с динамическими блоками. */
+};
+
+/**
+ * @brief Поток команд для замера.
+ */
+struct Workload {
+    std::string name; /**< Название потока. */
+    std::string data; /**< Текст потока. */
+    size_t commands = 0; /**< Количество команд в потоке. */
+};
+
+/**
+ * @brief Результат замера.
+ */
+struct Result {
+    double seconds = 0; /**< Лучшее время выполнения. */
+    size_t commands = 0; /**< Количество обработанных команд. */
+    size_t bytes = 0; /**< Количество обработанных байтов. */
+    size_t allocations = 0; /**< Количество выделений памяти за прогон. */
+};
+
+/**
+ * @brief Параметры запуска замеров.
+ */
+struct BenchOptions {
+    size_t commands = 1000000; /**< Количество команд в потоке. */
+    size_t repeat = 3; /**< Количество повторов замера. */
+    std::string filter; /**< Подстрока названия замера. */
+};
+
+std::string makeCommand(std::mt19937& rng, size_t length, size_t index) {
+    std::string command = "cmd" + std::to_string(index);
+
+    while (command.size() < length) {
+        command.push_back(static_cast<char>('a' + rng() % 26));
+    }
+
+    return command;
+}
+
+Workload makeWorkload(StreamKind kind, size_t commands, size_t length, size_t depth, size_t distinct = 0) {
+    static const char* kNames[] = {"static", "dynamic", "mixed"};
+
+    std::mt19937 rng(20250211);
+    Workload workload;
+    workload.name = std::string(kNames[static_cast<int>(kind)]) + "/len=" + std::to_string(length)
+        + "/depth=" + std::to_string(depth) + (distinct > 0 ? "/distinct=" + std::to_string(distinct) : "");
+
+    // При distinct > 0 команды выбираются из словаря повторяющихся команд
+    auto nextCommand = [&]() {
+        size_t index = workload.commands++;
+
+        if (distinct == 0) {
+            return makeCommand(rng, length, index);
+        }
+
+        std::mt19937 text_rng(static_cast<unsigned>(rng() % distinct));
+        return makeCommand(text_rng, length, 0);
+    };
+
+    while (workload.commands < commands) {
+        bool dynamic = kind == StreamKind::Dynamic || (kind == StreamKind::Mixed && rng() % 5 == 0);
+
+        if (!dynamic) {
+            workload.data += nextCommand() + "\n";
+            continue;
+        }
+
+        size_t levels = std::max<size_t>(depth, 1);
+        size_t count = 1 + rng() % 16;
+
+        for (size_t level = 0; level < levels; ++level) {
+            workload.data += "{\n";
+        }
+
+        for (size_t i = 0; i < count && workload.commands < commands; ++i) {
+            workload.data += nextCommand() + "\n";
+        }
+
+        for (size_t level = 0; level < levels; ++level) {
+            workload.data += "}\n";
+        }
+    }
+
+    return workload;
+}
+
+/**
+ * @brief Получатель событий разбора, который только считает команды.
+ */
+class CountingHandler : public BlockEventHandler {
+public:
+    void onCommand(std::string_view command, bool) override {
+        ++commands;
+        bytes += command.size();
+    }
+
+    void onBlockOpen() override {}
+    void onBlockClose() override {}
+    void onBreak() override {}
+    void onEnd() override {}
+
+    size_t commands = 0;
+    size_t bytes = 0;
+};
+
+/**
+ * @brief Временный каталог, в котором выполняются замеры записи файлов.
+ */
+class TempDir {
+public:
+    TempDir() : previous_(std::filesystem::current_path()) {
+        std::string pattern = (std::filesystem::temp_directory_path() / "bulk_bench_XXXXXX").string();
+
+        if (::mkdtemp(pattern.data()) == nullptr) {
+            throw std::runtime_error("Unable to create temporary directory");
+        }
+
+        path_ = pattern;
+        std::filesystem::current_path(path_);
+    }
+
+    ~TempDir() {
+        std::error_code ec;
+        std::filesystem::current_path(previous_, ec);
+        std::filesystem::remove_all(path_, ec);
+    }
+
+    const std::filesystem::path& path() const {
+        return path_;
+    }
+
+private:
+    std::filesystem::path previous_;
+    std::filesystem::path path_;
+};
+
+Result measure(const BenchOptions& options, size_t commands, size_t bytes, const std::function<void()>& run) {
+    Result result;
+    result.commands = commands;
+    result.bytes = bytes;
+    result.seconds = 1e100;
+
+    for (size_t i = 0; i < std::max<size_t>(options.repeat, 1); ++i) {
+        size_t allocations = g_allocations.load(std::memory_order_relaxed);
+        auto start = std::chrono::steady_clock::now();
+
+        run();
+
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        result.seconds = std::min(result.seconds, elapsed.count());
+        result.allocations = g_allocations.load(std::memory_order_relaxed) - allocations;
+    }
+
+    return result;
+}
+
+void report(const std::string& name, const Result& result) {
+    double seconds = std::max(result.seconds, 1e-9);
+
+    std::printf("%-52s %12.0f cmd/s %10.1f MB/s %8.3f alloc/cmd %9.3f ms\n",
+                name.c_str(),
+                result.commands / seconds,
+                result.bytes / seconds / (1 << 20),
+                result.commands > 0 ? static_cast<double>(result.allocations) / result.commands : 0.0,
+                result.seconds * 1000);
+    std::fflush(stdout);
+}
+
+bool selected(const BenchOptions& options, const std::string& name) {
+    return options.filter.empty() || name.find(options.filter) != std::string::npos;
+}
+
+void benchScanner(const BenchOptions& options, const Workload& workload) {
+    const std::string active = LineScanner::kernelName();
+
+    for (const char* kernel : {"scalar", "sse2", "avx2"}) {
+        std::string name = std::string("scanner/") + kernel + "/" + workload.name;
+
+        if (!selected(options, name) || !LineScanner::setKernel(kernel)) {
+            continue;
+        }
+
+        report(name, measure(options, workload.commands, workload.data.size(), [&] {
+            size_t braces = 0;
+            LineScanner::forEachLine(workload.data.data(), workload.data.size(), [&braces](std::string_view line) {
+                braces += LineScanner::classify(line.data(), line.size()) != LineKind::Command;
+            });
+
+            // Не даем компилятору выбросить разбор
+            if (braces == static_cast<size_t>(-1)) {
+                std::puts("");
+            }
+        }));
+    }
+
+    LineScanner::setKernel(active);
+}
+
+void benchParser(const BenchOptions& options, const Workload& workload) {
+    for (size_t chunk : {size_t(4096), size_t(1) << 20}) {
+        std::string name = "parser/" + workload.name + "/chunk=" + std::to_string(chunk);
+
+        if (!selected(options, name)) {
+            continue;
+        }
+
+        report(name, measure(options, workload.commands, workload.data.size(), [&] {
+            CountingHandler handler;
+            CommandParser parser(handler);
+
+            for (size_t offset = 0; offset < workload.data.size(); offset += chunk) {
+                parser.feed(workload.data.data() + offset, std::min(chunk, workload.data.size() - offset));
+            }
+
+            parser.finish();
+        }));
+    }
+}
+
+void benchManager(const BenchOptions& options, const Workload& workload) {
+    for (size_t block_size : {size_t(1), size_t(10), size_t(100), size_t(1000)}) {
+        std::string name = "manager/" + workload.name + "/N=" + std::to_string(block_size);
+
+        if (!selected(options, name)) {
+            continue;
+        }
+
+        report(name, measure(options, workload.commands, workload.data.size(), [&] {
+            CommandManager manager(block_size, LoggerOptions(), std::make_unique<NullSink>(), std::make_unique<NullSink>());
+            CommandParser parser(manager);
+            parser.feed(workload.data.data(), workload.data.size());
+            parser.finish();
+            manager.finish();
+        }));
+    }
+
+    // Тот же разбор с блоками, хранящими номера команд в словаре
+    for (size_t block_size : {size_t(1), size_t(10), size_t(100), size_t(1000)}) {
+        std::string name = "manager-intern/" + workload.name + "/N=" + std::to_string(block_size);
+
+        if (!selected(options, name)) {
+            continue;
+        }
+
+        LoggerOptions logger;
+        logger.intern = true;
+
+        report(name, measure(options, workload.commands, workload.data.size(), [&] {
+            CommandManager manager(block_size, logger, std::make_unique<NullSink>(), std::make_unique<NullSink>());
+            CommandParser parser(manager);
+            parser.feed(workload.data.data(), workload.data.size());
+            parser.finish();
+            manager.finish();
+        }));
+    }
+
+    // Тот же разбор с приемниками и источником времени, заданными при компиляции
+    for (size_t block_size : {size_t(1), size_t(10), size_t(100), size_t(1000)}) {
+        std::string name = "manager-static/" + workload.name + "/N=" + std::to_string(block_size);
+
+        if (!selected(options, name)) {
+            continue;
+        }
+
+        report(name, measure(options, workload.commands, workload.data.size(), [&] {
+            SilentCommandManager manager(block_size);
+            BasicCommandParser<SilentCommandManager> parser(manager);
+            parser.feed(workload.data.data(), workload.data.size());
+            parser.finish();
+            manager.finish();
+        }));
+    }
+}
+
+void benchSave(const BenchOptions& options) {
+    for (size_t block_size : {size_t(1), size_t(10), size_t(100), size_t(1000)}) {
+        for (size_t length : {size_t(8), size_t(128)}) {
+            std::mt19937 rng(7);
+            size_t blocks = std::max<size_t>(options.commands / block_size / 10, 1);
+            std::vector<CommandBlock> prepared;
+            size_t bytes = 0;
+
+            for (size_t i = 0; i < blocks; ++i) {
+                CommandBlock block;
+
+                for (size_t j = 0; j < block_size; ++j) {
+                    block.AddCommand(Command(makeCommand(rng, length, j)));
+                }
+
+                block.setSequence(i);
+                bytes += block.getBytes().size();
+                prepared.push_back(std::move(block));
+            }
+
+            std::string suffix = "/N=" + std::to_string(block_size) + "/len=" + std::to_string(length);
+
+            if (selected(options, "save/files" + suffix)) {
+                TempDir dir;
+                FileBlockStore store;
+
+                report("save/files" + suffix, measure(options, blocks * block_size, bytes, [&] {
+                    for (const auto& block : prepared) {
+                        store.save(block);
+                    }
+                }));
+            }
+
+            if (selected(options, "save/segments" + suffix)) {
+                TempDir dir;
+
+                report("save/segments" + suffix, measure(options, blocks * block_size, bytes, [&] {
+                    SegmentStore store(dir.path().string(), 64 << 20, 0);
+
+                    for (const auto& block : prepared) {
+                        store.save(block);
+                    }
+
+                    store.flush();
+                }));
+            }
+        }
+    }
+}
+
+void benchEndToEnd(const BenchOptions& options, const Workload& workload) {
+    const char* kSinks[] = {"null", "console", "files", "segments"};
+
+    for (const char* sink : kSinks) {
+        for (bool pipeline : {false, true}) {
+            std::string name = std::string("e2e/") + workload.name + "/" + sink + (pipeline ? "/pipeline" : "/sync");
+
+            if (!selected(options, name)) {
+                continue;
+            }
+
+            TempDir dir;
+            int null_fd = ::open("/dev/null", O_WRONLY | O_CLOEXEC);
+
+            report(name, measure(options, workload.commands, workload.data.size(), [&] {
+                LoggerOptions logger;
+                logger.pipeline = pipeline;
+                logger.segmentDir = dir.path().string();
+                logger.store = std::string(sink) == "segments" ? StoreType::Segments : StoreType::Files;
+
+                std::unique_ptr<BulkSink> console = std::make_unique<NullSink>();
+                std::unique_ptr<BulkSink> files = std::make_unique<NullSink>();
+
+                if (std::string(sink) == "console") {
+                    console = std::make_unique<ConsoleSink>(null_fd);
+                } else if (std::string(sink) != "null") {
+                    files = nullptr;
+                }
+
+                CommandManager manager(10, logger, std::move(console), std::move(files));
+                CommandParser parser(manager);
+                parser.feed(workload.data.data(), workload.data.size());
+                parser.finish();
+                manager.finish();
+            }));
+
+            ::close(null_fd);
+        }
+    }
+}
+
+BenchOptions parseOptions(int argc, char* argv[]) {
+    BenchOptions options;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+
+        if (i + 1 >= argc) {
+            throw std::invalid_argument("Не задано значение параметра " + arg);
+        }
+
+        if (arg == "--commands") {
+            options.commands = std::stoul(argv[++i]);
+        } else if (arg == "--repeat") {
+            options.repeat = std::stoul(argv[++i]);
+        } else if (arg == "--filter") {
+            options.filter = argv[++i];
+        } else {
+            throw std::invalid_argument("Неизвестный параметр: " + arg);
+        }
+    }
+
+    return options;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+
+    try {
+        options = parseOptions(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << "Ошибка: " << e.what() << "\n"
+                  << "Использование: bulk_bench [--commands M] [--repeat R] [--filter TEXT]\n";
+        return 1;
+    }
+
+    try {
+        std::vector<Workload> workloads;
+        workloads.push_back(makeWorkload(StreamKind::Static, options.commands, 8, 0));
+        workloads.push_back(makeWorkload(StreamKind::Static, options.commands, 128, 0));
+        workloads.push_back(makeWorkload(StreamKind::Dynamic, options.commands, 8, 1));
+        workloads.push_back(makeWorkload(StreamKind::Dynamic, options.commands, 8, 16));
+        workloads.push_back(makeWorkload(StreamKind::Mixed, options.commands, 32, 2, 1000));
+        workloads.push_back(makeWorkload(StreamKind::Mixed, options.commands, 32, 2));
+
+        for (const auto& workload : workloads) {
+            benchScanner(options, workload);
+        }
+
+        for (const auto& workload : workloads) {
+            benchParser(options, workload);
+        }
+
+        for (const auto& workload : workloads) {
+            benchManager(options, workload);
+        }
+
+        benchSave(options);
+
+        benchEndToEnd(options, workloads.front());
+        benchEndToEnd(options, workloads.back());
+    } catch (const std::exception& e) {
+        std::cerr << "Ошибка: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
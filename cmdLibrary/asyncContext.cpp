@@ -0,0 +1,49 @@
+#include <chrono>
+#include "../cmdLogger/metrics.h"
+#include "asyncContext.h"
+
+
+AsyncContext::AsyncContext(size_t block_size)
+    : block_size_(block_size), logger_(LoggerRegistry::instance().acquire(block_size)),
+      parser_(events_), context_(logger_.manager) {}
+
+void AsyncContext::receive(const char* data, size_t size) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Metrics& metrics = Metrics::instance();
+
+    auto start = std::chrono::steady_clock::now();
+    parser_.feed(data, size);
+    metrics.parseLatency.record(std::chrono::steady_clock::now() - start);
+    metrics.inputBytes.add(size);
+
+    flushEvents();
+}
+
+void AsyncContext::disconnect() {
+    try {
+        std::lock_guard<std::mutex> lock(mutex_);
+        parser_.finish();
+        flushEvents();
+    } catch (...) {
+        LoggerRegistry::instance().release(block_size_);
+        throw;
+    }
+
+    LoggerRegistry::instance().release(block_size_);
+}
+
+void AsyncContext::flushEvents() {
+    if (events_.empty()) {
+        return;
+    }
+
+    try {
+        std::lock_guard<std::mutex> lock(logger_.mutex);
+        events_.replay(context_);
+    } catch (...) {
+        events_.clear();
+        throw;
+    }
+
+    events_.clear();
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <cstddef>
+#include <mutex>
+#include "../cmdReader/commandParser.h"
+#include "../cmdServer/connectionContext.h"
+#include "eventBuffer.h"
+#include "loggerRegistry.h"
+
+/**
+ * @brief Класс AsyncContext - подключение встраиваемой библиотеки.
+ *
+ * Данные разбираются в буфер событий под блокировкой самого подключения,
+ * после чего события передаются общему менеджеру одной короткой блокировкой
+ * на всю порцию. Под этой блокировкой блоки только собираются и передаются
+ * конвейеру вывода, запись в консоль и файлы идет без нее. Динамические блоки, как и у подключений сервера, у каждого
+ * подключения свои.
+ */
+class AsyncContext {
+public:
+    /**
+     * @brief Конструктор AsyncContext.
+     *
+     * @param block_size Размер статического блока команд.
+     * @throws std::invalid_argument Если размер блока равен 0.
+     */
+    explicit AsyncContext(size_t block_size);
+
+    // Запрещаем копирование и присваивание
+    AsyncContext(const AsyncContext&) = delete;
+    AsyncContext& operator=(const AsyncContext&) = delete;
+
+    /**
+     * @brief Передать порцию данных.
+     *
+     * @param data Данные.
+     * @param size Размер данных.
+     * @throws std::runtime_error Если блок не удается вывести.
+     */
+    void receive(const char* data, size_t size);
+
+    /**
+     * @brief Завершить ввод и освободить общий менеджер.
+     *
+     * Выводит незавершенный динамический блок подключения. Последнее
+     * подключение с данным размером блока выводит и общий статический блок.
+     *
+     * @throws std::runtime_error Если блоки не удается вывести.
+     */
+    void disconnect();
+
+private:
+    /**
+     * @brief Передать накопленные события общему менеджеру.
+     */
+    void flushEvents();
+
+    size_t block_size_; /**< Размер статического блока команд. */
+    LoggerRegistry::SharedLogger& logger_; /**< Общий менеджер. */
+    std::mutex mutex_; /**< Блокировка подключения. */
+    EventBuffer events_; /**< События текущей порции. */
+    CommandParser parser_; /**< Разборщик подключения. */
+    ConnectionContext context_; /**< Динамический блок подключения. */
+};
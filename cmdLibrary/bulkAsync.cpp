@@ -0,0 +1,64 @@
+#include <exception>
+#include <iostream>
+#include <memory>
+#include "asyncContext.h"
+#include "bulkAsync.h"
+
+
+struct bulk_handle {
+    explicit bulk_handle(size_t block_size) : context(block_size) {}
+
+    AsyncContext context; /**< Подключение. */
+};
+
+namespace {
+
+/**
+ * @brief Сообщить об ошибке, которую нельзя передать через интерфейс C.
+ *
+ * @param e Исключение.
+ */
+void reportError(const std::exception& e) {
+    std::cerr << "Ошибка: " << e.what() << std::endl;
+}
+
+}
+
+bulk_handle* bulk_connect(size_t block_size) {
+    try {
+        return new bulk_handle(block_size);
+    } catch (const std::exception& e) {
+        reportError(e);
+        return nullptr;
+    }
+}
+
+int bulk_receive(bulk_handle* handle, const char* data, size_t size) {
+    if (handle == nullptr || (data == nullptr && size > 0)) {
+        return -1;
+    }
+
+    try {
+        handle->context.receive(data, size);
+        return 0;
+    } catch (const std::exception& e) {
+        reportError(e);
+        return -1;
+    }
+}
+
+int bulk_disconnect(bulk_handle* handle) {
+    if (handle == nullptr) {
+        return -1;
+    }
+
+    std::unique_ptr<bulk_handle> owner(handle);
+
+    try {
+        owner->context.disconnect();
+        return 0;
+    } catch (const std::exception& e) {
+        reportError(e);
+        return -1;
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <stddef.h>
+
+/**
+ * @file bulkAsync.h
+ * @brief Встраиваемый интерфейс пакетной обработки команд с совместимостью с C.
+ *
+ * Подключение создается функцией bulk_connect(), данные передаются функцией
+ * bulk_receive() произвольными порциями, bulk_disconnect() завершает ввод
+ * и освобождает подключение. Функции можно вызывать из разных потоков
+ * одновременно, в том числе для одного подключения. Подключения с одинаковым
+ * размером блока собирают статические команды в общие блоки, динамические
+ * блоки у каждого подключения свои. Блоки выводятся в консоль и сохраняются
+ * в файлы так же, как программой bulk.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Непрозрачный описатель подключения.
+ */
+typedef struct bulk_handle bulk_handle;
+
+/**
+ * @brief Создать подключение.
+ *
+ * @param block_size Размер статического блока команд.
+ * @return bulk_handle* Подключение или NULL, если размер блока равен 0.
+ */
+bulk_handle* bulk_connect(size_t block_size);
+
+/**
+ * @brief Передать порцию данных подключению.
+ *
+ * Строка может быть разорвана между порциями.
+ *
+ * @param handle Подключение.
+ * @param data Данные.
+ * @param size Размер данных.
+ * @return int 0 при успехе, -1 при ошибке вывода блоков.
+ */
+int bulk_receive(bulk_handle* handle, const char* data, size_t size);
+
+/**
+ * @brief Завершить ввод и закрыть подключение.
+ *
+ * Выводит незавершенный динамический блок подключения; последнее подключение
+ * с данным размером блока выводит и общий статический блок. После вызова
+ * описатель недействителен.
+ *
+ * @param handle Подключение.
+ * @return int 0 при успехе, -1 при ошибке вывода блоков.
+ */
+int bulk_disconnect(bulk_handle* handle);
+
+#ifdef __cplusplus
+}
+#endif
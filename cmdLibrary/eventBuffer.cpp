@@ -0,0 +1,56 @@
+#include "eventBuffer.h"
+
+
+void EventBuffer::onCommand(std::string_view command, bool isDynamic) {
+    events_.push_back({isDynamic ? EventType::DynamicCommand : EventType::Command, text_.size(), command.size()});
+    text_.append(command);
+}
+
+void EventBuffer::onBlockOpen() {
+    events_.push_back({EventType::BlockOpen, 0, 0});
+}
+
+void EventBuffer::onBlockClose() {
+    events_.push_back({EventType::BlockClose, 0, 0});
+}
+
+void EventBuffer::onBreak() {
+    events_.push_back({EventType::Break, 0, 0});
+}
+
+void EventBuffer::onEnd() {
+    events_.push_back({EventType::End, 0, 0});
+}
+
+void EventBuffer::replay(BlockEventHandler& handler) const {
+    for (const Event& event : events_) {
+        switch (event.type) {
+            case EventType::Command:
+            case EventType::DynamicCommand:
+                handler.onCommand(std::string_view(text_).substr(event.offset, event.size),
+                                  event.type == EventType::DynamicCommand);
+                break;
+            case EventType::BlockOpen:
+                handler.onBlockOpen();
+                break;
+            case EventType::BlockClose:
+                handler.onBlockClose();
+                break;
+            case EventType::Break:
+                handler.onBreak();
+                break;
+            case EventType::End:
+                handler.onEnd();
+                break;
+        }
+    }
+}
+
+void EventBuffer::clear() {
+    text_.clear();
+    events_.clear();
+}
+
+bool EventBuffer::empty() const {
+    return events_.empty();
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "../cmdLogger/blockEventHandler.h"
+
+/**
+ * @brief Класс EventBuffer накапливает события разбора для последующей передачи.
+ *
+ * Позволяет разобрать порцию данных без блокировки, а затем передать все
+ * полученные события общему получателю за одну короткую блокировку.
+ * Тексты команд хранятся подряд в одном буфере.
+ */
+class EventBuffer : public BlockEventHandler {
+public:
+    void onCommand(std::string_view command, bool isDynamic) override;
+    void onBlockOpen() override;
+    void onBlockClose() override;
+    void onBreak() override;
+    void onEnd() override;
+
+    /**
+     * @brief Передать накопленные события получателю в порядке поступления.
+     *
+     * @param handler Получатель событий.
+     */
+    void replay(BlockEventHandler& handler) const;
+
+    /**
+     * @brief Удалить накопленные события, сохранив выделенную память.
+     */
+    void clear();
+
+    /**
+     * @brief Проверить, есть ли накопленные события.
+     *
+     * @return true Если событий нет.
+     */
+    bool empty() const;
+
+private:
+    /**
+     * @brief Тип события разбора.
+     */
+    enum class EventType {
+        Command,
+        DynamicCommand,
+        BlockOpen,
+        BlockClose,
+        Break,
+        End
+    };
+
+    /**
+     * @brief Событие разбора и положение текста команды в буфере.
+     */
+    struct Event {
+        EventType type;
+        size_t offset;
+        size_t size;
+    };
+
+    std::string text_; /**< Тексты команд. */
+    std::vector<Event> events_; /**< События в порядке поступления. */
+};
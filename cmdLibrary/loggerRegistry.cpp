@@ -0,0 +1,76 @@
+#include "loggerRegistry.h"
+
+namespace {
+
+/**
+ * @brief Настройки вывода общих менеджеров: блоки выводятся вне их блокировки.
+ *
+ * @return LoggerOptions Настройки.
+ */
+LoggerOptions libraryOptions() {
+    LoggerOptions options;
+    options.pipeline = true;
+    return options;
+}
+
+}
+
+LoggerRegistry::SharedLogger::SharedLogger(size_t block_size)
+    : manager(block_size, libraryOptions()), connections(0) {}
+
+LoggerRegistry& LoggerRegistry::instance() {
+    static LoggerRegistry registry;
+    return registry;
+}
+
+LoggerRegistry::SharedLogger& LoggerRegistry::acquire(size_t block_size) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    finished_.wait(lock, [&] { return finishing_.count(block_size) == 0; });
+    auto& logger = loggers_[block_size];
+
+    if (!logger) {
+        try {
+            logger = std::make_unique<SharedLogger>(block_size);
+        } catch (...) {
+            loggers_.erase(block_size);
+            throw;
+        }
+    }
+
+    ++logger->connections;
+    return *logger;
+}
+
+void LoggerRegistry::release(size_t block_size) {
+    std::unique_ptr<SharedLogger> finished;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = loggers_.find(block_size);
+
+        if (it == loggers_.end() || --it->second->connections > 0) {
+            return;
+        }
+
+        finished = std::move(it->second);
+        loggers_.erase(it);
+        finishing_.insert(block_size);
+    }
+
+    // Новые подключения с тем же N ждут, пока менеджер выводит оставшиеся блоки
+    auto done = [&] {
+        std::lock_guard<std::mutex> lock(mutex_);
+        finishing_.erase(block_size);
+        finished_.notify_all();
+    };
+
+    try {
+        std::lock_guard<std::mutex> lock(finished->mutex);
+        finished->manager.onEnd();
+        finished->manager.finish();
+    } catch (...) {
+        done();
+        throw;
+    }
+
+    done();
+}
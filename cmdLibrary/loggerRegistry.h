@@ -0,0 +1,88 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include "../cmdLogger/commandManager.h"
+
+/**
+ * @brief Класс LoggerRegistry хранит общие менеджеры команд библиотеки.
+ *
+ * Подключения с одинаковым размером блока N разделяют один CommandManager,
+ * поэтому их статические команды собираются в общие блоки. Подключения
+ * с разными N работают с разными менеджерами и не блокируют друг друга.
+ * Менеджер создается первым подключением и завершается последним.
+ *
+ * Менеджеры выводят блоки через конвейер (LoggerOptions::pipeline), поэтому
+ * под блокировкой менеджера только собираются блоки, а запись в консоль
+ * и файлы идет в потоках конвейера.
+ *
+ * Блокировка менеджера не разделена на части и не заменена безблокировочной
+ * структурой: общие статические блоки требуют единого порядка команд всех
+ * подключений с одним N. Поэтому подключения с одинаковым N (обычный случай
+ * встраивания) конкурируют за одну блокировку; она берется один раз на
+ * порцию данных (AsyncContext), а разбор порции идет без нее.
+ */
+class LoggerRegistry {
+public:
+    /**
+     * @brief Общий менеджер команд и его блокировка.
+     */
+    struct SharedLogger {
+        /**
+         * @brief Конструктор SharedLogger.
+         *
+         * @param block_size Размер статического блока команд.
+         * @throws std::invalid_argument Если размер блока равен 0.
+         */
+        explicit SharedLogger(size_t block_size);
+
+        std::mutex mutex; /**< Блокировка менеджера. */
+        CommandManager manager; /**< Менеджер команд. */
+        size_t connections; /**< Количество подключений, защищено блокировкой реестра. */
+    };
+
+    /**
+     * @brief Получить единственный экземпляр реестра.
+     *
+     * @return LoggerRegistry& Реестр.
+     */
+    static LoggerRegistry& instance();
+
+    // Запрещаем копирование и присваивание
+    LoggerRegistry(const LoggerRegistry&) = delete;
+    LoggerRegistry& operator=(const LoggerRegistry&) = delete;
+
+    /**
+     * @brief Получить менеджер для нового подключения.
+     *
+     * Если менеджер с тем же размером блока еще завершается, ждет окончания
+     * его вывода, чтобы два менеджера не выводили блоки одновременно.
+     *
+     * @param block_size Размер статического блока команд.
+     * @return SharedLogger& Общий менеджер.
+     * @throws std::invalid_argument Если размер блока равен 0.
+     */
+    SharedLogger& acquire(size_t block_size);
+
+    /**
+     * @brief Освободить менеджер при закрытии подключения.
+     *
+     * Если подключение было последним, менеджер выводит оставшиеся блоки,
+     * дожидается их записи и удаляется.
+     *
+     * @param block_size Размер статического блока команд.
+     * @throws std::runtime_error Если оставшиеся блоки не удается вывести.
+     */
+    void release(size_t block_size);
+
+private:
+    LoggerRegistry() = default;
+
+    std::mutex mutex_; /**< Блокировка реестра. */
+    std::condition_variable finished_; /**< Сигнал о завершении менеджера. */
+    std::unordered_map<size_t, std::unique_ptr<SharedLogger>> loggers_; /**< Менеджеры по размеру блока. */
+    std::unordered_set<size_t> finishing_; /**< Размеры блока завершающихся менеджеров. */
+};
@@ -0,0 +1,44 @@
+#pragma once
+#include <string_view>
+
+/**
+ * @brief Класс BlockEventHandler - получатель событий разбора команд.
+ * 
+ * События порождает CommandParser. Вложенные скобки обрабатываются
+ * разборщиком, поэтому onBlockOpen() и onBlockClose() вызываются только
+ * для внешнего динамического блока.
+ */
+class BlockEventHandler {
+public:
+    virtual ~BlockEventHandler() = default;
+
+    /**
+     * @brief Получена команда.
+     * 
+     * Текст действителен только во время вызова.
+     * 
+     * @param command Текст команды.
+     * @param isDynamic Флаг команды внутри динамического блока.
+     */
+    virtual void onCommand(std::string_view command, bool isDynamic) = 0;
+
+    /**
+     * @brief Начался динамический блок.
+     */
+    virtual void onBlockOpen() = 0;
+
+    /**
+     * @brief Закончился динамический блок.
+     */
+    virtual void onBlockClose() = 0;
+
+    /**
+     * @brief Получена пустая строка вне динамического блока.
+     */
+    virtual void onBreak() = 0;
+
+    /**
+     * @brief Ввод закончился.
+     */
+    virtual void onEnd() = 0;
+};
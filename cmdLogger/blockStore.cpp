@@ -0,0 +1,213 @@
+#include <algorithm>
+#include <cerrno>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <system_error>
+#include <fcntl.h>
+#include <unistd.h>
+#include "blockStore.h"
+#include "commandBlock.h"
+#include "gzipCompressor.h"
+#include "ioVector.h"
+#include "metrics.h"
+#include "segmentStore.h"
+
+
+FileBlockStore::FileBlockStore(bool durable, std::unique_ptr<UringWriter> uring, int compress_level,
+                               std::unique_ptr<TimeIndex> index)
+    : durable_(durable), compress_level_(compress_level), uring_(std::move(uring)), index_(std::move(index)) {}
+
+void FileBlockStore::save(const CommandBlock& block) {
+    std::string filename = block.getFileName();
+    size_t length = block.getByteSize();
+
+    if (compress_level_ > 0) {
+        filename += ".gz";
+        std::string_view data = GzipCompressor::forThread(compress_level_).compress(std::string_view(), block);
+        Metrics::instance().compressedBytes.add(data.size());
+        writeFile(filename, data);
+        length = data.size();
+    } else if (!uring_ || !block.hasContiguousBytes()) {
+        // Выгруженный блок и блок в режиме словаря читаются порциями синхронно
+        std::lock_guard<std::mutex> lock(fileMutex(filename));
+        block.saveToFile();
+    } else {
+        writeFile(filename, block.getBytes());
+    }
+
+    if (index_) {
+        TimeIndex::Entry part;
+        part.minTs = part.maxTs = part.fileTs = block.getBlockStartTimeSeconds();
+        part.fileSeq = block.getSequence();
+        part.length = length;
+        part.flags = compress_level_ > 0 ? TimeIndex::kCompressed : 0;
+        part.blocks = 1;
+        index_->add(part);
+    }
+
+    if (durable_) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        unsynced_.push_back(filename);
+    }
+}
+
+void FileBlockStore::writeFile(const std::string& filename, std::string_view data) {
+    std::lock_guard<std::mutex> file_lock(fileMutex(filename));
+
+    if (!uring_) {
+        int fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+        if (fd < 0) {
+            throw std::runtime_error("Unable to open file: " + filename);
+        }
+
+        try {
+            IoVector iov;
+            iov.add(data);
+            iov.writeTo(fd);
+        } catch (...) {
+            ::close(fd);
+            throw;
+        }
+
+        ::close(fd);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(uring_mutex_);
+
+    if (uring_->idle()) {
+        uring_files_.clear();
+    }
+
+    // Усечение файла при открытии не должно обогнать незавершенную запись в него
+    if (!uring_files_.insert(filename).second) {
+        uring_->waitAll();
+        uring_files_.clear();
+        uring_files_.insert(filename);
+    }
+
+    int fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+    if (fd < 0) {
+        throw std::runtime_error("Unable to open file: " + filename);
+    }
+
+    try {
+        uring_->write(fd, 0, data, {}, true);
+    } catch (...) {
+        ::close(fd);
+        throw;
+    }
+}
+
+std::mutex& FileBlockStore::fileMutex(const std::string& filename) {
+    return file_mutexes_[std::hash<std::string>{}(filename) % kFileMutexes];
+}
+
+void FileBlockStore::flush() {
+    if (uring_) {
+        std::lock_guard<std::mutex> lock(uring_mutex_);
+        uring_->waitAll();
+    }
+
+    if (index_) {
+        index_->flush();
+    }
+}
+
+void FileBlockStore::submit() {
+    if (uring_) {
+        std::lock_guard<std::mutex> lock(uring_mutex_);
+        uring_->submit();
+    }
+}
+
+void FileBlockStore::sync() {
+    // Сбрасывать можно только завершенные записи
+    flush();
+
+    std::vector<std::string> files;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        files.swap(unsynced_);
+    }
+
+    if (files.empty()) {
+        return;
+    }
+
+    // Блоки одной секунды пишутся в один файл
+    std::sort(files.begin(), files.end());
+    files.erase(std::unique(files.begin(), files.end()), files.end());
+
+    for (const auto& file : files) {
+        int fd = ::open(file.c_str(), O_RDONLY | O_CLOEXEC);
+
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "Unable to open file " + file);
+        }
+
+        if (::fdatasync(fd) != 0) {
+            int error = errno;
+            ::close(fd);
+            throw std::system_error(error, std::generic_category(), "fdatasync " + file);
+        }
+
+        ::close(fd);
+    }
+
+    syncDirectory(".");
+
+    // Индекс сбрасывается после данных, чтобы не ссылаться на несохраненные файлы
+    if (index_) {
+        index_->sync();
+    }
+}
+
+void syncDirectory(const std::string& dir) {
+    int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+
+    if (fd < 0) {
+        throw std::system_error(errno, std::generic_category(), "Unable to open directory " + dir);
+    }
+
+    if (::fsync(fd) != 0) {
+        int error = errno;
+        ::close(fd);
+        throw std::system_error(error, std::generic_category(), "fsync " + dir);
+    }
+
+    ::close(fd);
+}
+
+std::unique_ptr<BlockStore> makeBlockStore(const LoggerOptions& options) {
+    std::unique_ptr<UringWriter> uring;
+    int compressLevel = options.compression == Compression::Zlib ? options.compressLevel : 0;
+    std::unique_ptr<TimeIndex> index;
+
+    if (options.index) {
+        index = std::make_unique<TimeIndex>(options.store == StoreType::Segments ? options.segmentDir : ".");
+    }
+
+    if (options.ioBackend == IoBackend::Uring) {
+        uring = UringWriter::tryCreate(static_cast<unsigned>(options.uringDepth));
+
+        if (!uring) {
+            std::cerr << "io_uring is unavailable, falling back to synchronous writes" << std::endl;
+        }
+    }
+
+    switch (options.store) {
+    case StoreType::Segments:
+        return std::make_unique<SegmentStore>(options.segmentDir, options.segmentSize, options.segmentAge,
+                                              options.durability != Durability::None, std::move(uring), compressLevel,
+                                              std::move(index));
+    case StoreType::Files:
+    default:
+        return std::make_unique<FileBlockStore>(options.durability != Durability::None, std::move(uring), compressLevel,
+                                                std::move(index));
+    }
+}
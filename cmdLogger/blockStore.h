@@ -0,0 +1,145 @@
+#pragma once
+#include <array>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+#include "commandBlock.h"
+#include "loggerOptions.h"
+#include "timeIndex.h"
+#include "uringWriter.h"
+
+/**
+ * @brief Класс BlockStore - интерфейс хранилища выведенных блоков команд.
+ * 
+ * Реализации должны допускать вызов save() из нескольких потоков записи.
+ */
+class BlockStore {
+public:
+    virtual ~BlockStore() = default;
+
+    /**
+     * @brief Сохранить блок команд.
+     * 
+     * @param block Блок команд.
+     * @throws std::runtime_error Если блок не удается сохранить.
+     */
+    virtual void save(const CommandBlock& block) = 0;
+
+    /**
+     * @brief Завершить запись всех сохраненных блоков.
+     * 
+     * @throws std::runtime_error Если данные не удается записать.
+     */
+    virtual void flush() {}
+
+    /**
+     * @brief Передать системе накопленные асинхронные записи без ожидания.
+     * 
+     * Вызывается после сохранения очередной группы блоков.
+     * 
+     * @throws std::system_error Если предыдущая запись завершилась ошибкой.
+     */
+    virtual void submit() {}
+
+    /**
+     * @brief Сбросить на диск все сохраненные блоки.
+     * 
+     * После возврата блоки, сохраненные до вызова, переживают аварийное
+     * завершение процесса и системы.
+     * 
+     * @throws std::system_error Если данные не удается сбросить на диск.
+     */
+    virtual void sync() {}
+};
+
+/**
+ * @brief Класс FileBlockStore сохраняет каждый блок в отдельный файл bulk<время>.log.
+ * 
+ * Если включено отслеживание, имена записанных файлов запоминаются до вызова
+ * sync(), который сбрасывает на диск каждый файл и затем каталог.
+ * 
+ * С UringWriter файл открывается синхронно, а запись и закрытие ставятся
+ * в очередь io_uring связанной парой и выполняются асинхронно.
+ * При сжатии блок записывается в файл bulk<время>.log.gz из одного члена gzip;
+ * сжатие выполняется в потоке, вызвавшем save().
+ * С индексом TimeIndex каждый записанный файл добавляется в индекс отдельным участком.
+ * 
+ * Блоки одной секунды попадают в один файл. Запись файла выполняется под
+ * мьютексом, выбранным по имени, поэтому потоки записи не перемешивают
+ * содержимое двух блоков: файл целиком содержит последний записанный блок.
+ * Асинхронная запись в файл, запись в который еще выполняется, сначала
+ * дожидается завершения поставленных операций.
+ */
+class FileBlockStore : public BlockStore {
+public:
+    /**
+     * @brief Конструктор FileBlockStore.
+     * 
+     * @param durable Запоминать записанные файлы для sync().
+     * @param uring Асинхронная запись, nullptr - блокирующая запись.
+     * @param compress_level Уровень сжатия zlib, 0 - без сжатия.
+     * @param index Индекс блоков по времени, nullptr - без индекса.
+     */
+    explicit FileBlockStore(bool durable = false, std::unique_ptr<UringWriter> uring = nullptr, int compress_level = 0,
+                            std::unique_ptr<TimeIndex> index = nullptr);
+
+    void save(const CommandBlock& block) override;
+
+    void flush() override;
+
+    void submit() override;
+
+    void sync() override;
+
+private:
+    /**
+     * @brief Записать данные в новый файл.
+     * 
+     * @param filename Имя файла.
+     * @param data Содержимое файла.
+     * @throws std::runtime_error Если файл не удается открыть.
+     * @throws std::system_error Если данные не удается записать.
+     */
+    void writeFile(const std::string& filename, std::string_view data);
+
+    /**
+     * @brief Получить мьютекс записи файла.
+     * 
+     * @param filename Имя файла.
+     * @return std::mutex& Мьютекс, общий для всех записей файла с этим именем.
+     */
+    std::mutex& fileMutex(const std::string& filename);
+
+    static constexpr size_t kFileMutexes = 64; /**< Количество мьютексов записи файлов. */
+
+    bool durable_; /**< Запоминать записанные файлы. */
+    int compress_level_; /**< Уровень сжатия, 0 - без сжатия. */
+    std::mutex uring_mutex_; /**< Мьютекс асинхронной записи. */
+    std::unique_ptr<UringWriter> uring_; /**< Асинхронная запись. */
+    std::unordered_set<std::string> uring_files_; /**< Файлы с асинхронными записями, поставленными после последнего ожидания. */
+    std::unique_ptr<TimeIndex> index_; /**< Индекс блоков по времени. */
+    std::array<std::mutex, kFileMutexes> file_mutexes_; /**< Мьютексы записи файлов, выбираемые по имени. */
+    std::mutex mutex_; /**< Мьютекс списка файлов. */
+    std::vector<std::string> unsynced_; /**< Файлы, записанные после последнего sync(). */
+};
+
+/**
+ * @brief Сбросить на диск запись каталога.
+ * 
+ * Нужно, чтобы созданные в каталоге файлы не пропали после сбоя.
+ * 
+ * @param dir Путь к каталогу.
+ * @throws std::system_error Если каталог не удается сбросить.
+ */
+void syncDirectory(const std::string& dir);
+
+/**
+ * @brief Создать хранилище блоков по настройкам вывода.
+ * 
+ * @param options Настройки вывода.
+ * @return std::unique_ptr<BlockStore> Хранилище блоков.
+ */
+std::unique_ptr<BlockStore> makeBlockStore(const LoggerOptions& options);
@@ -0,0 +1,152 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief Действие при заполненной очереди приемника.
+ */
+enum class OverflowPolicy {
+    Block,      /**< Ждать освобождения места. */
+    DropOldest, /**< Вытеснить самый старый элемент. */
+    Sample      /**< Принять каждый K-й элемент, вытеснив самый старый, остальные отбросить. */
+};
+
+/**
+ * @brief Класс BoundedQueue - ограниченная очередь многих производителей и потребителей.
+ *
+ * В отличие от MpscRing очередь защищена мьютексом: вытеснение старых
+ * элементов производителем и несколько потребителей требуют общего замка.
+ * Очередь предназначена для пачек, а не отдельных команд, поэтому замок
+ * берется один раз на пачку и на пачку извлекаемых элементов.
+ *
+ * close() вызывается после того, как производители закончили работу;
+ * потребители забирают оставшиеся элементы, после чего popBatch() возвращает 0.
+ *
+ * @tparam T Тип элементов, должен иметь перемещение.
+ */
+template <typename T>
+class BoundedQueue {
+public:
+    /**
+     * @brief Конструктор BoundedQueue.
+     *
+     * @param capacity Емкость, не меньше 1.
+     * @param policy Действие при заполненной очереди.
+     * @param sample_every Каждый какой элемент принимается при OverflowPolicy::Sample.
+     */
+    explicit BoundedQueue(size_t capacity = 1024, OverflowPolicy policy = OverflowPolicy::Block, size_t sample_every = 10)
+        : capacity_(capacity > 0 ? capacity : 1), policy_(policy), sample_every_(sample_every > 0 ? sample_every : 1) {}
+
+    // Запрещаем копирование и присваивание
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    /**
+     * @brief Добавить элемент в очередь.
+     *
+     * @param value Добавляемый элемент.
+     * @return size_t Количество потерянных элементов: отброшенный новый или вытесненный старый (0 или 1).
+     */
+    size_t push(T value) {
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        if (policy_ == OverflowPolicy::Block) {
+            not_full_.wait(lock, [this]() { return closed_ || items_.size() < capacity_; });
+        }
+
+        if (closed_) {
+            return 1;
+        }
+
+        size_t lost = 0;
+
+        if (items_.size() >= capacity_) {
+            if (policy_ == OverflowPolicy::Sample && ++overflows_ % sample_every_ != 0) {
+                return 1;
+            }
+
+            items_.pop_front();
+            lost = 1;
+        }
+
+        items_.push_back(std::move(value));
+        lock.unlock();
+        not_empty_.notify_one();
+
+        return lost;
+    }
+
+    /**
+     * @brief Извлечь пачку элементов, ожидая появления хотя бы одного.
+     *
+     * @param out Вектор, в конец которого добавляются элементы.
+     * @param max Наибольшее количество элементов.
+     * @return size_t Количество извлеченных элементов, 0 - очередь закрыта и пуста.
+     */
+    size_t popBatch(std::vector<T>& out, size_t max) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_empty_.wait(lock, [this]() { return closed_ || !items_.empty(); });
+
+        size_t count = 0;
+
+        while (count < max && !items_.empty()) {
+            out.push_back(std::move(items_.front()));
+            items_.pop_front();
+            ++count;
+        }
+
+        lock.unlock();
+
+        if (count > 0 && policy_ == OverflowPolicy::Block) {
+            not_full_.notify_all();
+        }
+
+        return count;
+    }
+
+    /**
+     * @brief Закрыть очередь и разбудить всех ожидающих.
+     */
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+
+        not_empty_.notify_all();
+        not_full_.notify_all();
+    }
+
+    /**
+     * @brief Получить количество элементов в очереди.
+     *
+     * @return size_t Количество элементов.
+     */
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return items_.size();
+    }
+
+    /**
+     * @brief Получить емкость очереди.
+     *
+     * @return size_t Емкость.
+     */
+    size_t capacity() const {
+        return capacity_;
+    }
+
+private:
+    const size_t capacity_; /**< Емкость. */
+    const OverflowPolicy policy_; /**< Действие при заполненной очереди. */
+    const size_t sample_every_; /**< Каждый какой элемент принимается при переполнении в режиме Sample. */
+    mutable std::mutex mutex_; /**< Мьютекс очереди. */
+    std::condition_variable not_empty_; /**< Сигнал появления элемента. */
+    std::condition_variable not_full_; /**< Сигнал освобождения места. */
+    std::deque<T> items_; /**< Элементы. */
+    size_t overflows_ = 0; /**< Элементов, пришедших в заполненную очередь, в режиме Sample. */
+    bool closed_ = false; /**< Очередь закрыта. */
+};
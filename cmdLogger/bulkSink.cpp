@@ -0,0 +1,217 @@
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "blockStore.h"
+#include "bulkSink.h"
+#include "commandBlock.h"
+#include "ioVector.h"
+#include "metrics.h"
+
+namespace {
+
+constexpr std::string_view kBulkPrefix = "bulk: ";
+constexpr std::string_view kSeparator = ", ";
+constexpr std::string_view kLineEnd = "\n";
+constexpr size_t kStreamChunk = 64 * 1024; /**< Размер порции вывода пачки с выгруженными блоками. */
+
+}
+
+ConsoleSink::ConsoleSink(int fd, bool socket) : fd_(fd), socket_(socket) {}
+
+void ConsoleSink::write(const Bulk& bulk) {
+    for (const auto& block : bulk) {
+        if (!block.hasContiguousBytes()) {
+            writeStreaming(bulk);
+            return;
+        }
+    }
+
+    iov_.clear();
+    format(iov_, bulk);
+    writeOut();
+}
+
+void ConsoleSink::writeOut() {
+    if (socket_) {
+        iov_.sendTo(fd_);
+        return;
+    }
+
+    Metrics::instance().consoleBytes.add(iov_.size());
+    iov_.writeTo(fd_);
+}
+
+void ConsoleSink::format(IoVector& iov, const Bulk& bulk) {
+    bool start = true;
+    iov.add(kBulkPrefix);
+
+    for (const auto& block : bulk) {
+        for (const auto& command : block) {
+            if (!start) {
+                iov.add(kSeparator);
+            }
+
+            iov.add(command.GetContent());
+            start = false;
+        }
+    }
+
+    iov.add(kLineEnd);
+}
+
+void ConsoleSink::writeStreaming(const Bulk& bulk) {
+    std::string buffer(kBulkPrefix);
+    bool start = true;
+
+    auto flushBuffer = [this, &buffer]() {
+        iov_.clear();
+        iov_.add(buffer);
+        writeOut();
+        buffer.clear();
+    };
+
+    for (const auto& block : bulk) {
+        block.forEachCommandPiece([&](std::string_view piece, bool command_start) {
+            if (command_start && !start) {
+                buffer += kSeparator;
+            }
+
+            buffer += piece;
+            start = false;
+
+            if (buffer.size() >= kStreamChunk) {
+                flushBuffer();
+            }
+        });
+    }
+
+    buffer += kLineEnd;
+    flushBuffer();
+}
+
+StoreSink::StoreSink(std::unique_ptr<BlockStore> store) : store_(std::move(store)) {}
+
+void StoreSink::write(const Bulk& bulk) {
+    Metrics& metrics = Metrics::instance();
+
+    for (const auto& block : bulk) {
+        auto start = std::chrono::steady_clock::now();
+        store_->save(block);
+        metrics.writeLatency.record(std::chrono::steady_clock::now() - start);
+        metrics.storeBytes.add(block.getByteSize());
+    }
+}
+
+void StoreSink::flush() {
+    store_->flush();
+}
+
+void StoreSink::submit() {
+    store_->submit();
+}
+
+void StoreSink::sync() {
+    store_->sync();
+}
+
+ForwardSink::ForwardSink(std::string path) : path_(std::move(path)) {}
+
+ForwardSink::~ForwardSink() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+void ForwardSink::write(const Bulk& bulk) {
+    if (fd_ < 0 && !connect()) {
+        Metrics::instance().forwardLost.add();
+        return;
+    }
+
+    try {
+        line_->write(bulk);
+    } catch (const std::exception& e) {
+        std::cerr << "Forwarding to " << path_ << " failed: " << e.what() << std::endl;
+        Metrics::instance().forwardLost.add();
+        disconnect();
+    }
+}
+
+bool ForwardSink::connect() {
+    auto now = std::chrono::steady_clock::now();
+
+    if (now < next_attempt_) {
+        return false;
+    }
+
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+
+    if (path_.size() >= sizeof(addr.sun_path)) {
+        if (!reported_) {
+            std::cerr << "Forwarding socket path is too long: " << path_ << std::endl;
+            reported_ = true;
+        }
+
+        next_attempt_ = now + kReconnectDelay;
+        return false;
+    }
+
+    std::memcpy(addr.sun_path, path_.c_str(), path_.size() + 1);
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+    if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        int error = errno;
+
+        if (fd >= 0) {
+            ::close(fd);
+        }
+
+        if (!reported_) {
+            std::cerr << "Unable to connect to " << path_ << ": " << std::strerror(error) << std::endl;
+            reported_ = true;
+        }
+
+        next_attempt_ = now + kReconnectDelay;
+        return false;
+    }
+
+    // Получатель, переставший читать, считается отключенным и не задерживает завершение
+    timeval timeout{};
+    timeout.tv_sec = kSendTimeout.count();
+    ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    fd_ = fd;
+    line_ = std::make_unique<ConsoleSink>(fd_, true);
+    reported_ = false;
+    return true;
+}
+
+void ForwardSink::disconnect() {
+    ::close(fd_);
+    fd_ = -1;
+    line_.reset();
+    next_attempt_ = std::chrono::steady_clock::now() + kReconnectDelay;
+}
+
+std::unique_ptr<BulkSink> makeSink(const SinkOptions& sink, const LoggerOptions& options) {
+    switch (sink.type) {
+    case SinkType::Store:
+        return std::make_unique<StoreSink>(makeBlockStore(options));
+    case SinkType::Forward:
+        return std::make_unique<ForwardSink>(sink.address);
+    case SinkType::Null:
+        return std::make_unique<NullSink>();
+    case SinkType::Console:
+    default:
+        return std::make_unique<ConsoleSink>();
+    }
+}
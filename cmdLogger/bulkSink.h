@@ -0,0 +1,190 @@
+#pragma once
+#include <chrono>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unistd.h>
+#include "blockStore.h"
+#include "commandBlock.h"
+#include "ioVector.h"
+#include "loggerOptions.h"
+
+/**
+ * @brief Класс BulkSink - интерфейс приемника выведенных пачек блоков.
+ */
+class BulkSink {
+public:
+    virtual ~BulkSink() = default;
+
+    /**
+     * @brief Вывести пачку блоков.
+     * 
+     * @param bulk Пачка блоков.
+     * @throws std::runtime_error Если пачку не удается вывести.
+     */
+    virtual void write(const Bulk& bulk) = 0;
+
+    /**
+     * @brief Завершить вывод всех пачек.
+     * 
+     * @throws std::runtime_error Если данные не удается записать.
+     */
+    virtual void flush() {}
+
+    /**
+     * @brief Передать системе накопленные асинхронные записи без ожидания.
+     * 
+     * @throws std::system_error Если предыдущая запись завершилась ошибкой.
+     */
+    virtual void submit() {}
+
+    /**
+     * @brief Сбросить на диск все выведенные пачки.
+     * 
+     * @throws std::system_error Если данные не удается сбросить на диск.
+     */
+    virtual void sync() {}
+};
+
+/**
+ * @brief Класс ConsoleSink печатает пачку одной строкой "bulk: a, b, c".
+ * 
+ * Строка не собирается в промежуточный буфер: фрагменты iovec ссылаются
+ * на текст команд в хранилищах блоков и выводятся одним вызовом writev.
+ * Пачка с выгруженными блоками читается из временных файлов и выводится
+ * через ограниченный буфер несколькими вызовами.
+ * Экземпляр не потокобезопасен и используется одним потоком консоли.
+ */
+class ConsoleSink final : public BulkSink {
+public:
+    /**
+     * @brief Конструктор ConsoleSink.
+     * 
+     * @param fd Файловый дескриптор вывода.
+     * @param socket Дескриптор - сокет: запись без SIGPIPE, байты не учитываются как вывод в консоль.
+     */
+    explicit ConsoleSink(int fd = STDOUT_FILENO, bool socket = false);
+
+    void write(const Bulk& bulk) override;
+
+    /**
+     * @brief Добавить фрагменты строки пачки в список.
+     * 
+     * Учитываются только команды в памяти, выгруженные блоки не поддерживаются.
+     * 
+     * @param iov Список фрагментов.
+     * @param bulk Пачка блоков.
+     */
+    static void format(IoVector& iov, const Bulk& bulk);
+
+private:
+    /**
+     * @brief Вывести пачку, содержащую выгруженные блоки или блоки в режиме словаря, порциями.
+     * 
+     * @param bulk Пачка блоков.
+     * @throws std::system_error Если запись или чтение выгрузки завершились ошибкой.
+     */
+    void writeStreaming(const Bulk& bulk);
+
+    /**
+     * @brief Записать накопленные фрагменты в дескриптор.
+     * 
+     * @throws std::system_error Если запись завершилась ошибкой.
+     */
+    void writeOut();
+
+    int fd_; /**< Файловый дескриптор вывода. */
+    bool socket_; /**< Дескриптор - сокет. */
+    IoVector iov_; /**< Переиспользуемый список фрагментов. */
+};
+
+/**
+ * @brief Класс StoreSink сохраняет блоки пачки в хранилище блоков.
+ */
+class StoreSink final : public BulkSink {
+public:
+    /**
+     * @brief Конструктор StoreSink.
+     * 
+     * @param store Хранилище блоков.
+     */
+    explicit StoreSink(std::unique_ptr<BlockStore> store);
+
+    void write(const Bulk& bulk) override;
+
+    void flush() override;
+
+    void submit() override;
+
+    void sync() override;
+
+private:
+    std::unique_ptr<BlockStore> store_; /**< Хранилище блоков. */
+};
+
+/**
+ * @brief Класс NullSink отбрасывает пачки.
+ */
+class NullSink final : public BulkSink {
+public:
+    void write(const Bulk&) override {}
+};
+
+/**
+ * @brief Класс ForwardSink пересылает строки "bulk: ..." в unix-сокет.
+ * 
+ * Формат строк совпадает с выводом в консоль. Недоступный или закрытый
+ * получатель не останавливает вывод: пачки, которые не удалось передать,
+ * учитываются в показателе forwardLost, а соединение устанавливается
+ * заново не чаще раза в kReconnectDelay. Медленный получатель задерживает
+ * только поток этого приемника, а получатель, не читающий дольше
+ * kSendTimeout, отключается.
+ */
+class ForwardSink final : public BulkSink {
+public:
+    /**
+     * @brief Конструктор ForwardSink.
+     * 
+     * @param path Путь unix-сокета получателя.
+     */
+    explicit ForwardSink(std::string path);
+
+    // Запрещаем копирование и присваивание
+    ForwardSink(const ForwardSink&) = delete;
+    ForwardSink& operator=(const ForwardSink&) = delete;
+
+    ~ForwardSink() override;
+
+    void write(const Bulk& bulk) override;
+
+private:
+    static constexpr std::chrono::seconds kReconnectDelay{1}; /**< Пауза между попытками соединения. */
+    static constexpr std::chrono::seconds kSendTimeout{5}; /**< Наибольшее ожидание записи в соединение. */
+
+    /**
+     * @brief Установить соединение, если пришло время очередной попытки.
+     * 
+     * @return bool Возвращает true, если соединение установлено.
+     */
+    bool connect();
+
+    /**
+     * @brief Закрыть соединение и отложить следующую попытку.
+     */
+    void disconnect();
+
+    std::string path_; /**< Путь unix-сокета. */
+    int fd_ = -1; /**< Дескриптор соединения. */
+    std::unique_ptr<ConsoleSink> line_; /**< Вывод строк в соединение. */
+    std::chrono::steady_clock::time_point next_attempt_; /**< Время следующей попытки соединения. */
+    bool reported_ = false; /**< О недоступности получателя уже сообщено. */
+};
+
+/**
+ * @brief Создать приемник графа вывода по настройкам.
+ * 
+ * @param sink Настройки приемника.
+ * @param options Настройки вывода, задающие хранилище для SinkType::Store.
+ * @return std::unique_ptr<BulkSink> Приемник.
+ */
+std::unique_ptr<BulkSink> makeSink(const SinkOptions& sink, const LoggerOptions& options);
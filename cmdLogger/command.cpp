@@ -1,11 +1,12 @@
 #include <iostream>
 #include <string>
+#include <string_view>
 #include "command.h"
 
-Command::Command(const std::string& content) : content_(content) {}
+Command::Command(std::string_view content) : content_(content) {}
 
 Command::Command(const Command& other) : content_(other.content_) {}
 
-const std::string& Command::GetContent() {
+std::string_view Command::GetContent() const {
     return content_;
 }
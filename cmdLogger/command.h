@@ -1,21 +1,23 @@
 #pragma once
 #include <iostream>
 #include <string>
+#include <string_view>
 
 /**
  * @brief Класс Command - команда.
  * 
- * Строковое представление команды и предоставляет методы
- * для доступа к содержимому команды и вывода её на экран.
+ * Легковесное представление текста команды, который хранится в блоке
+ * команд или во входном буфере. Предоставляет методы для доступа
+ * к содержимому команды и вывода её на экран.
  */
 class Command {
 public:
     /**
      * @brief Конструктор Command.
      * 
-     * @param content Текст команды.
+     * @param content Текст команды. Должен оставаться действительным, пока используется команда.
      */
-    explicit Command(const std::string& content);
+    explicit Command(std::string_view content);
 
     /**
      * @brief Конструктор копирования.
@@ -29,9 +31,9 @@ public:
      * 
      * Возвращает строку, содержащую текст команды.
      * 
-     * @return const std::string& Содержимое команды.
+     * @return std::string_view Содержимое команды.
      */
-    const std::string& GetContent();
+    std::string_view GetContent() const;
 
     /**
      * @brief Перегрузка оператора вывода для команды.
@@ -46,5 +48,5 @@ public:
     }
 
 private:
-    std::string content_; /**< Текст команды. */
+    std::string_view content_; /**< Текст команды. */
 };
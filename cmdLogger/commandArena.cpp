@@ -0,0 +1,66 @@
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include "commandArena.h"
+
+
+size_t CommandArena::append(std::string_view text) {
+    index_.push_back(Entry{bytes_.size(), text.size()});
+    bytes_.append(text.data(), text.size());
+    bytes_.push_back('\n');
+    return index_.size() - 1;
+}
+
+size_t CommandArena::capacity() const {
+    return bytes_.capacity() + index_.capacity() * sizeof(Entry) + ids_.capacity() * sizeof(CommandDictionary::Id);
+}
+
+void CommandArena::clear() {
+    bytes_.clear();
+    index_.clear();
+    ids_.clear();
+}
+
+void CommandArenaPool::Releaser::operator()(CommandArena* arena) const {
+    CommandArenaPool::instance().release(arena);
+}
+
+CommandArenaPool& CommandArenaPool::instance() {
+    static CommandArenaPool pool;
+    return pool;
+}
+
+CommandArenaPool::Handle CommandArenaPool::acquire() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        if (!free_.empty()) {
+            Handle arena(free_.back().release());
+            free_.pop_back();
+            return arena;
+        }
+    }
+
+    return Handle(new CommandArena());
+}
+
+void CommandArenaPool::release(CommandArena* arena) {
+    std::unique_ptr<CommandArena> owned(arena);
+
+    if (!owned || owned->capacity() > kMaxArenaCapacity) {
+        return;
+    }
+
+    owned->clear();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (free_.size() < kMaxFreeArenas) {
+        free_.push_back(std::move(owned));
+    }
+}
+
+size_t CommandArenaPool::freeCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return free_.size();
+}
@@ -0,0 +1,160 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "commandDictionary.h"
+
+/**
+ * @brief Класс CommandArena - непрерывное хранилище текста команд блока.
+ * 
+ * Команды дописываются в один буфер байтов, каждая с завершающим '\n',
+ * а их положение хранится в индексе смещений и длин. Поэтому содержимое
+ * блока в формате файла ("a\nb\n") - это весь буфер целиком.
+ * Блок в режиме словаря хранит в том же хранилище только номера команд.
+ */
+class CommandArena {
+public:
+    /**
+     * @brief Добавить команду в хранилище.
+     * 
+     * @param text Текст команды.
+     * @return size_t Индекс добавленной команды.
+     */
+    size_t append(std::string_view text);
+
+    /**
+     * @brief Добавить номер команды в словаре.
+     * 
+     * @param id Номер команды.
+     * @return size_t Индекс добавленного номера.
+     */
+    size_t appendId(CommandDictionary::Id id) {
+        ids_.push_back(id);
+        return ids_.size() - 1;
+    }
+
+    /**
+     * @brief Получить номера команд.
+     * 
+     * @return const std::vector<CommandDictionary::Id>& Номера команд в порядке добавления.
+     */
+    const std::vector<CommandDictionary::Id>& ids() const {
+        return ids_;
+    }
+
+    /**
+     * @brief Получить текст команды по индексу.
+     * 
+     * @param index Индекс команды.
+     * @return std::string_view Текст команды без '\n'.
+     */
+    std::string_view at(size_t index) const {
+        const Entry& entry = index_[index];
+        return std::string_view(bytes_.data() + entry.offset, entry.length);
+    }
+
+    /**
+     * @brief Получить количество команд.
+     * 
+     * @return size_t Количество команд.
+     */
+    size_t size() const {
+        return index_.size();
+    }
+
+    /**
+     * @brief Получить все байты хранилища.
+     * 
+     * @return std::string_view Команды, каждая с завершающим '\n'.
+     */
+    std::string_view bytes() const {
+        return bytes_;
+    }
+
+    /**
+     * @brief Получить объем памяти, зарезервированный хранилищем.
+     * 
+     * @return size_t Емкость буферов в байтах.
+     */
+    size_t capacity() const;
+
+    /**
+     * @brief Очистить хранилище, сохранив выделенную память.
+     */
+    void clear();
+
+private:
+    /**
+     * @brief Положение команды в буфере.
+     */
+    struct Entry {
+        size_t offset; /**< Смещение текста команды. */
+        size_t length; /**< Длина текста команды. */
+    };
+
+    std::string bytes_; /**< Текст команд. */
+    std::vector<Entry> index_; /**< Индекс команд. */
+    std::vector<CommandDictionary::Id> ids_; /**< Номера команд в словаре. */
+};
+
+/**
+ * @brief Класс CommandArenaPool - пул переиспользуемых хранилищ команд.
+ * 
+ * Хранилище выдается блоку при добавлении первой команды и возвращается
+ * в пул при уничтожении блока после вывода, поэтому память буферов
+ * переиспользуется следующими блоками. Пул потокобезопасен: блоки могут
+ * уничтожаться в потоках вывода.
+ */
+class CommandArenaPool {
+public:
+    /**
+     * @brief Функтор возврата хранилища в пул.
+     */
+    struct Releaser {
+        void operator()(CommandArena* arena) const;
+    };
+
+    using Handle = std::unique_ptr<CommandArena, Releaser>; /**< Хранилище, выданное из пула. */
+
+    /**
+     * @brief Получить общий пул хранилищ.
+     * 
+     * @return CommandArenaPool& Пул хранилищ.
+     */
+    static CommandArenaPool& instance();
+
+    /**
+     * @brief Получить пустое хранилище.
+     * 
+     * @return Handle Хранилище, которое вернется в пул при уничтожении.
+     */
+    Handle acquire();
+
+    /**
+     * @brief Вернуть хранилище в пул.
+     * 
+     * Слишком большие хранилища и хранилища сверх лимита пула освобождаются.
+     * 
+     * @param arena Возвращаемое хранилище.
+     */
+    void release(CommandArena* arena);
+
+    /**
+     * @brief Получить количество хранилищ, ожидающих повторного использования.
+     * 
+     * @return size_t Количество свободных хранилищ.
+     */
+    size_t freeCount() const;
+
+private:
+    CommandArenaPool() = default;
+
+    static constexpr size_t kMaxFreeArenas = 64; /**< Наибольшее количество свободных хранилищ. */
+    static constexpr size_t kMaxArenaCapacity = 1 << 20; /**< Наибольшая емкость хранимого хранилища. */
+
+    mutable std::mutex mutex_; /**< Мьютекс пула. */
+    std::vector<std::unique_ptr<CommandArena>> free_; /**< Свободные хранилища. */
+};
@@ -1,19 +1,105 @@
+#include <algorithm>
 #include <chrono>
-#include <fstream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
 #include <vector>
+#include <fcntl.h>
+#include <unistd.h>
 #include "command.h"
+#include "commandArena.h"
+#include "ioVector.h"
 #include "commandBlock.h"
 
-CommandBlock::CommandBlock(bool is_dynamic) : is_dynamic_(is_dynamic), is_active_(true) {}
+namespace {
 
-size_t CommandBlock::AddCommand(const Command& command) {
-    commands_.push_back(command);
+constexpr size_t kInternedChunk = 64 * 1024; /**< Размер порции текста блока в режиме словаря. */
 
-    if (commands_.size() == 1) {
-        first_command_time_ = std::chrono::system_clock::now();
+}
+
+CommandBlock::CommandBlock(bool is_dynamic, bool interned)
+    : is_dynamic_(is_dynamic), is_active_(true), is_interned_(interned) {}
+
+size_t CommandBlock::appendCommand(const Command& command) {
+    if (!arena_) {
+        arena_ = CommandArenaPool::instance().acquire();
+    }
+
+    if (is_interned_) {
+        std::string_view text = command.GetContent();
+        std::optional<CommandDictionary::Id> id = CommandDictionary::instance().intern(text);
+
+        if (id) {
+            size_t index = arena_->appendId(*id);
+            interned_bytes_ += text.size() + 1;
+
+            if (is_dynamic_) {
+                lease_.add(sizeof(CommandDictionary::Id));
+            }
+
+            return spilled_count_ + index;
+        }
+
+        // Словарь заполнен: блок переходит на хранение текста
+        uninternCommands();
+    }
+
+    size_t index = arena_->append(command.GetContent());
+
+    if (is_dynamic_) {
+        lease_.add(command.GetContent().size() + 1);
+    }
+
+    return spilled_count_ + index;
+}
+
+void CommandBlock::uninternCommands() {
+    const CommandDictionary& dictionary = CommandDictionary::instance();
+    CommandArenaPool::Handle arena = CommandArenaPool::instance().acquire();
+
+    for (CommandDictionary::Id id : arena_->ids()) {
+        arena->append(dictionary.text(id));
+    }
+
+    arena_ = std::move(arena);
+    is_interned_ = false;
+    interned_bytes_ = 0;
+
+    if (is_dynamic_) {
+        lease_.release();
+        lease_.add(arena_->bytes().size());
     }
+}
+
+bool CommandBlock::isSpilled() const {
+    return spill_ != nullptr;
+}
+
+size_t CommandBlock::spill(const std::string& dir) {
+    size_t count = getSize() - spilled_count_;
+
+    if (count == 0) {
+        return 0;
+    }
+
+    if (!spill_) {
+        spill_ = std::make_unique<SpillFile>(dir);
+    }
+
+    size_t bytes = 0;
+
+    forEachMemoryChunk([this, &bytes](std::string_view chunk) {
+        spill_->append(chunk);
+        bytes += chunk.size();
+    });
 
-    return commands_.size() - 1;
+    spilled_count_ += count;
+    arena_.reset();
+    interned_bytes_ = 0;
+    lease_.release();
+
+    return bytes;
 }
 
 bool CommandBlock::isDynamic() const {
@@ -21,7 +107,36 @@ bool CommandBlock::isDynamic() const {
 }
 
 bool CommandBlock::isEmpty() const {
-    return commands_.empty();
+    return getSize() == 0;
+}
+
+bool CommandBlock::isInterned() const {
+    return is_interned_;
+}
+
+bool CommandBlock::hasContiguousBytes() const {
+    return !spill_ && !is_interned_;
+}
+
+bool CommandBlock::hasSameCommands(const CommandBlock& other) const {
+    if (getSize() != other.getSize() || getByteSize() != other.getByteSize()) {
+        return false;
+    }
+
+    if (is_interned_ && other.is_interned_ && !spill_ && !other.spill_) {
+        return getSize() == 0 || arena_->ids() == other.arena_->ids();
+    }
+
+    if (hasContiguousBytes() && other.hasContiguousBytes()) {
+        return getBytes() == other.getBytes();
+    }
+
+    std::string text;
+    std::string other_text;
+    forEachChunk([&text](std::string_view chunk) { text += chunk; });
+    other.forEachChunk([&other_text](std::string_view chunk) { other_text += chunk; });
+
+    return text == other_text;
 }
 
 bool CommandBlock::isActive() const {
@@ -32,20 +147,88 @@ void CommandBlock::deactivate() {
     is_active_ = false;
 }
 
-std::vector<Command>::iterator CommandBlock::begin() {
-    return commands_.begin();
+CommandBlock::const_iterator CommandBlock::begin() const {
+    return const_iterator(arena_.get(), is_interned_ && arena_ ? arena_->ids().data() : nullptr, 0);
+}
+
+CommandBlock::const_iterator CommandBlock::end() const {
+    return const_iterator(arena_.get(), is_interned_ && arena_ ? arena_->ids().data() : nullptr, getSize() - spilled_count_);
+}
+
+std::string_view CommandBlock::getBytes() const {
+    return arena_ ? arena_->bytes() : std::string_view();
 }
 
-std::vector<Command>::iterator CommandBlock::end() {
-    return commands_.end();
+size_t CommandBlock::getMemoryBytes() const {
+    if (is_interned_) {
+        return arena_ ? arena_->ids().size() * sizeof(CommandDictionary::Id) : 0;
+    }
+
+    return getBytes().size();
 }
 
-std::vector<Command>::const_iterator CommandBlock::begin() const {
-    return commands_.begin();
+size_t CommandBlock::getByteSize() const {
+    return (spill_ ? spill_->size() : 0) + (is_interned_ ? interned_bytes_ : getBytes().size());
 }
 
-std::vector<Command>::const_iterator CommandBlock::end() const {
-    return commands_.cend();
+void CommandBlock::forEachChunk(const std::function<void(std::string_view)>& consumer) const {
+    if (spill_) {
+        spill_->read(consumer);
+    }
+
+    forEachMemoryChunk(consumer);
+}
+
+void CommandBlock::forEachMemoryChunk(const std::function<void(std::string_view)>& consumer) const {
+    if (!is_interned_ || !arena_) {
+        if (!getBytes().empty()) {
+            consumer(getBytes());
+        }
+
+        return;
+    }
+
+    // Текст блока в режиме словаря собирается порциями по номерам команд
+    const CommandDictionary& dictionary = CommandDictionary::instance();
+    std::string buffer;
+    buffer.reserve(std::min(interned_bytes_, kInternedChunk));
+
+    for (CommandDictionary::Id id : arena_->ids()) {
+        buffer += dictionary.text(id);
+        buffer += '\n';
+
+        if (buffer.size() >= kInternedChunk) {
+            consumer(buffer);
+            buffer.clear();
+        }
+    }
+
+    if (!buffer.empty()) {
+        consumer(buffer);
+    }
+}
+
+void CommandBlock::forEachCommandPiece(const std::function<void(std::string_view, bool)>& consumer) const {
+    bool command_start = true;
+
+    forEachChunk([&](std::string_view chunk) {
+        while (!chunk.empty()) {
+            size_t end = chunk.find('\n');
+            std::string_view piece = chunk.substr(0, end);
+
+            if (!piece.empty()) {
+                consumer(piece, command_start);
+                command_start = false;
+            }
+
+            if (end == std::string_view::npos) {
+                break;
+            }
+
+            command_start = true;
+            chunk.remove_prefix(end + 1);
+        }
+    });
 }
 
 std::chrono::system_clock::time_point CommandBlock::getBlockStartTime() const {
@@ -53,22 +236,51 @@ std::chrono::system_clock::time_point CommandBlock::getBlockStartTime() const {
 }
 
 size_t CommandBlock::getSize() const {
-    return commands_.size();
+    if (!arena_) {
+        return spilled_count_;
+    }
+
+    return spilled_count_ + (is_interned_ ? arena_->ids().size() : arena_->size());
 }
 
 long long CommandBlock::getBlockStartTimeSeconds() const {
     return std::chrono::duration_cast<std::chrono::seconds>(first_command_time_.time_since_epoch()).count();
 }
 
+size_t CommandBlock::getSequence() const {
+    return sequence_;
+}
+
+void CommandBlock::setSequence(size_t sequence) {
+    sequence_ = sequence;
+}
+
+uint64_t CommandBlock::getTraceId() const {
+    return trace_id_;
+}
+
+std::string CommandBlock::getFileName() const {
+    return "bulk" + std::to_string(getBlockStartTimeSeconds()) + ".log";
+}
+
 void CommandBlock::saveToFile() const {
-    std::string filename = "bulk" + std::to_string(getBlockStartTimeSeconds()) + ".log";
+    std::string filename = getFileName();
 
-    std::ofstream file(filename);
-    if (!file.is_open()) {
+    int fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
         throw std::runtime_error("Unable to open file: " + filename);
     }
 
-    for (const auto& command : commands_) {
-        file << command << std::endl;
+    try {
+        forEachChunk([fd](std::string_view chunk) {
+            IoVector iov;
+            iov.add(chunk);
+            iov.writeTo(fd);
+        });
+    } catch (...) {
+        ::close(fd);
+        throw;
     }
+
+    ::close(fd);
 }
@@ -1,30 +1,142 @@
 #pragma once
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
 #include <vector>
 #include "command.h"
+#include "commandArena.h"
+#include "commandDictionary.h"
+#include "latencyTracer.h"
+#include "spillFile.h"
+
+/**
+ * @brief Источник времени, всегда возвращающий начало эпохи.
+ * 
+ * Подставляется вместо std::chrono::system_clock, когда время блоков
+ * не используется (замеры), и избавляет от запроса времени на каждый блок.
+ */
+struct FixedClock {
+    static std::chrono::system_clock::time_point now() {
+        return std::chrono::system_clock::time_point();
+    }
+};
 
 /**
  * @brief Класс CommandBlock представляет блок команд.
  * 
  * Класс управляет списком команд, может быть динамическим или статическим.
  * Также поддерживает сохранение команд в файл и итерацию по ним.
+ * Текст команд хранится в одном непрерывном хранилище (CommandArena),
+ * которое берется из пула и возвращается в него при уничтожении блока.
+ * Блок можно только перемещать.
+ * 
+ * Команды большого динамического блока могут быть выгружены методом spill()
+ * во временный файл (SpillFile); тогда в памяти остаются только команды,
+ * добавленные после выгрузки. Полный текст такого блока читается порциями
+ * через forEachChunk() и forEachCommandPiece(). Память динамических блоков
+ * учитывается в общем бюджете (MemoryLease).
+ * 
+ * Блок в режиме словаря (interned) хранит вместо текста номера команд
+ * в общем словаре CommandDictionary: повторяющиеся команды занимают по
+ * четыре байта, текст подставляется только при выводе и сохранении,
+ * а блоки сравниваются по номерам. Если словарь заполнен, блок переходит
+ * на хранение текста команд.
  */
 class CommandBlock {
 public:
+    /**
+     * @brief Константный итератор по командам блока.
+     * 
+     * Разыменование возвращает Command, ссылающийся на текст в хранилище блока
+     * или, для блока в режиме словаря, в словаре команд.
+     */
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Command;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = Command;
+
+        const_iterator(const CommandArena* arena, const CommandDictionary::Id* ids, size_t index)
+            : arena_(arena), ids_(ids), index_(index) {}
+
+        Command operator*() const {
+            return ids_ ? Command(CommandDictionary::instance().text(ids_[index_])) : Command(arena_->at(index_));
+        }
+
+        const_iterator& operator++() {
+            ++index_;
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            const_iterator prev = *this;
+            ++index_;
+            return prev;
+        }
+
+        bool operator==(const const_iterator& other) const {
+            return index_ == other.index_;
+        }
+
+        bool operator!=(const const_iterator& other) const {
+            return index_ != other.index_;
+        }
+
+    private:
+        const CommandArena* arena_; /**< Хранилище команд. */
+        const CommandDictionary::Id* ids_; /**< Номера команд блока в режиме словаря. */
+        size_t index_; /**< Индекс команды. */
+    };
+
     /**
      * @brief Конструктор CommandBlock.
      * 
      * @param is_dynamic Флаг, указывающий, является ли блок динамическим.
+     * @param interned Хранить номера команд в общем словаре вместо текста.
      */
-    explicit CommandBlock(bool is_dynamic = false);
+    explicit CommandBlock(bool is_dynamic = false, bool interned = false);
+
+    CommandBlock(CommandBlock&&) = default;
+    CommandBlock& operator=(CommandBlock&&) = default;
+
+    // Запрещаем копирование: текст команд не дублируется
+    CommandBlock(const CommandBlock&) = delete;
+    CommandBlock& operator=(const CommandBlock&) = delete;
 
     /**
      * @brief Добавить команду в блок.
      * 
+     * Текст команды копируется в хранилище блока или, в режиме словаря,
+     * заменяется номером в словаре. Время первой команды
+     * берется из источника времени Clock. Если трассировка включена,
+     * учитывается каждая команда, а блок получает номер трассы первой
+     * выбранной команды.
+     * 
+     * @tparam Clock Источник времени с функцией now(), возвращающей
+     *         std::chrono::system_clock::time_point.
      * @param command Команда для добавления в блок.
      * @return size_t Индекс добавленной команды.
      */
-    size_t AddCommand(const Command& command);
+    template <typename Clock = std::chrono::system_clock>
+    size_t AddCommand(const Command& command) {
+        size_t index = appendCommand(command);
+
+        if (index == 0) {
+            first_command_time_ = Clock::now();
+        }
+
+        trace_id_ = LatencyTracer::instance().sample(trace_id_);
+
+        return index;
+    }
 
     /**
      * @brief Проверить, является ли блок динамическим.
@@ -33,7 +145,7 @@ public:
      */
     bool isDynamic() const;
 
-    /**std::shared_ptr<CommandBlock> parent = nullptr, is_active_(true)
+    /**
      * @brief Проверить, пуст ли блок.
      * 
      * @return bool Возвращает true, если блок пуст, иначе false.
@@ -55,42 +167,126 @@ public:
     void deactivate();
 
     /**
-     * @brief Получить итератор на начало списка команд.
+     * @brief Проверить, хранит ли блок номера команд в словаре.
+     * 
+     * @return bool Возвращает true для блока в режиме словаря.
+     */
+    bool isInterned() const;
+
+    /**
+     * @brief Проверить, лежит ли весь текст блока в памяти одним буфером.
+     * 
+     * Для такого блока getBytes() возвращает весь текст; выгруженные блоки
+     * и блоки в режиме словаря читаются через forEachChunk().
      * 
-     * @return std::vector<Command>::iterator Итератор на начало списка команд.
+     * @return bool Возвращает true, если текст доступен через getBytes().
      */
-    std::vector<Command>::iterator begin();
+    bool hasContiguousBytes() const;
 
     /**
-     * @brief Получить итератор на конец списка команд.
+     * @brief Сравнить команды двух блоков.
      * 
-     * @return std::vector<Command>::iterator Итератор на конец списка команд.
+     * Блоки в режиме словаря без выгруженных команд сравниваются по номерам.
+     * 
+     * @param other Другой блок.
+     * @return bool Возвращает true, если блоки содержат одинаковые команды в одном порядке.
+     * @throws std::system_error Если выгруженную часть не удается прочитать.
      */
-    std::vector<Command>::iterator end();
+    bool hasSameCommands(const CommandBlock& other) const;
+
+    /**
+     * @brief Проверить, выгружена ли часть команд во временный файл.
+     * 
+     * @return bool Возвращает true, если блок выгружался.
+     */
+    bool isSpilled() const;
+
+    /**
+     * @brief Выгрузить команды, находящиеся в памяти, во временный файл.
+     * 
+     * Хранилище команд возвращается в пул, новые команды снова
+     * накапливаются в памяти до следующей выгрузки. Команды блока в режиме
+     * словаря выгружаются текстом.
+     * 
+     * @param dir Каталог временного файла.
+     * @return size_t Количество выгруженных байтов текста.
+     * @throws std::system_error Если команды не удается записать.
+     */
+    size_t spill(const std::string& dir);
 
     /**
      * @brief Получить итератор на начало списка команд (константный).
      * 
-     * @return std::vector<Command>::const_iterator Константный итератор на начало списка команд.
+     * Итерация охватывает только команды в памяти; текст выгруженного блока
+     * читается через forEachChunk() или forEachCommandPiece().
+     * 
+     * @return const_iterator Константный итератор на начало списка команд.
      */
-    std::vector<Command>::const_iterator begin() const;
+    const_iterator begin() const;
 
     /**
      * @brief Получить итератор на конец списка команд (константный).
      * 
-     * @return std::vector<Command>::const_iterator Константный итератор на конец списка команд.
+     * @return const_iterator Константный итератор на конец списка команд.
+     */
+    const_iterator end() const;
+
+    /**
+     * @brief Получить текст всех команд блока в формате файла.
+     * 
+     * Текст доступен только при hasContiguousBytes().
+     * 
+     * @return std::string_view Команды блока, каждая с завершающим '\n'.
      */
-    std::vector<Command>::const_iterator end() const;
+    std::string_view getBytes() const;
 
     /**
-     * @brief Получить время начала блока команд., is_active_(true)
+     * @brief Получить объем памяти команд блока.
+     * 
+     * Для блока в режиме словаря учитываются только номера команд.
+     * 
+     * @return size_t Размер в байтах.
+     */
+    size_t getMemoryBytes() const;
+
+    /**
+     * @brief Получить размер текста всех команд блока, включая выгруженные.
+     * 
+     * @return size_t Размер в байтах.
+     */
+    size_t getByteSize() const;
+
+    /**
+     * @brief Передать текст всех команд в формате файла порциями.
+     * 
+     * Сначала читается выгруженная часть, затем часть в памяти. Границы
+     * порций могут проходить внутри команды.
+     * 
+     * @param consumer Получатель порций.
+     * @throws std::system_error Если выгруженную часть не удается прочитать.
+     */
+    void forEachChunk(const std::function<void(std::string_view)>& consumer) const;
+
+    /**
+     * @brief Передать текст всех команд по частям без разделителей строк.
+     * 
+     * Команда может прийти несколькими частями; у первой части флаг
+     * начала команды установлен.
+     * 
+     * @param consumer Получатель части команды и флага начала команды.
+     * @throws std::system_error Если выгруженную часть не удается прочитать.
+     */
+    void forEachCommandPiece(const std::function<void(std::string_view, bool)>& consumer) const;
+
+    /**
+     * @brief Получить время начала блока команд.
      * 
      * @return std::chrono::system_clock::time_point Время начала блока.
      */
     std::chrono::system_clock::time_point getBlockStartTime() const;
 
     /**
-     * @brief Получить количество команд в блоке., is_active_(true)
+     * @brief Получить количество команд в блоке.
      * 
      * @return size_t Количество команд в блоке.
      */
@@ -103,6 +299,34 @@ public:
      */
     long long getBlockStartTimeSeconds() const;
 
+    /**
+     * @brief Получить порядковый номер блока.
+     * 
+     * @return size_t Сквозной номер блока, присвоенный очередью блоков.
+     */
+    size_t getSequence() const;
+
+    /**
+     * @brief Установить порядковый номер блока.
+     * 
+     * @param sequence Сквозной номер блока.
+     */
+    void setSequence(size_t sequence);
+
+    /**
+     * @brief Получить номер трассы задержек блока.
+     * 
+     * @return uint64_t Номер трассы LatencyTracer, 0 - блок не трассируется.
+     */
+    uint64_t getTraceId() const;
+
+    /**
+     * @brief Получить имя файла блока.
+     * 
+     * @return std::string Имя в формате "bulk<время>.log".
+     */
+    std::string getFileName() const;
+
     /**
      * @brief Сохранить команды блока в файл.
      * 
@@ -115,32 +339,65 @@ public:
     /**
      * @brief Перегрузка оператора вывода для блока команд.
      * 
+     * Команды выводятся через ", ". Сохранение в файл выполняется
+     * отдельно методом saveToFile().
+     * 
      * @param os Поток вывода.
      * @param block Объект блока команд.
      * @return std::ostream& Поток вывода.
      */
     friend std::ostream& operator<<(std::ostream& os, const CommandBlock& block) {
-        if (!block.commands_.empty()) {
-            bool start = true;
-
-            for (const auto& command : block.commands_) {
-                if (!start) {
-                    os << ", ";
-                }
+        bool start = true;
 
-                os << command;
-                start = false;
+        block.forEachCommandPiece([&](std::string_view piece, bool command_start) {
+            if (command_start && !start) {
+                os << ", ";
             }
 
-            block.saveToFile();
-        }
+            os << piece;
+            start = false;
+        });
 
         return os;
     }
 
 private:
+    /**
+     * @brief Скопировать текст команды в хранилище блока.
+     * 
+     * @param command Команда.
+     * @return size_t Индекс добавленной команды среди всех команд блока.
+     */
+    size_t appendCommand(const Command& command);
+
+    /**
+     * @brief Перевести блок из режима словаря в хранение текста команд.
+     * 
+     * Вызывается, когда словарь команд заполнен и новой команде не выдан номер.
+     */
+    void uninternCommands();
+
+    /**
+     * @brief Передать текст команд, находящихся в памяти, порциями.
+     * 
+     * @param consumer Получатель порций.
+     */
+    void forEachMemoryChunk(const std::function<void(std::string_view)>& consumer) const;
+
     bool is_dynamic_; /**< Флаг динамического блока. */
     bool is_active_;  /**< Флаг активности блока. */
-    std::vector<Command> commands_; /**< Список команд. */
+    bool is_interned_; /**< Флаг режима словаря. */
+    CommandArenaPool::Handle arena_; /**< Хранилище текста команд. */
+    size_t interned_bytes_ = 0; /**< Размер текста команд в памяти в режиме словаря. */
+    std::unique_ptr<SpillFile> spill_; /**< Выгруженные команды. */
+    size_t spilled_count_ = 0; /**< Количество выгруженных команд. */
+    MemoryLease lease_; /**< Учет памяти динамического блока. */
     std::chrono::system_clock::time_point first_command_time_; /**< Время начала блока команд. */
+    size_t sequence_ = 0; /**< Порядковый номер блока. */
+    uint64_t trace_id_ = 0; /**< Номер трассы задержек, 0 - блок не трассируется. */
 };
+
+/**
+ * @brief Пачка (bulk) - блоки команд, выводимые одной строкой.
+ */
+using Bulk = std::vector<CommandBlock>;
@@ -4,64 +4,132 @@
 #include "commandBlockQueue.h"
 
 
-size_t CommandBlockQueue::addBlock(const CommandBlock& block) {
-    blocks_.push_back(block);
-    return blocks_.size() - 1;
+size_t CommandBlockQueue::addBlock(CommandBlock&& block) {
+    block.setSequence(getEndIndex());
+    blocks_.push_back(std::move(block));
+
+    if (blocks_.back().isActive()) {
+        ++active_count_;
+    }
+
+    return getLasBlocktIndex();
 }
 
 std::optional<std::reference_wrapper<CommandBlock>> CommandBlockQueue::getBlockAtIndex(std::size_t index) {
-    if (index < blocks_.size()) {
-        return std::ref(blocks_[index]);
-    } else {
-        return std::nullopt;
+    if (contains(index)) {
+        return std::ref(blocks_[index - base_index_]);
+    }
+
+    auto it = index < base_index_ ? pinned_.find(index) : pinned_.end();
+
+    if (it != pinned_.end()) {
+        return std::ref(it->second);
     }
+
+    return std::nullopt;
 }
 
 std::optional<std::reference_wrapper<const CommandBlock>> CommandBlockQueue::getBlockAtIndex(std::size_t index) const {
-    if (index < blocks_.size()) {
-        return std::cref(blocks_[index]);
-    } else {
-        return std::nullopt;
+    if (contains(index)) {
+        return std::cref(blocks_[index - base_index_]);
+    }
+
+    auto it = index < base_index_ ? pinned_.find(index) : pinned_.end();
+
+    if (it != pinned_.end()) {
+        return std::cref(it->second);
     }
+
+    return std::nullopt;
 }
 
 void CommandBlockQueue::deleteBlockByIndex(std::size_t index) {
-    if (index < blocks_.size()) {
-        auto it = blocks_.begin() + index;
-        blocks_.erase(it);
-    }
+    deactivateBlock(index);
+    retireInactiveBlocks();
 }
 
 void CommandBlockQueue::deactivateBlock(std::size_t index) {
-    if (index < blocks_.size()) {
-        blocks_[index].deactivate();
+    if (contains(index)) {
+        auto& block = blocks_[index - base_index_];
+
+        if (block.isActive()) {
+            block.deactivate();
+            --active_count_;
+        }
+
+        return;
+    }
+
+    // Перенесенные блоки активны, деактивированный блок освобождается сразу
+    auto it = index < base_index_ ? pinned_.find(index) : pinned_.end();
+
+    if (it != pinned_.end()) {
+        pinned_.erase(it);
+        --active_count_;
     }
 }
 
+std::size_t CommandBlockQueue::retireInactiveBlocks() {
+    std::size_t retired = 0;
+
+    while (!blocks_.empty()) {
+        if (!blocks_.front().isActive()) {
+            blocks_.pop_front();
+            ++base_index_;
+            ++retired;
+            continue;
+        }
+
+        std::size_t window_active = active_count_ - pinned_.size();
+
+        if (blocks_.size() - window_active <= kPinThreshold) {
+            break;
+        }
+
+        // Активная голова переносится, чтобы выведенные блоки за ней освободились
+        pinned_.emplace(base_index_, std::move(blocks_.front()));
+        blocks_.pop_front();
+        ++base_index_;
+    }
+
+    return retired;
+}
+
 bool CommandBlockQueue::isEmpty() const {
-    return blocks_.empty();
+    return blocks_.empty() && pinned_.empty();
 }
 
 std::size_t CommandBlockQueue::Size() const {
-    return blocks_.size();
+    return blocks_.size() + pinned_.size();
 }
 
 std::size_t CommandBlockQueue::getActiveBlockCount() const  {
-    std::size_t res = 0;
+    return active_count_;
+}
 
-    if (begin() < end()) {
-        for (auto it = begin(); it < end(); ++it ) {
-            if ((*it).isActive()) {
-                ++res;
-            }
-        }
+std::size_t CommandBlockQueue::getLasBlocktIndex() const {
+    return getEndIndex() - 1;
+}
+
+std::size_t CommandBlockQueue::getFirstIndex() const {
+    return pinned_.empty() ? base_index_ : pinned_.begin()->first;
+}
+
+std::size_t CommandBlockQueue::getEndIndex() const {
+    return base_index_ + blocks_.size();
+}
+
+std::size_t CommandBlockQueue::getNextIndex(std::size_t index) const {
+    if (index + 1 >= base_index_) {
+        return index + 1;
     }
 
-    return res;
+    auto it = pinned_.upper_bound(index);
+    return it != pinned_.end() && it->first < base_index_ ? it->first : base_index_;
 }
 
-std::size_t CommandBlockQueue::getLasBlocktIndex() const {
-    return blocks_.size() - 1;
+bool CommandBlockQueue::contains(std::size_t index) const {
+    return index >= base_index_ && index - base_index_ < blocks_.size();
 }
 
 CommandBlockQueue::iterator CommandBlockQueue::begin() {
@@ -79,7 +147,3 @@ CommandBlockQueue::const_iterator CommandBlockQueue::begin() const {
 CommandBlockQueue::const_iterator CommandBlockQueue::end() const {
     return blocks_.end();
 }
-
-//  std::size_t CommandBlockQueue::getStartOutputIndex() const {
-//     return start_output_index_;
-//  }
\ No newline at end of file
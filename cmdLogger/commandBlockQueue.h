@@ -1,4 +1,5 @@
 #pragma once
+#include <map>
 #include <optional>
 #include <queue>
 
@@ -6,6 +7,18 @@
 /**
  * @brief Класс CommandBlockQueue представляет очередь блоков команд.
  * 
+ * Очередь хранит только "живое" окно блоков: выведенные (неактивные) блоки
+ * из головы очереди освобождаются методом retireInactiveBlocks().
+ * Индексы блоков сквозные и не меняются при освобождении: индекс первого
+ * блока окна равен base_index_, поэтому память очереди ограничена
+ * числом невыведенных блоков, а не числом всех прочитанных.
+ * 
+ * Незавершенный блок в голове окна (например, динамический блок
+ * подключения, клиент которого замолчал) не удерживает выведенные после
+ * него блоки: когда за ним накапливается больше kPinThreshold выведенных
+ * блоков, активные блоки головы переносятся в отдельный словарь по индексу
+ * и окно продолжает освобождаться. Такой блок удаляется из словаря сразу
+ * при деактивации.
  */
 class CommandBlockQueue {
 public:
@@ -21,10 +34,12 @@ public:
     /**
      * @brief Добавить блок команд в очередь.
      * 
+     * Индекс блока становится его порядковым номером.
+     * 
      * @param block Блок команд для добавления.
      * @return size_t Индекс добавленного блока.
      */
-    size_t addBlock(const CommandBlock& block);
+    size_t addBlock(CommandBlock&& block);
 
     /**
      * @brief Получить блок команд по индексу.
@@ -45,6 +60,9 @@ public:
     /**
      * @brief Удалить блок команд по индексу.
      * 
+     * Блок деактивируется и освобождается вместе с остальными неактивными
+     * блоками в голове очереди. Индексы оставшихся блоков не изменяются.
+     * 
      * @param index Индекс блока команд для удаления.
      */
     void deleteBlockByIndex(std::size_t index);
@@ -56,6 +74,13 @@ public:
      */
     void deactivateBlock(std::size_t index);
 
+    /**
+     * @brief Освободить неактивные блоки в голове очереди.
+     * 
+     * @return std::size_t Количество освобожденных блоков.
+     */
+    std::size_t retireInactiveBlocks();
+
     /**
      * @brief Проверить, пуста ли очередь блоков.
      * 
@@ -64,7 +89,7 @@ public:
     bool isEmpty() const;
 
     /**
-     * @brief Получить количество блоков в очереди.
+     * @brief Получить количество хранимых блоков в очереди.
      * 
      * @return std::size_t Количество блоков в очереди.
      */
@@ -73,6 +98,8 @@ public:
     /**
      * @brief Получить количество активных блоков в очереди.
      * 
+     * Счетчик поддерживается при добавлении и деактивации блоков, O(1).
+     * 
      * @return std::size_t Количество активных блоков в очереди.
      */
     std::size_t getActiveBlockCount() const;
@@ -84,7 +111,33 @@ public:
     std::size_t getLasBlocktIndex() const;
 
     /**
-     * @brief Получить итератор на начало очереди блоков.
+     * @brief Получить индекс первого хранимого блока.
+     * 
+     * @return std::size_t Индекс первого хранимого блока.
+     */
+    std::size_t getFirstIndex() const;
+
+    /**
+     * @brief Получить индекс, который получит следующий добавленный блок.
+     * 
+     * @return std::size_t Индекс следующего блока.
+     */
+    std::size_t getEndIndex() const;
+
+    /**
+     * @brief Получить индекс следующего хранимого блока.
+     * 
+     * Пропускает освобожденные индексы между перенесенными блоками и окном.
+     * 
+     * @param index Индекс хранимого блока.
+     * @return std::size_t Индекс следующего хранимого блока или getEndIndex().
+     */
+    std::size_t getNextIndex(std::size_t index) const;
+
+    /**
+     * @brief Получить итератор на начало окна блоков.
+     * 
+     * Блоки, перенесенные из головы окна, в обход по итераторам не входят.
      * 
      * @return iterator Итератор на начало очереди блоков.
      */
@@ -111,7 +164,6 @@ public:
      */
     const_iterator end() const;
 
-    // std::size_t getStartOutputIndex() const;
     /**
      * @brief Перегрузка оператора вывода для очереди блоков.
      * 
@@ -122,14 +174,16 @@ public:
     friend std::ostream& operator<<(std::ostream& os, const CommandBlockQueue& queue) {
         bool start = true;
 
-        for (auto it = queue.begin(); it < queue.end(); ++it) {
+        for (std::size_t index = queue.getFirstIndex(); index < queue.getEndIndex(); index = queue.getNextIndex(index)) {
+            auto block = queue.getBlockAtIndex(index);
+
             if (!start) {
                 os << ", ";
             } else {
                 start = false;
             }
 
-            os << (*it);
+            os << block->get();
         }
 
         os << std::endl;
@@ -138,6 +192,18 @@ public:
     }
 
 private:
-    std::deque<CommandBlock> blocks_; /**< Очередь блоков команд. */
-    // mutable std::size_t start_output_index_ = 0; /**< Индекс последнего выведенного блока. */
+    /**
+     * @brief Проверить, хранится ли блок с указанным индексом.
+     * 
+     * @param index Индекс блока команд.
+     * @return bool Возвращает true, если блок еще не освобожден.
+     */
+    bool contains(std::size_t index) const;
+
+    static constexpr std::size_t kPinThreshold = 64; /**< Выведенных блоков за активной головой, после которых она переносится. */
+
+    std::deque<CommandBlock> blocks_; /**< Окно хранимых блоков команд. */
+    std::map<std::size_t, CommandBlock> pinned_; /**< Активные блоки, перенесенные из головы окна, по индексу. */
+    std::size_t base_index_ = 0; /**< Индекс блока в голове очереди. */
+    std::size_t active_count_ = 0; /**< Количество активных блоков. */
 };
@@ -0,0 +1,112 @@
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include "commandDictionary.h"
+
+CommandDictionary& CommandDictionary::instance() {
+    // Словарь не уничтожается: тексты нужны потокам вывода до самого выхода
+    static CommandDictionary* dictionary = new CommandDictionary();
+    return *dictionary;
+}
+
+CommandDictionary::~CommandDictionary() {
+    for (auto& page : pages_) {
+        delete[] page.load(std::memory_order_relaxed);
+    }
+}
+
+std::optional<CommandDictionary::Id> CommandDictionary::intern(std::string_view text) {
+    size_t hash = std::hash<std::string_view>()(text);
+    Shard& shard = shards_[(hash >> 7) % kShardCount];
+
+    shard.commands.fetch_add(1, std::memory_order_relaxed);
+    shard.bytes.fetch_add(text.size(), std::memory_order_relaxed);
+
+    {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.ids.find(text);
+
+        if (it != shard.ids.end()) {
+            return it->second;
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.ids.find(text);
+
+    if (it != shard.ids.end()) {
+        return it->second;
+    }
+
+    // Номер занимается сравнением с обменом, поэтому счетчик не выходит за емкость
+    uint64_t id = next_id_.load(std::memory_order_relaxed);
+
+    do {
+        if (id >= capacity_) {
+            if (!full_reported_.exchange(true, std::memory_order_relaxed)) {
+                std::cerr << "Command dictionary is full, new commands are stored as text" << std::endl;
+            }
+
+            return std::nullopt;
+        }
+    } while (!next_id_.compare_exchange_weak(id, id + 1, std::memory_order_relaxed));
+
+    std::string_view stored = store(shard, text);
+    publish(static_cast<Id>(id), stored);
+    shard.ids.emplace(stored, static_cast<Id>(id));
+    shard.unique_bytes += text.size();
+
+    return static_cast<Id>(id);
+}
+
+CommandDictionary::Stats CommandDictionary::stats() const {
+    Stats stats;
+
+    for (const auto& shard : shards_) {
+        stats.commands += shard.commands.load(std::memory_order_relaxed);
+        stats.bytes += shard.bytes.load(std::memory_order_relaxed);
+
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        stats.unique += shard.ids.size();
+        stats.uniqueBytes += shard.unique_bytes;
+    }
+
+    return stats;
+}
+
+std::string_view CommandDictionary::store(Shard& shard, std::string_view text) {
+    // Длинные команды получают отдельную память, чтобы не оставлять в порциях пустоты
+    if (text.size() > kChunkSize / 4) {
+        shard.large.emplace_back(new char[text.size()]);
+        std::memcpy(shard.large.back().get(), text.data(), text.size());
+        return std::string_view(shard.large.back().get(), text.size());
+    }
+
+    if (shard.chunk_used + text.size() > kChunkSize) {
+        shard.chunks.emplace_back(new char[kChunkSize]);
+        shard.chunk_used = 0;
+    }
+
+    char* dest = shard.chunks.back().get() + shard.chunk_used;
+    std::memcpy(dest, text.data(), text.size());
+    shard.chunk_used += text.size();
+
+    return std::string_view(dest, text.size());
+}
+
+void CommandDictionary::publish(Id id, std::string_view text) {
+    std::atomic<std::string_view*>& slot = pages_[id >> kPageBits];
+    std::string_view* page = slot.load(std::memory_order_acquire);
+
+    if (page == nullptr) {
+        std::lock_guard<std::mutex> lock(pages_mutex_);
+        page = slot.load(std::memory_order_relaxed);
+
+        if (page == nullptr) {
+            page = new std::string_view[kPageSize];
+            slot.store(page, std::memory_order_release);
+        }
+    }
+
+    page[id & (kPageSize - 1)] = text;
+}
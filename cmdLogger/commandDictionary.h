@@ -0,0 +1,143 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Класс CommandDictionary - общий словарь текстов команд.
+ *
+ * Сопоставляет тексту команды постоянный номер, так что повторяющиеся
+ * команды хранятся в одном экземпляре, а блоки хранят только номера.
+ * Словарь разделен на kShardCount частей по хэшу текста, у каждой части
+ * свой замок: поиск уже известной команды берет его на чтение, поэтому
+ * потоки разбора почти не мешают друг другу. Тексты и таблица номеров
+ * не перемещаются и не освобождаются до завершения процесса, поэтому
+ * текст по номеру читается без блокировок.
+ *
+ * Номер занимает 32 бита, поэтому словарь вмещает не больше kCapacity
+ * (2^32) различных команд. Заполненный словарь продолжает находить уже
+ * известные команды, а для новых intern() номера не выдает: блоки хранят
+ * такие команды текстом.
+ */
+class CommandDictionary {
+public:
+    using Id = uint32_t; /**< Номер команды в словаре. */
+
+    static constexpr uint64_t kCapacity = uint64_t(1) << 32; /**< Наибольшее количество различных команд. */
+
+    /**
+     * @brief Статистика словаря.
+     */
+    struct Stats {
+        uint64_t commands = 0; /**< Команд передано в словарь. */
+        uint64_t bytes = 0; /**< Байтов текста команд передано в словарь. */
+        uint64_t unique = 0; /**< Различных команд. */
+        uint64_t uniqueBytes = 0; /**< Байтов текста различных команд. */
+    };
+
+    /**
+     * @brief Конструктор CommandDictionary.
+     *
+     * Процесс пользуется общим словарем instance(); отдельный словарь нужен,
+     * например, чтобы проверить заполнение без 2^32 команд.
+     *
+     * @param capacity Наибольшее количество различных команд, не больше kCapacity.
+     */
+    explicit CommandDictionary(uint64_t capacity = kCapacity) : capacity_(std::min(capacity, kCapacity)) {}
+
+    // Запрещаем копирование и присваивание
+    CommandDictionary(const CommandDictionary&) = delete;
+    CommandDictionary& operator=(const CommandDictionary&) = delete;
+
+    /**
+     * @brief Деструктор освобождает страницы таблицы номеров.
+     */
+    ~CommandDictionary();
+
+    /**
+     * @brief Получить общий словарь.
+     *
+     * @return CommandDictionary& Словарь процесса.
+     */
+    static CommandDictionary& instance();
+
+    /**
+     * @brief Получить номер команды, добавив ее в словарь при первом появлении.
+     *
+     * @param text Текст команды.
+     * @return std::optional<Id> Номер команды или std::nullopt, если команды нет, а словарь заполнен.
+     */
+    std::optional<Id> intern(std::string_view text);
+
+    /**
+     * @brief Получить текст команды по номеру.
+     *
+     * @param id Номер, полученный от intern().
+     * @return std::string_view Текст команды, действительный до завершения процесса.
+     */
+    std::string_view text(Id id) const {
+        const std::string_view* page = pages_[id >> kPageBits].load(std::memory_order_acquire);
+        return page[id & (kPageSize - 1)];
+    }
+
+    /**
+     * @brief Получить статистику словаря.
+     *
+     * @return Stats Сумма статистики частей словаря.
+     */
+    Stats stats() const;
+
+private:
+    static constexpr size_t kShardCount = 64; /**< Количество частей словаря. */
+    static constexpr unsigned kPageBits = 16; /**< Двоичный логарифм размера страницы таблицы номеров. */
+    static constexpr size_t kPageSize = size_t(1) << kPageBits; /**< Номеров на странице таблицы. */
+    static constexpr size_t kPageCount = size_t(1) << (32 - kPageBits); /**< Наибольшее количество страниц. */
+    static constexpr size_t kChunkSize = 64 << 10; /**< Размер порции памяти для текстов. */
+
+    /**
+     * @brief Часть словаря.
+     */
+    struct alignas(64) Shard {
+        mutable std::shared_mutex mutex; /**< Замок части. */
+        std::unordered_map<std::string_view, Id> ids; /**< Номера команд части. */
+        std::vector<std::unique_ptr<char[]>> chunks; /**< Порции памяти текстов команд части. */
+        std::vector<std::unique_ptr<char[]>> large; /**< Память длинных команд части. */
+        size_t chunk_used = kChunkSize; /**< Занято байтов в последней порции. */
+        std::atomic<uint64_t> commands{0}; /**< Команд передано в часть. */
+        std::atomic<uint64_t> bytes{0}; /**< Байтов текста передано в часть. */
+        uint64_t unique_bytes = 0; /**< Байтов текста различных команд части. */
+    };
+
+    /**
+     * @brief Скопировать текст команды в память части.
+     *
+     * @param shard Часть словаря, замок которой захвачен на запись.
+     * @param text Текст команды.
+     * @return std::string_view Постоянная копия текста.
+     */
+    static std::string_view store(Shard& shard, std::string_view text);
+
+    /**
+     * @brief Записать текст в таблицу номеров, выделив страницу при необходимости.
+     *
+     * @param id Номер команды.
+     * @param text Постоянная копия текста.
+     */
+    void publish(Id id, std::string_view text);
+
+    std::array<Shard, kShardCount> shards_; /**< Части словаря. */
+    std::atomic<uint64_t> next_id_{0}; /**< Следующий свободный номер. */
+    const uint64_t capacity_; /**< Наибольшее количество номеров. */
+    std::atomic<bool> full_reported_{false}; /**< Сообщение о заполнении словаря уже выведено. */
+    std::array<std::atomic<std::string_view*>, kPageCount> pages_{}; /**< Страницы таблицы номеров. */
+    std::mutex pages_mutex_; /**< Мьютекс выделения страниц. */
+};
@@ -1,86 +1,219 @@
 #include <cassert>
 #include <iostream>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 #include "commandBlock.h"
 #include "commandBlockQueue.h"
 #include "commandManager.h"
+#include "metrics.h"
 
 
-size_t CommandManager::getNewBlockIndex() {
-    return commandQueue_.Size();
+template <typename Output, typename Clock>
+size_t BasicCommandManager<Output, Clock>::getNewBlockIndex() {
+    return commandQueue_.getEndIndex();
 }
 
-void CommandManager::deactivateBlock(size_t blockIndex) {
+template <typename Output, typename Clock>
+void BasicCommandManager<Output, Clock>::deactivateBlock(size_t blockIndex) {
     commandQueue_.deactivateBlock(blockIndex);
+    commandQueue_.retireInactiveBlocks();
 }
 
-void CommandManager::logPreviosStaticBlock(size_t blockIndex) {
-    if (blockIndex > 0) {
-        size_t staticBlockIndex = blockIndex - 1;
-        auto block_opt = commandQueue_.getBlockAtIndex(staticBlockIndex);
+template <typename Output, typename Clock>
+IndexInfo BasicCommandManager<Output, Clock>::addCommandToBlock(size_t blockIndex, std::string_view command_text, bool isDynamic) {
 
-        if (block_opt.has_value()) {
-            auto& block = block_opt->get();
-            if (!block.isDynamic() && block.isActive()) {
-                std::cout << "bulk: " << block << std::endl;
-                block.deactivate();
-            }
-        }
+    Command command(command_text);
+    IndexInfo result{blockIndex, 0};
+    Metrics::instance().commands.add();
+
+    auto block_opt = commandQueue_.getBlockAtIndex(blockIndex);
+
+    if (!block_opt.has_value() || !block_opt->get().isActive() || block_opt->get().isDynamic() != isDynamic) {
+        result.blockIndex = commandQueue_.addBlock(CommandBlock(isDynamic, intern_));
+        block_opt = commandQueue_.getBlockAtIndex(result.blockIndex);
     }
-}
 
-IndexInfo CommandManager::addCommandToBlock(size_t blockIndex, const std::string& command_text, bool isDynamic) {
+    assert(block_opt.has_value());
 
-    Command command(command_text);
-    IndexInfo result{blockIndex, 0};
+    size_t before = block_opt->get().getMemoryBytes();
+    result.commandIndex = block_opt->get().AddCommand<Clock>(command);
+
+    if (isDynamic) {
+        spillIfNeeded(result.blockIndex, before);
+    }
+
+    return result;
+}
 
-    if (blockIndex < (commandQueue_.Size() - 1)) {
-        blockIndex = commandQueue_.Size();
+template <typename Output, typename Clock>
+void BasicCommandManager<Output, Clock>::spillIfNeeded(size_t blockIndex, size_t before) {
+    if (spill_block_ == 0) {
+        return;
     }
 
-    if (blockIndex == commandQueue_.Size()) {
+    // Узел кандидата переиспользуется, поэтому команда не выделяет память под него
+    size_t bytes = commandQueue_.getBlockAtIndex(blockIndex)->get().getMemoryBytes();
+    auto node = spill_candidates_.extract({before, blockIndex});
 
-        CommandBlock commandBlock(isDynamic);
+    if (node) {
+        node.value().first = bytes;
+        spill_candidates_.insert(std::move(node));
+    } else {
+        spill_candidates_.emplace(bytes, blockIndex);
+    }
 
-        result.commandIndex = commandBlock.AddCommand(command);
-        result.blockIndex = commandQueue_.addBlock(commandBlock);
+    if (bytes >= spill_block_) {
+        spillBlock(blockIndex);
+    }
 
-        return result;
+    // При превышении общего бюджета выгружаются самые крупные блоки в памяти
+    // независимо от их размера: много мелких блоков тоже должны укладываться в бюджет
+    while (MemoryLease::total() > spill_total_ && !spill_candidates_.empty()
+           && spill_candidates_.rbegin()->first > 0) {
+        spillBlock(spill_candidates_.rbegin()->second);
     }
+}
+
+template <typename Output, typename Clock>
+void BasicCommandManager<Output, Clock>::spillBlock(size_t blockIndex) {
+    CommandBlock& block = commandQueue_.getBlockAtIndex(blockIndex)->get();
+    spill_candidates_.erase({block.getMemoryBytes(), blockIndex});
+    size_t spilled = block.spill(spill_dir_);
+    Metrics::instance().spills.add();
+    Metrics::instance().spilledBytes.add(spilled);
+}
 
+template <typename Output, typename Clock>
+void BasicCommandManager<Output, Clock>::logBlock(size_t blockIndex) {
     auto block_opt = commandQueue_.getBlockAtIndex(blockIndex);
-    
-    assert(block_opt.has_value());
 
-    result.commandIndex = block_opt.value().get().AddCommand(command);
-    return result;
+    if (block_opt.has_value() && block_opt->get().isActive()) {
+        if (block_opt->get().isDynamic()) {
+            spill_candidates_.erase({block_opt->get().getMemoryBytes(), blockIndex});
+        }
+
+        Bulk bulk;
+        bulk.push_back(std::move(block_opt->get()));
+        deactivateBlock(blockIndex);
+        output_.submit(std::move(bulk));
+    }
+}
+
+template <typename Output, typename Clock>
+void BasicCommandManager<Output, Clock>::logBuiltBlock(CommandBlock&& block) {
+    logBlock(commandQueue_.addBlock(std::move(block)));
 }
 
-void CommandManager::logCommandQueue() {
+template <typename Output, typename Clock>
+void BasicCommandManager<Output, Clock>::logCommandQueue() {
     if (commandQueue_.getActiveBlockCount() > 0) {
-        bool start = true;
-        std::cout << "bulk: ";
-
-        for (auto it = commandQueue_.begin(); it != commandQueue_.end(); ++it) {
-            if (it->isActive()) {
-                if (!start) {
-                    std::cout << ", ";
-                }
-
-                std::cout << (*it);
-                it->deactivate();
-                start = false;
+        Bulk bulk;
+        bulk.reserve(commandQueue_.getActiveBlockCount());
+
+        for (size_t index = commandQueue_.getFirstIndex(); index < commandQueue_.getEndIndex();
+             index = commandQueue_.getNextIndex(index)) {
+            auto& block = commandQueue_.getBlockAtIndex(index)->get();
+
+            if (block.isActive()) {
+                bulk.push_back(std::move(block));
+                commandQueue_.deactivateBlock(index);
             }
         }
 
-        std::cout << std::endl;
+        output_.submit(std::move(bulk));
     }
+
+    spill_candidates_.clear();
+    commandQueue_.retireInactiveBlocks();
 }
 
-bool CommandManager::isBlockEmpty(size_t blockIndex) const {
+template <typename Output, typename Clock>
+bool BasicCommandManager<Output, Clock>::isBlockEmpty(size_t blockIndex) const {
     const auto block_opt = commandQueue_.getBlockAtIndex(blockIndex);
 
     assert(block_opt.has_value());
 
     return block_opt.value().get().isEmpty();
 }
+
+template <typename Output, typename Clock>
+std::optional<std::chrono::system_clock::time_point> BasicCommandManager<Output, Clock>::getStaticDeadline() const {
+    if (max_latency_.count() == 0) {
+        return std::nullopt;
+    }
+
+    auto block_opt = commandQueue_.getBlockAtIndex(static_block_index_);
+
+    if (!block_opt.has_value() || block_opt->get().isDynamic() || !block_opt->get().isActive()) {
+        return std::nullopt;
+    }
+
+    return block_opt->get().getBlockStartTime() + max_latency_;
+}
+
+template <typename Output, typename Clock>
+bool BasicCommandManager<Output, Clock>::flushExpired(std::chrono::system_clock::time_point now) {
+    auto deadline = getStaticDeadline();
+
+    if (!deadline.has_value() || now < *deadline) {
+        return false;
+    }
+
+    logStaticBlock();
+    return true;
+}
+
+template <typename Output, typename Clock>
+void BasicCommandManager<Output, Clock>::finish() {
+    logCommandQueue();
+    output_.drain();
+}
+
+template <typename Output, typename Clock>
+void BasicCommandManager<Output, Clock>::onCommand(std::string_view command, bool isDynamic) {
+    if (isDynamic) {
+        dynamic_block_index_ = addCommandToBlock(dynamic_block_index_, command, true).blockIndex;
+        return;
+    }
+
+    IndexInfo info = addCommandToBlock(static_block_index_, command, false);
+    static_block_index_ = info.blockIndex;
+
+    if (info.commandIndex + 1 == block_size_) {
+        logBlock(static_block_index_);
+    }
+}
+
+template <typename Output, typename Clock>
+void BasicCommandManager<Output, Clock>::onBlockOpen() {
+    logStaticBlock();
+    dynamic_block_index_ = kNewBlock;
+}
+
+template <typename Output, typename Clock>
+void BasicCommandManager<Output, Clock>::onBlockClose() {
+    logBlock(dynamic_block_index_);
+}
+
+template <typename Output, typename Clock>
+void BasicCommandManager<Output, Clock>::onBreak() {
+    logStaticBlock();
+}
+
+template <typename Output, typename Clock>
+void BasicCommandManager<Output, Clock>::onEnd() {
+    logCommandQueue();
+}
+
+template <typename Output, typename Clock>
+void BasicCommandManager<Output, Clock>::logStaticBlock() {
+    auto block_opt = commandQueue_.getBlockAtIndex(static_block_index_);
+
+    if (block_opt.has_value() && !block_opt->get().isDynamic()) {
+        logBlock(static_block_index_);
+    }
+}
+
+template class BasicCommandManager<OutputPipeline, std::chrono::system_clock>;
+template class BasicCommandManager<DirectOutput<NullSink>, FixedClock>;
@@ -1,9 +1,21 @@
 #pragma once
 #include <cassert>
+#include <chrono>
 #include <iostream>
+#include <memory>
+#include <optional>
+#include <set>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <utility>
+#include "blockEventHandler.h"
+#include "bulkSink.h"
 #include "commandBlock.h"
 #include "commandBlockQueue.h"
+#include "directOutput.h"
+#include "loggerOptions.h"
+#include "outputPipeline.h"
 
 
 /**
@@ -15,10 +27,53 @@ struct IndexInfo {
 };
 
 /**
- * @brief Класс CommandManager управляет блоками команд в очереди.
+ * @brief Класс BasicCommandManager управляет блоками команд в очереди.
+ * 
+ * Получает события разбора (BlockEventHandler): статические команды
+ * собираются в блоки по N команд, динамический блок собирается от "{"
+ * до парной "}". Завершенные блоки передаются на вывод.
+ * 
+ * Способ вывода и источник времени блоков задаются при компиляции.
+ * Рабочая программа использует CommandManager с OutputPipeline, набор
+ * приемников которого выбирается параметрами командной строки. Для
+ * фиксированного набора приемников подставляется DirectOutput: вывод
+ * выполняется без виртуальных вызовов. Класс объявлен final, поэтому
+ * BasicCommandParser, параметризованный типом менеджера, вызывает его
+ * обработчики событий напрямую.
+ * 
+ * Определения методов находятся в commandManager.cpp и явно
+ * инстанцируются для CommandManager и SilentCommandManager.
+ * 
+ * @tparam Output Политика вывода с методами submit(Bulk) и drain(),
+ *         конструируемая из LoggerOptions и дополнительных аргументов.
+ * @tparam Clock Источник времени первой команды блока.
  */
-class CommandManager {
+template <typename Output = OutputPipeline, typename Clock = std::chrono::system_clock>
+class BasicCommandManager final : public BlockEventHandler {
 public:
+    static constexpr size_t kNewBlock = static_cast<size_t>(-1); /**< Индекс, по которому всегда создается новый блок. */
+
+    /**
+     * @brief Конструктор BasicCommandManager.
+     * 
+     * @param block_size Размер статического блока команд.
+     * @param options Настройки вывода блоков.
+     * @param output_args Дополнительные аргументы политики вывода; для OutputPipeline -
+     *        приемник консоли и файловый приемник (по умолчанию ConsoleSink и хранилище из настроек).
+     * @throws std::invalid_argument Если размер блока команд равен 0.
+     */
+    template <typename... OutputArgs>
+    explicit BasicCommandManager(size_t block_size, const LoggerOptions& options = LoggerOptions(),
+                                 OutputArgs&&... output_args)
+        : block_size_(block_size), max_latency_(options.maxLatency),
+          spill_block_(options.spillBlock), spill_total_(options.spillTotal), spill_dir_(options.spillDir),
+          intern_(options.intern), static_block_index_(kNewBlock), dynamic_block_index_(kNewBlock),
+          output_(options, std::forward<OutputArgs>(output_args)...) {
+        if (block_size_ == 0) {
+            throw std::invalid_argument("Размер блока команд должен быть больше 0");
+        }
+    }
+
     /**
      * @brief Получить новый индекс для блока.
      * 
@@ -33,25 +88,41 @@ public:
      */
     void deactivateBlock(size_t blockIndex);
 
-    /**
-     * @brief Логировать предыдущий статический блок.
-     * 
-     * @param blockIndex Индекс текущего блока.
-     */
-    void logPreviosStaticBlock(size_t blockIndex);
-
     /**
      * @brief Добавить команду в блок.
      * 
+     * Если блок с указанным индексом уже выведен, еще не создан
+     * или другого типа, создается новый блок.
+     * 
      * @param blockIndex Индекс блока.
      * @param command_text Текст команды.
      * @param isDynamic Флаг динамической команды.
      * @return IndexInfo Структура с индексами блока и команды.
      */    
-    IndexInfo addCommandToBlock(size_t blockIndex, const std::string& command_text, bool isDynamic);
+    IndexInfo addCommandToBlock(size_t blockIndex, std::string_view command_text, bool isDynamic);
+
+    /**
+     * @brief Логировать блок команд, если он еще активен.
+     * 
+     * @param blockIndex Индекс блока.
+     */
+    void logBlock(size_t blockIndex);
+
+    /**
+     * @brief Логировать блок, собранный вне менеджера.
+     * 
+     * Блок получает очередной сквозной номер и выводится отдельной пачкой.
+     * Вызывается, когда у менеджера нет активных блоков, иначе порядок
+     * вывода не совпадет с порядком команд.
+     * 
+     * @param block Завершенный блок команд.
+     */
+    void logBuiltBlock(CommandBlock&& block);
 
     /**
      * @brief Логировать очередь команд.
+     * 
+     * Все активные блоки выводятся одной пачкой.
      */
     void logCommandQueue();
 
@@ -63,6 +134,112 @@ public:
      */
     bool isBlockEmpty(size_t blockIndex) const;
 
+    /**
+     * @brief Получить срок вывода незаполненного статического блока.
+     * 
+     * Срок равен времени первой команды блока плюс наибольшее время ожидания
+     * (LoggerOptions::maxLatency).
+     * 
+     * @return std::optional<std::chrono::system_clock::time_point> Срок или std::nullopt,
+     *         если ограничение не задано или статического блока нет.
+     */
+    std::optional<std::chrono::system_clock::time_point> getStaticDeadline() const;
+
+    /**
+     * @brief Логировать статический блок, если его срок истек.
+     * 
+     * @param now Текущее время.
+     * @return bool Возвращает true, если блок был выведен.
+     */
+    bool flushExpired(std::chrono::system_clock::time_point now);
+
+    /**
+     * @brief Дождаться вывода всех залогированных блоков.
+     * 
+     * @throws std::runtime_error Если при выводе блоков произошла ошибка.
+     */
+    void finish();
+
+    /**
+     * @brief Добавить команду в текущий статический или динамический блок.
+     * 
+     * Статический блок логируется, когда в нем набирается N команд.
+     */
+    void onCommand(std::string_view command, bool isDynamic) override;
+
+    /**
+     * @brief Логировать текущий статический блок и начать динамический.
+     * 
+     * Блок создается при добавлении первой команды.
+     */
+    void onBlockOpen() override;
+
+    /**
+     * @brief Логировать динамический блок.
+     */
+    void onBlockClose() override;
+
+    /**
+     * @brief Логировать текущий статический блок.
+     */
+    void onBreak() override;
+
+    /**
+     * @brief Логировать все незавершенные блоки.
+     */
+    void onEnd() override;
+
 private:
+    /**
+     * @brief Логировать текущий статический блок, если он еще активен.
+     */
+    void logStaticBlock();
+
+    /**
+     * @brief Выгрузить динамический блок во временный файл, если превышен порог памяти.
+     * 
+     * Обновляет объем блока среди кандидатов на выгрузку. Блок выгружается,
+     * если превышен порог блока. Пока превышен общий бюджет, выгружаются
+     * самые крупные динамические блоки менеджера.
+     * 
+     * @param blockIndex Индекс динамического блока.
+     * @param before Объем команд блока в памяти до добавления команды.
+     * @throws std::system_error Если блок не удается выгрузить.
+     */
+    void spillIfNeeded(size_t blockIndex, size_t before);
+
+    /**
+     * @brief Выгрузить команды блока, находящиеся в памяти, и учесть выгрузку в показателях.
+     * 
+     * Блок перестает быть кандидатом на выгрузку до следующей команды.
+     * 
+     * @param blockIndex Индекс динамического блока.
+     * @throws std::system_error Если блок не удается выгрузить.
+     */
+    void spillBlock(size_t blockIndex);
+
+    size_t block_size_; /**< Размер статического блока команд. */
+    std::chrono::milliseconds max_latency_; /**< Наибольшее время ожидания статического блока. */
+    size_t spill_block_; /**< Порог выгрузки динамического блока, 0 - без выгрузки. */
+    size_t spill_total_; /**< Общий порог памяти динамических блоков. */
+    std::string spill_dir_; /**< Каталог временных файлов выгрузки. */
+    std::set<std::pair<size_t, size_t>> spill_candidates_; /**< Активные динамические блоки с командами в памяти: объем и индекс. */
+    bool intern_; /**< Создавать блоки в режиме словаря. */
+    size_t static_block_index_; /**< Индекс текущего статического блока. */
+    size_t dynamic_block_index_; /**< Индекс текущего динамического блока. */
     CommandBlockQueue commandQueue_; /**< Очередь блоков команд. */
+    Output output_; /**< Вывод блоков. */
 };
+
+/**
+ * @brief Менеджер рабочей программы: конвейер вывода и системное время.
+ */
+using CommandManager = BasicCommandManager<OutputPipeline, std::chrono::system_clock>;
+
+/**
+ * @brief Менеджер без вывода и без запроса времени, для замеров сборки блоков.
+ */
+using SilentCommandManager = BasicCommandManager<DirectOutput<NullSink>, FixedClock>;
+
+extern template class BasicCommandManager<OutputPipeline, std::chrono::system_clock>;
+extern template class BasicCommandManager<DirectOutput<NullSink>, FixedClock>;
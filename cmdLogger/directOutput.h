@@ -0,0 +1,63 @@
+#pragma once
+#include <tuple>
+#include <utility>
+#include "bulkSink.h"
+#include "commandBlock.h"
+#include "loggerOptions.h"
+#include "metrics.h"
+
+/**
+ * @brief Класс DirectOutput выводит пачки в набор приемников, заданный при компиляции.
+ *
+ * Политика вывода для BasicCommandManager, альтернативная OutputPipeline:
+ * пачка передается приемникам Sinks по порядку в вызывающем потоке.
+ * Приемники хранятся по значению, их типы известны компилятору, поэтому
+ * вызовы write() и flush() не проходят через таблицу виртуальных функций
+ * и встраиваются. Настройки конвейера, хранилища и гарантии сохранности
+ * не используются: набор приемников полностью определяется типом.
+ *
+ * @tparam Sinks Типы приемников с методами write(const Bulk&) и flush().
+ */
+template <typename... Sinks>
+class DirectOutput {
+public:
+    /**
+     * @brief Конструктор DirectOutput.
+     *
+     * @param options Настройки вывода, не используются.
+     * @param sinks Аргументы приемников; без аргументов приемники создаются по умолчанию.
+     */
+    template <typename... Args>
+    explicit DirectOutput(const LoggerOptions& /*options*/, Args&&... sinks) : sinks_(std::forward<Args>(sinks)...) {}
+
+    // Запрещаем копирование и присваивание
+    DirectOutput(const DirectOutput&) = delete;
+    DirectOutput& operator=(const DirectOutput&) = delete;
+
+    /**
+     * @brief Вывести пачку во все приемники.
+     *
+     * @param bulk Пачка блоков.
+     */
+    void submit(Bulk bulk) {
+        if (bulk.empty()) {
+            return;
+        }
+
+        Metrics& metrics = Metrics::instance();
+        metrics.bulks.add();
+        metrics.blocks.add(bulk.size());
+
+        std::apply([&bulk](auto&... sinks) { (sinks.write(bulk), ...); }, sinks_);
+    }
+
+    /**
+     * @brief Дождаться записи всех выведенных пачек.
+     */
+    void drain() {
+        std::apply([](auto&... sinks) { (sinks.flush(), ...); }, sinks_);
+    }
+
+private:
+    std::tuple<Sinks...> sinks_; /**< Приемники. */
+};
@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include "gzipCompressor.h"
+
+#ifdef BULK_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace {
+
+constexpr size_t kMinOutput = 64 * 1024; /**< Начальный размер буфера сжатых данных. */
+
+}
+
+#ifdef BULK_HAVE_ZLIB
+
+struct GzipCompressor::State {
+    z_stream stream{};
+};
+
+GzipCompressor::GzipCompressor(int level) : level_(level), state_(std::make_unique<State>()) {
+    // 16 + MAX_WBITS - обертка gzip вместо zlib
+    if (deflateInit2(&state_->stream, level, Z_DEFLATED, 16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        throw std::runtime_error("Unable to initialize zlib");
+    }
+}
+
+GzipCompressor::~GzipCompressor() {
+    deflateEnd(&state_->stream);
+}
+
+std::string_view GzipCompressor::compress(std::string_view header, const CommandBlock& block) {
+    if (deflateReset(&state_->stream) != Z_OK) {
+        throw std::runtime_error("Unable to reset zlib stream");
+    }
+
+    used_ = 0;
+    feed(header, false);
+    block.forEachChunk([this](std::string_view chunk) { feed(chunk, false); });
+    feed(std::string_view(), true);
+
+    return std::string_view(out_.data(), used_);
+}
+
+std::string_view GzipCompressor::compress(std::string_view data) {
+    if (deflateReset(&state_->stream) != Z_OK) {
+        throw std::runtime_error("Unable to reset zlib stream");
+    }
+
+    used_ = 0;
+    feed(data, true);
+
+    return std::string_view(out_.data(), used_);
+}
+
+void GzipCompressor::feed(std::string_view data, bool finish) {
+    z_stream& stream = state_->stream;
+
+    for (;;) {
+        // avail_in ограничен 32 битами, большие порции передаются частями
+        size_t part = std::min<size_t>(data.size(), std::numeric_limits<uInt>::max());
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+        stream.avail_in = static_cast<uInt>(part);
+
+        int flush = finish && part == data.size() ? Z_FINISH : Z_NO_FLUSH;
+        int rc = Z_OK;
+
+        do {
+            if (used_ == out_.size()) {
+                out_.resize(std::max(kMinOutput, out_.size() * 2));
+            }
+
+            size_t room = std::min<size_t>(out_.size() - used_, std::numeric_limits<uInt>::max());
+            stream.next_out = reinterpret_cast<Bytef*>(&out_[used_]);
+            stream.avail_out = static_cast<uInt>(room);
+
+            rc = deflate(&stream, flush);
+
+            if (rc == Z_STREAM_ERROR) {
+                throw std::runtime_error("zlib compression failed");
+            }
+
+            used_ += room - stream.avail_out;
+        } while (stream.avail_out == 0 || (flush == Z_FINISH && rc != Z_STREAM_END));
+
+        data.remove_prefix(part);
+
+        if (data.empty()) {
+            return;
+        }
+    }
+}
+
+#else
+
+struct GzipCompressor::State {};
+
+GzipCompressor::GzipCompressor(int level) : level_(level) {
+    throw std::runtime_error("bulk is built without zlib");
+}
+
+GzipCompressor::~GzipCompressor() = default;
+
+std::string_view GzipCompressor::compress(std::string_view, const CommandBlock&) {
+    return std::string_view();
+}
+
+std::string_view GzipCompressor::compress(std::string_view) {
+    return std::string_view();
+}
+
+void GzipCompressor::feed(std::string_view, bool) {}
+
+#endif
+
+int GzipCompressor::level() const {
+    return level_;
+}
+
+GzipCompressor& GzipCompressor::forThread(int level) {
+    thread_local std::unique_ptr<GzipCompressor> compressor;
+
+    if (!compressor || compressor->level() != level) {
+        compressor = std::make_unique<GzipCompressor>(level);
+    }
+
+    return *compressor;
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include "commandBlock.h"
+
+/**
+ * @brief Класс GzipCompressor - сжатие блоков команд в отдельные члены gzip.
+ *
+ * Каждый вызов compress() дает самостоятельный член gzip (RFC 1952), поэтому
+ * его можно распаковать отдельно от соседних, а файл из нескольких членов
+ * подряд распаковывается обычным gzip -d целиком. Состояние zlib
+ * переиспользуется между блоками, буфер результата растет до размера
+ * самого большого сжатого блока.
+ *
+ * Экземпляр не потокобезопасен, потоки записи получают свой через forThread().
+ */
+class GzipCompressor {
+public:
+    /**
+     * @brief Конструктор GzipCompressor.
+     *
+     * @param level Уровень сжатия zlib от 1 до 9.
+     * @throws std::runtime_error Если zlib не удается инициализировать или bulk собран без zlib.
+     */
+    explicit GzipCompressor(int level);
+
+    ~GzipCompressor();
+
+    // Запрещаем копирование и присваивание
+    GzipCompressor(const GzipCompressor&) = delete;
+    GzipCompressor& operator=(const GzipCompressor&) = delete;
+
+    /**
+     * @brief Сжать заголовок и текст блока в один член gzip.
+     *
+     * @param header Текст перед командами блока, может быть пустым.
+     * @param block Блок команд.
+     * @return std::string_view Сжатые данные, действительные до следующего вызова.
+     * @throws std::runtime_error Если сжатие завершилось ошибкой.
+     * @throws std::system_error Если выгруженную часть блока не удается прочитать.
+     */
+    std::string_view compress(std::string_view header, const CommandBlock& block);
+
+    /**
+     * @brief Сжать данные в один член gzip.
+     *
+     * @param data Данные.
+     * @return std::string_view Сжатые данные, действительные до следующего вызова.
+     * @throws std::runtime_error Если сжатие завершилось ошибкой.
+     */
+    std::string_view compress(std::string_view data);
+
+    /**
+     * @brief Получить уровень сжатия.
+     *
+     * @return int Уровень сжатия zlib.
+     */
+    int level() const;
+
+    /**
+     * @brief Получить сжатие вызывающего потока.
+     *
+     * @param level Уровень сжатия zlib.
+     * @return GzipCompressor& Экземпляр потока; создается заново при смене уровня.
+     */
+    static GzipCompressor& forThread(int level);
+
+private:
+    struct State;
+
+    /**
+     * @brief Передать данные zlib.
+     *
+     * @param data Данные.
+     * @param finish Завершить член gzip.
+     */
+    void feed(std::string_view data, bool finish);
+
+    int level_; /**< Уровень сжатия. */
+    std::unique_ptr<State> state_; /**< Поток zlib. */
+    std::string out_; /**< Буфер сжатых данных. */
+    size_t used_ = 0; /**< Занято байтов буфера. */
+};
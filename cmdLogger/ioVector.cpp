@@ -0,0 +1,66 @@
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <system_error>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include "ioVector.h"
+
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
+
+template <typename Write>
+void IoVector::writeAll(Write write) {
+    size_t index = 0;
+    size_t written = 0;
+
+    while (index < iov_.size()) {
+        int count = static_cast<int>(std::min<size_t>(iov_.size() - index, IOV_MAX));
+        ssize_t result = write(iov_.data() + index, count, written);
+
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            throw std::system_error(errno, std::generic_category(), "writev");
+        }
+
+        written += static_cast<size_t>(result);
+        size_t left = static_cast<size_t>(result);
+
+        while (index < iov_.size() && left >= iov_[index].iov_len) {
+            left -= iov_[index].iov_len;
+            ++index;
+        }
+
+        if (left > 0) {
+            iov_[index].iov_base = static_cast<char*>(iov_[index].iov_base) + left;
+            iov_[index].iov_len -= left;
+        }
+    }
+}
+
+void IoVector::writeTo(int fd) {
+    writeAll([fd](const iovec* iov, int count, size_t) {
+        return ::writev(fd, iov, count);
+    });
+}
+
+void IoVector::sendTo(int fd) {
+    writeAll([fd](const iovec* iov, int count, size_t) {
+        msghdr msg{};
+        msg.msg_iov = const_cast<iovec*>(iov);
+        msg.msg_iovlen = static_cast<size_t>(count);
+        return ::sendmsg(fd, &msg, MSG_NOSIGNAL);
+    });
+}
+
+void IoVector::writeAt(int fd, off_t offset) {
+    writeAll([fd, offset](const iovec* iov, int count, size_t written) {
+        return ::pwritev(fd, iov, count, offset + static_cast<off_t>(written));
+    });
+}
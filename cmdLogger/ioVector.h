@@ -0,0 +1,87 @@
+#pragma once
+#include <cstddef>
+#include <string_view>
+#include <vector>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+/**
+ * @brief Класс IoVector - список фрагментов памяти для векторной записи.
+ * 
+ * Фрагменты не копируются: iovec ссылается на исходные байты, которые
+ * должны оставаться действительными до окончания записи. Запись выполняется
+ * одним вызовом writev(2)/pwritev(2), если количество фрагментов
+ * не превышает IOV_MAX, и повторяется при частичной записи.
+ * Запись изменяет фрагменты, поэтому перед повторным использованием
+ * список нужно очистить методом clear().
+ */
+class IoVector {
+public:
+    /**
+     * @brief Добавить фрагмент.
+     * 
+     * @param bytes Байты фрагмента. Пустые фрагменты пропускаются.
+     */
+    void add(std::string_view bytes) {
+        if (!bytes.empty()) {
+            iov_.push_back(iovec{const_cast<char*>(bytes.data()), bytes.size()});
+            size_ += bytes.size();
+        }
+    }
+
+    /**
+     * @brief Очистить список, сохранив выделенную память.
+     */
+    void clear() {
+        iov_.clear();
+        size_ = 0;
+    }
+
+    /**
+     * @brief Получить общую длину фрагментов.
+     * 
+     * @return size_t Количество байтов.
+     */
+    size_t size() const {
+        return size_;
+    }
+
+    /**
+     * @brief Записать все фрагменты в текущую позицию дескриптора.
+     * 
+     * @param fd Файловый дескриптор.
+     * @throws std::system_error Если запись завершилась ошибкой.
+     */
+    void writeTo(int fd);
+
+    /**
+     * @brief Записать все фрагменты с указанного смещения файла.
+     * 
+     * @param fd Файловый дескриптор.
+     * @param offset Смещение в файле.
+     * @throws std::system_error Если запись завершилась ошибкой.
+     */
+    void writeAt(int fd, off_t offset);
+
+    /**
+     * @brief Записать все фрагменты в сокет без сигнала SIGPIPE.
+     * 
+     * Разрыв соединения сообщается ошибкой EPIPE, а не завершением процесса.
+     * 
+     * @param fd Дескриптор сокета.
+     * @throws std::system_error Если запись завершилась ошибкой.
+     */
+    void sendTo(int fd);
+
+private:
+    /**
+     * @brief Записать фрагменты, вызывая write для очередной порции iovec.
+     * 
+     * @param write Функция записи порции, возвращающая результат writev/pwritev.
+     */
+    template <typename Write>
+    void writeAll(Write write);
+
+    std::vector<iovec> iov_; /**< Фрагменты для записи. */
+    size_t size_ = 0; /**< Общая длина фрагментов. */
+};
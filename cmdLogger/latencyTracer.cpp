@@ -0,0 +1,218 @@
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "latencyTracer.h"
+
+namespace {
+
+/**
+ * @brief Отметка вместе с номером потока, записавшего ее.
+ */
+struct ThreadEvent {
+    uint64_t trace;
+    int64_t time;
+    const char* output;
+    LatencyTracer::Stage stage;
+    size_t thread;
+};
+
+/**
+ * @brief Этапы одного вывода трассы: время и поток каждой отметки.
+ */
+struct OutputStages {
+    const ThreadEvent* dequeue = nullptr;
+    const ThreadEvent* write = nullptr;
+    const ThreadEvent* sync = nullptr;
+};
+
+std::string jsonString(const char* text) {
+    std::string result = "\"";
+
+    for (const char* c = text; *c != '\0'; ++c) {
+        if (*c == '"' || *c == '\\') {
+            result += '\\';
+            result += *c;
+        } else if (static_cast<unsigned char>(*c) < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(*c));
+            result += escaped;
+        } else {
+            result += *c;
+        }
+    }
+
+    return result + "\"";
+}
+
+}
+
+LatencyTracer& LatencyTracer::instance() {
+    static LatencyTracer tracer;
+    return tracer;
+}
+
+void LatencyTracer::enable(size_t sample_every) {
+    sample_every_.store(sample_every, std::memory_order_relaxed);
+}
+
+uint64_t LatencyTracer::startTrace() {
+    uint64_t trace = next_trace_.fetch_add(1, std::memory_order_relaxed);
+    record(trace, Stage::Read);
+    return trace;
+}
+
+void LatencyTracer::record(uint64_t trace, Stage stage, const char* output) {
+    if (trace == 0) {
+        return;
+    }
+
+    ThreadBuffer& buffer = localBuffer();
+    size_t count = buffer.count.load(std::memory_order_relaxed);
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    buffer.events[count % kBufferEvents] = Event{trace, std::chrono::duration_cast<std::chrono::nanoseconds>(now).count(), output, stage};
+    buffer.count.store(count + 1, std::memory_order_release);
+}
+
+LatencyTracer::ThreadBuffer& LatencyTracer::localBuffer() {
+    thread_local ThreadBuffer* buffer = nullptr;
+
+    if (!buffer) {
+        std::lock_guard<std::mutex> lock(buffers_mutex_);
+        buffer = &buffers_.emplace_back();
+        buffer->events = std::make_unique<Event[]>(kBufferEvents);
+    }
+
+    return *buffer;
+}
+
+void LatencyTracer::writeChromeTrace(std::ostream& os) const {
+    std::vector<ThreadEvent> events;
+    uint64_t dropped = 0;
+
+    {
+        std::lock_guard<std::mutex> lock(buffers_mutex_);
+
+        for (size_t thread = 0; thread < buffers_.size(); ++thread) {
+            const ThreadBuffer& buffer = buffers_[thread];
+            size_t count = buffer.count.load(std::memory_order_acquire);
+            size_t first = count > kBufferEvents ? count - kBufferEvents : 0;
+            size_t copied = events.size();
+
+            for (size_t i = first; i < count; ++i) {
+                const Event& event = buffer.events[i % kBufferEvents];
+                events.push_back(ThreadEvent{event.trace, event.time, event.output, event.stage, thread});
+            }
+
+            // Отметки, которые поток успел перезаписать во время копирования, отбрасываются
+            std::atomic_thread_fence(std::memory_order_acquire);
+            size_t now = buffer.count.load(std::memory_order_relaxed);
+            size_t overwritten = now > kBufferEvents ? std::min(now - kBufferEvents, count) : 0;
+
+            if (overwritten > first) {
+                events.erase(events.begin() + static_cast<std::ptrdiff_t>(copied),
+                             events.begin() + static_cast<std::ptrdiff_t>(copied + overwritten - first));
+                first = overwritten;
+            }
+
+            dropped += first;
+        }
+    }
+
+    std::sort(events.begin(), events.end(), [](const ThreadEvent& a, const ThreadEvent& b) {
+        return a.trace != b.trace ? a.trace < b.trace : a.time < b.time;
+    });
+
+    int64_t origin = events.empty() ? 0 : events.front().time;
+
+    for (const auto& event : events) {
+        origin = std::min(origin, event.time);
+    }
+
+    bool first = true;
+
+    // Отрезок от отметки from до отметки to рисуется в строке потока, отметившего to
+    auto span = [&](const char* name, const char* output, const ThreadEvent* from, const ThreadEvent* to) {
+        if (!from || !to) {
+            return;
+        }
+
+        char times[64];
+        std::snprintf(times, sizeof(times), "\"ts\":%.3f,\"dur\":%.3f", (from->time - origin) / 1000.0,
+                      (std::max(to->time, from->time) - from->time) / 1000.0);
+
+        os << (first ? "\n" : ",\n") << "{\"name\":\"" << name << "\",\"cat\":\"bulk\",\"ph\":\"X\"," << times
+           << ",\"pid\":1,\"tid\":" << to->thread << ",\"args\":{\"trace\":" << to->trace;
+
+        if (output) {
+            os << ",\"output\":" << jsonString(output);
+        }
+
+        os << "}}";
+        first = false;
+    };
+
+    os << "{\"traceEvents\":[";
+
+    for (size_t begin = 0; begin < events.size();) {
+        size_t end = begin;
+        const ThreadEvent* read = nullptr;
+        const ThreadEvent* close = nullptr;
+        std::map<std::string, OutputStages> outputs;
+
+        for (; end < events.size() && events[end].trace == events[begin].trace; ++end) {
+            const ThreadEvent& event = events[end];
+
+            switch (event.stage) {
+            case Stage::Read:
+                read = &event;
+                break;
+            case Stage::Close:
+                close = &event;
+                break;
+            case Stage::Dequeue:
+                outputs[event.output ? event.output : ""].dequeue = &event;
+                break;
+            case Stage::Write:
+                outputs[event.output ? event.output : ""].write = &event;
+                break;
+            case Stage::Sync:
+                outputs[event.output ? event.output : ""].sync = &event;
+                break;
+            }
+        }
+
+        span("block", nullptr, read, close);
+
+        for (const auto& [name, stages] : outputs) {
+            const char* output = stages.write ? stages.write->output : stages.dequeue ? stages.dequeue->output : stages.sync->output;
+            span("queue", output, close, stages.dequeue);
+            // Без очереди (вывод в потоке чтения) запись отсчитывается от завершения блока
+            span("write", output, stages.dequeue ? stages.dequeue : close, stages.write);
+            span("sync", output, stages.write, stages.sync);
+        }
+
+        begin = end;
+    }
+
+    os << "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"sample_every\":" << sample_every_.load(std::memory_order_relaxed)
+       << ",\"dropped_events\":" << dropped << "}}\n";
+}
+
+void LatencyTracer::dump(const std::string& path) const {
+    std::ofstream file(path, std::ios::trunc);
+
+    if (file) {
+        writeChromeTrace(file);
+        file.flush();
+    }
+
+    if (!file) {
+        throw std::runtime_error("Unable to write trace file " + path);
+    }
+}
@@ -0,0 +1,194 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+
+/**
+ * @brief Класс LatencyTracer - выборочная трассировка задержек команд.
+ *
+ * Каждая K-я команда каждого потока выбирается для трассировки; блок
+ * хранит номер трассы первой выбранной команды, а следующие выбранные
+ * команды того же блока идут в его трассу, новой трассы не начинают.
+ * Для блока с трассой отмечается время этапов: чтение команды (Read),
+ * завершение блока и передача на вывод (Close), извлечение из очереди
+ * вывода (Dequeue), окончание записи (Write) и сброс на диск (Sync).
+ * Dequeue, Write и Sync отмечаются отдельно для каждого вывода (консоль,
+ * хранилище, приемник графа вывода).
+ *
+ * Отметки пишутся в кольцевой буфер потока постоянного размера без
+ * блокировок: буфер заполняет только его поток, а количество записей
+ * публикуется атомарно. Заполненный буфер перезаписывает самые старые
+ * отметки, поэтому выгружаются последние kBufferEvents отметок потока;
+ * трассы, часть отметок которых перезаписана, рисуются частично. По
+ * окончании работы отметки выгружаются в формате Chrome trace event
+ * (JSON), который открывается в chrome://tracing и Perfetto: каждая
+ * трасса - ряд отрезков block, queue, write и sync, поэтому видно, какой
+ * этап определяет задержку.
+ *
+ * Время берется из std::chrono::steady_clock (vDSO, без системного вызова).
+ * Выключенная трассировка стоит одного атомарного чтения на команду.
+ */
+class LatencyTracer {
+public:
+    /**
+     * @brief Этап прохождения блока.
+     */
+    enum class Stage : uint8_t {
+        Read,    /**< Команда прочитана и добавлена в блок. */
+        Close,   /**< Блок завершен и передан на вывод. */
+        Dequeue, /**< Пачка блока извлечена из очереди вывода. */
+        Write,   /**< Пачка блока записана. */
+        Sync     /**< Пачка блока сброшена на диск. */
+    };
+
+    static constexpr size_t kBufferEvents = 1 << 16; /**< Емкость кольцевого буфера отметок потока. */
+
+    /**
+     * @brief Получить единственный экземпляр трассировки.
+     *
+     * @return LatencyTracer& Трассировка процесса.
+     */
+    static LatencyTracer& instance();
+
+    // Запрещаем копирование и присваивание
+    LatencyTracer(const LatencyTracer&) = delete;
+    LatencyTracer& operator=(const LatencyTracer&) = delete;
+
+    /**
+     * @brief Включить трассировку.
+     *
+     * Вызывается до запуска потоков обработки.
+     *
+     * @param sample_every Каждая какая команда потока трассируется, 0 - выключить.
+     */
+    void enable(size_t sample_every);
+
+    /**
+     * @brief Проверить, включена ли трассировка.
+     *
+     * @return bool Возвращает true, если трассировка включена.
+     */
+    bool enabled() const {
+        return sample_every_.load(std::memory_order_relaxed) != 0;
+    }
+
+    /**
+     * @brief Учесть очередную команду потока и решить, трассируется ли ее блок.
+     *
+     * Учитывается каждая команда. Если команда выбрана, а блок еще не
+     * трассируется, начинается новая трасса и отмечается этап Read.
+     *
+     * @param trace Номер трассы блока команды, 0 - блок не трассируется.
+     * @return uint64_t Номер трассы блока: прежний, новый или 0.
+     */
+    uint64_t sample(uint64_t trace = 0) {
+        size_t every = sample_every_.load(std::memory_order_relaxed);
+
+        if (every == 0) {
+            return trace;
+        }
+
+        thread_local size_t counter = 0;
+
+        if (++counter < every) {
+            return trace;
+        }
+
+        counter = 0;
+        return trace != 0 ? trace : startTrace();
+    }
+
+    /**
+     * @brief Отметить этап трассы.
+     *
+     * @param trace Номер трассы, 0 - не отмечать.
+     * @param stage Этап.
+     * @param output Имя вывода для этапов Dequeue, Write и Sync; строка должна жить до выгрузки.
+     */
+    void record(uint64_t trace, Stage stage, const char* output = nullptr);
+
+    /**
+     * @brief Отметить этап всех трассируемых блоков пачки.
+     *
+     * @tparam Blocks Последовательность элементов с методом getTraceId().
+     * @param blocks Блоки пачки.
+     * @param stage Этап.
+     * @param output Имя вывода.
+     */
+    template <typename Blocks>
+    void recordBlocks(const Blocks& blocks, Stage stage, const char* output = nullptr) {
+        if (!enabled()) {
+            return;
+        }
+
+        for (const auto& block : blocks) {
+            if (block.getTraceId() != 0) {
+                record(block.getTraceId(), stage, output);
+            }
+        }
+    }
+
+    /**
+     * @brief Записать отметки в формате Chrome trace event.
+     *
+     * Вызывается после остановки потоков обработки; отметки, перезаписанные
+     * во время выгрузки, все равно отбрасываются.
+     *
+     * @param os Поток вывода.
+     */
+    void writeChromeTrace(std::ostream& os) const;
+
+    /**
+     * @brief Записать отметки в файл в формате Chrome trace event.
+     *
+     * @param path Путь к файлу.
+     * @throws std::runtime_error Если файл не удается записать.
+     */
+    void dump(const std::string& path) const;
+
+private:
+    /**
+     * @brief Отметка этапа.
+     */
+    struct Event {
+        uint64_t trace; /**< Номер трассы. */
+        int64_t time; /**< Время в наносекундах steady_clock. */
+        const char* output; /**< Имя вывода или nullptr. */
+        Stage stage; /**< Этап. */
+    };
+
+    /**
+     * @brief Кольцевой буфер отметок одного потока.
+     */
+    struct ThreadBuffer {
+        std::unique_ptr<Event[]> events; /**< Отметки, заполняет только поток-владелец. */
+        std::atomic<size_t> count{0}; /**< Количество опубликованных отметок за все время, отметка i лежит в events[i % kBufferEvents]. */
+    };
+
+    LatencyTracer() = default;
+
+    /**
+     * @brief Начать трассу выбранной команды.
+     *
+     * @return uint64_t Номер новой трассы.
+     */
+    uint64_t startTrace();
+
+    /**
+     * @brief Получить буфер вызывающего потока, создав его при первом обращении.
+     *
+     * @return ThreadBuffer& Буфер потока.
+     */
+    ThreadBuffer& localBuffer();
+
+    std::atomic<size_t> sample_every_{0}; /**< Каждая какая команда трассируется, 0 - трассировка выключена. */
+    std::atomic<uint64_t> next_trace_{1}; /**< Номер следующей трассы. */
+    mutable std::mutex buffers_mutex_; /**< Мьютекс списка буферов. */
+    std::deque<ThreadBuffer> buffers_; /**< Буферы потоков, живут до завершения процесса. */
+};
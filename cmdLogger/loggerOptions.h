@@ -0,0 +1,89 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "boundedQueue.h"
+#include "mpscRing.h"
+
+/**
+ * @brief Способ сохранения блоков команд.
+ */
+enum class StoreType {
+    Files,    /**< Отдельный файл bulk<время>.log на каждый блок. */
+    Segments  /**< Дописывание блоков в большие сегментные файлы. */
+};
+
+/**
+ * @brief Способ записи блоков в файлы.
+ */
+enum class IoBackend {
+    Sync,  /**< Блокирующие системные вызовы записи. */
+    Uring  /**< Асинхронная запись пачками через io_uring. */
+};
+
+/**
+ * @brief Сжатие сохраняемых блоков.
+ */
+enum class Compression {
+    None, /**< Блоки сохраняются текстом. */
+    Zlib  /**< Каждый блок сжимается в отдельный член gzip. */
+};
+
+/**
+ * @brief Гарантия сохранности блоков на диске.
+ */
+enum class Durability {
+    None,  /**< Данные сбрасываются на диск операционной системой. */
+    Block, /**< Каждая пачка сбрасывается на диск до вывода в консоль. */
+    Group  /**< Пачки окна фиксации сбрасываются на диск одним вызовом. */
+};
+
+/**
+ * @brief Вид приемника графа вывода.
+ */
+enum class SinkType {
+    Console, /**< Строки "bulk: ..." в стандартный вывод. */
+    Store,   /**< Хранилище блоков по настройкам store. */
+    Forward, /**< Строки "bulk: ..." в unix-сокет. */
+    Null     /**< Пачки отбрасываются. */
+};
+
+/**
+ * @brief Структура SinkOptions хранит настройки приемника графа вывода.
+ */
+struct SinkOptions {
+    SinkType type = SinkType::Console; /**< Вид приемника. */
+    std::string name; /**< Имя приемника в показателях. */
+    std::string address; /**< Путь unix-сокета для SinkType::Forward. */
+    std::size_t queueCapacity = 1024; /**< Емкость очереди приемника в пачках. */
+    OverflowPolicy overflow = OverflowPolicy::Block; /**< Действие при заполненной очереди; --sink задает block только хранилищу, остальным drop-oldest. */
+    std::size_t sampleEvery = 10; /**< Каждая какая пачка принимается при OverflowPolicy::Sample. */
+};
+
+/**
+ * @brief Структура LoggerOptions хранит настройки вывода блоков команд.
+ */
+struct LoggerOptions {
+    bool pipeline = false; /**< Выводить блоки в отдельных потоках. */
+    std::size_t fileThreads = 2; /**< Количество потоков записи в файлы. */
+    std::size_t queueCapacity = 1024; /**< Емкость каждой очереди конвейера в пачках. */
+    FullPolicy queuePolicy = FullPolicy::Block; /**< Действие при заполненной очереди конвейера. */
+    StoreType store = StoreType::Files; /**< Способ сохранения блоков. */
+    std::string segmentDir = "."; /**< Каталог сегментных файлов. */
+    std::size_t segmentSize = 64 << 20; /**< Размер сегмента в байтах. */
+    std::size_t segmentAge = 0; /**< Наибольший возраст сегмента в секундах, 0 - без ограничения. */
+    IoBackend ioBackend = IoBackend::Sync; /**< Способ записи блоков в файлы. */
+    Compression compression = Compression::None; /**< Сжатие сохраняемых блоков. */
+    int compressLevel = 3; /**< Уровень сжатия zlib от 1 до 9. */
+    std::size_t uringDepth = 64; /**< Наибольшее количество одновременных записей io_uring. */
+    Durability durability = Durability::None; /**< Гарантия сохранности блоков. */
+    std::size_t groupSize = 1 << 20; /**< Наибольший объем команд окна фиксации в байтах. */
+    std::size_t groupTime = 5; /**< Наибольшая длительность окна фиксации в мс. */
+    std::size_t spillBlock = 64 << 20; /**< Объем динамического блока в памяти, после которого он выгружается, 0 - без выгрузки. */
+    std::size_t spillTotal = 256 << 20; /**< Общий объем динамических блоков в памяти, после которого выгружаются самые крупные блоки. */
+    std::string spillDir = "/tmp"; /**< Каталог временных файлов выгрузки. */
+    bool index = false; /**< Вести индекс сохраненных блоков по времени (bulk.idx). */
+    bool intern = false; /**< Хранить в блоках номера команд в общем словаре вместо текста. */
+    std::vector<SinkOptions> sinks; /**< Приемники графа вывода, пустой список - консоль и хранилище. */
+    std::size_t maxLatency = 0; /**< Наибольшее время ожидания статического блока в мс, 0 - без ограничения. */
+};
@@ -0,0 +1,203 @@
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include "commandDictionary.h"
+#include "metrics.h"
+
+namespace {
+
+void writeCounter(std::ostream& os, const std::string& name, const std::string& help, uint64_t value) {
+    os << "# HELP " << name << " " << help << "\n"
+       << "# TYPE " << name << " counter\n"
+       << name << " " << value << "\n";
+}
+
+void writeCounter(std::ostream& os, const std::string& name, const std::string& help, const MetricCounter& counter) {
+    writeCounter(os, name, help, counter.get());
+}
+
+void writeGauge(std::ostream& os, const std::string& name, const std::string& help, double value) {
+    os << "# HELP " << name << " " << help << "\n"
+       << "# TYPE " << name << " gauge\n"
+       << name << " " << value << "\n";
+}
+
+void writeSummary(std::ostream& os, const std::string& name, const std::string& help, const LatencyHistogram& histogram) {
+    static const double kQuantiles[] = {0.5, 0.9, 0.99, 0.999, 1.0};
+
+    os << "# HELP " << name << " " << help << "\n"
+       << "# TYPE " << name << " summary\n";
+
+    for (double q : kQuantiles) {
+        os << name << "{quantile=\"" << q << "\"} " << histogram.quantile(q) / 1e9 << "\n";
+    }
+
+    os << name << "_sum " << histogram.sum() / 1e9 << "\n"
+       << name << "_count " << histogram.count() << "\n";
+}
+
+std::string sinkLabel(const std::string& name) {
+    std::string label = "{sink=\"";
+
+    for (char c : name) {
+        if (c == '"' || c == '\\') {
+            label += '\\';
+        }
+
+        label += c == '\n' ? ' ' : c;
+    }
+
+    return label + "\"}";
+}
+
+}
+
+uint64_t LatencyHistogram::count() const {
+    return count_.load(std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::sum() const {
+    return sum_.load(std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::quantile(double quantile) const {
+    uint64_t total = 0;
+
+    for (const auto& bucket : buckets_) {
+        total += bucket.load(std::memory_order_relaxed);
+    }
+
+    if (total == 0) {
+        return 0;
+    }
+
+    uint64_t rank = static_cast<uint64_t>(quantile * static_cast<double>(total));
+    rank = rank == 0 ? 1 : (rank > total ? total : rank);
+    uint64_t seen = 0;
+
+    for (size_t i = 0; i < kBucketCount; ++i) {
+        seen += buckets_[i].load(std::memory_order_relaxed);
+
+        if (seen >= rank) {
+            return bucketUpperBound(i);
+        }
+    }
+
+    return bucketUpperBound(kBucketCount - 1);
+}
+
+size_t LatencyHistogram::bucketIndex(uint64_t value) {
+    if (value < kSubBuckets) {
+        return static_cast<size_t>(value);
+    }
+
+    unsigned msb = 63 - static_cast<unsigned>(__builtin_clzll(value));
+    unsigned shift = msb - kSubBucketBits;
+    size_t sub = static_cast<size_t>((value >> shift) & (kSubBuckets - 1));
+
+    return (shift + 1) * kSubBuckets + sub;
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(size_t index) {
+    if (index < kSubBuckets) {
+        return index;
+    }
+
+    unsigned shift = static_cast<unsigned>(index / kSubBuckets) - 1;
+    uint64_t lower = static_cast<uint64_t>(kSubBuckets + index % kSubBuckets) << shift;
+
+    return lower + ((uint64_t(1) << shift) - 1);
+}
+
+SinkMetrics& Metrics::addSink(const std::string& name) {
+    std::lock_guard<std::mutex> lock(sinks_mutex_);
+    return sinks_.emplace_back(name);
+}
+
+Metrics& Metrics::instance() {
+    static Metrics metrics;
+    return metrics;
+}
+
+void Metrics::writePrometheus(std::ostream& os) const {
+    writeCounter(os, "bulk_input_bytes_total", "Bytes read from input.", inputBytes);
+    writeCounter(os, "bulk_commands_total", "Commands ingested.", commands);
+    writeCounter(os, "bulk_bulks_total", "Bulks flushed to output.", bulks);
+    writeCounter(os, "bulk_blocks_total", "Blocks flushed to output.", blocks);
+    writeCounter(os, "bulk_console_bytes_total", "Bytes written to console.", consoleBytes);
+    writeCounter(os, "bulk_store_bytes_total", "Command bytes written to block store.", storeBytes);
+    writeCounter(os, "bulk_store_compressed_bytes_total", "Compressed bytes written to block store.", compressedBytes);
+    writeCounter(os, "bulk_dropped_bulks_total", "Bulks dropped on a full pipeline queue.", droppedBulks);
+    writeCounter(os, "bulk_syncs_total", "Block store syncs to disk.", syncs);
+    writeCounter(os, "bulk_spills_total", "Dynamic block spills to temporary files.", spills);
+    writeCounter(os, "bulk_spilled_bytes_total", "Command bytes spilled to temporary files.", spilledBytes);
+    writeCounter(os, "bulk_forward_lost_bulks_total", "Bulks not delivered to a forwarding socket.", forwardLost);
+
+    // Показатели словаря команд (--intern); коэффициент дедупликации -
+    // отношение объема текста команд к объему различных команд
+    CommandDictionary::Stats dictionary = CommandDictionary::instance().stats();
+    writeCounter(os, "bulk_intern_commands_total", "Commands stored as dictionary ids.", dictionary.commands);
+    writeCounter(os, "bulk_intern_bytes_total", "Command bytes stored as dictionary ids.", dictionary.bytes);
+    writeGauge(os, "bulk_intern_unique_commands", "Distinct commands in the dictionary.", static_cast<double>(dictionary.unique));
+    writeGauge(os, "bulk_intern_unique_bytes", "Bytes of distinct command text in the dictionary.", static_cast<double>(dictionary.uniqueBytes));
+    writeGauge(os, "bulk_intern_dedup_ratio", "Command bytes per byte of distinct command text.",
+               dictionary.uniqueBytes > 0 ? static_cast<double>(dictionary.bytes) / dictionary.uniqueBytes : 0.0);
+
+    writeSummary(os, "bulk_parse_latency_seconds", "Time to parse one input chunk.", parseLatency);
+    writeSummary(os, "bulk_queue_wait_seconds", "Time a bulk waits in an output queue.", queueWait);
+    writeSummary(os, "bulk_write_latency_seconds", "Time to save one block.", writeLatency);
+    writeSummary(os, "bulk_sync_latency_seconds", "Time to sync the block store to disk.", syncLatency);
+
+    // Показатели приемников графа вывода (--sink) с меткой sink
+    std::lock_guard<std::mutex> lock(sinks_mutex_);
+
+    if (sinks_.empty()) {
+        return;
+    }
+
+    os << "# HELP bulk_sink_bulks_total Bulks written by an output sink.\n"
+       << "# TYPE bulk_sink_bulks_total counter\n";
+
+    for (const auto& sink : sinks_) {
+        os << "bulk_sink_bulks_total" << sinkLabel(sink.name) << " " << sink.bulks.get() << "\n";
+    }
+
+    os << "# HELP bulk_sink_dropped_bulks_total Bulks lost on a full output sink queue.\n"
+       << "# TYPE bulk_sink_dropped_bulks_total counter\n";
+
+    for (const auto& sink : sinks_) {
+        os << "bulk_sink_dropped_bulks_total" << sinkLabel(sink.name) << " " << sink.dropped.get() << "\n";
+    }
+
+    os << "# HELP bulk_sink_queue_depth Bulks waiting in an output sink queue.\n"
+       << "# TYPE bulk_sink_queue_depth gauge\n";
+
+    for (const auto& sink : sinks_) {
+        os << "bulk_sink_queue_depth" << sinkLabel(sink.name) << " " << sink.depth.load(std::memory_order_relaxed) << "\n";
+    }
+
+    os << "# HELP bulk_sink_lag_seconds Queue wait of the bulk an output sink took last.\n"
+       << "# TYPE bulk_sink_lag_seconds gauge\n";
+
+    for (const auto& sink : sinks_) {
+        os << "bulk_sink_lag_seconds" << sinkLabel(sink.name) << " " << sink.lag.load(std::memory_order_relaxed) / 1e9 << "\n";
+    }
+
+    static const double kQuantiles[] = {0.5, 0.9, 0.99, 0.999, 1.0};
+
+    os << "# HELP bulk_sink_queue_wait_seconds Time a bulk waits in an output sink queue.\n"
+       << "# TYPE bulk_sink_queue_wait_seconds summary\n";
+
+    for (const auto& sink : sinks_) {
+        std::string label = sinkLabel(sink.name);
+        std::string prefix = label.substr(0, label.size() - 1) + ",quantile=\"";
+
+        for (double q : kQuantiles) {
+            os << "bulk_sink_queue_wait_seconds" << prefix << q << "\"} " << sink.queueWait.quantile(q) / 1e9 << "\n";
+        }
+
+        os << "bulk_sink_queue_wait_seconds_sum" << label << " " << sink.queueWait.sum() / 1e9 << "\n"
+           << "bulk_sink_queue_wait_seconds_count" << label << " " << sink.queueWait.count() << "\n";
+    }
+}
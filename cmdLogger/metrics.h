@@ -0,0 +1,193 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+
+/**
+ * @brief Класс MetricCounter - счетчик событий.
+ * 
+ * Счетчик занимает отдельную строку кэша и увеличивается атомарно
+ * без упорядочивания памяти, поэтому его можно вызывать на горячем пути.
+ */
+class alignas(64) MetricCounter {
+public:
+    /**
+     * @brief Увеличить счетчик.
+     * 
+     * @param value Величина увеличения.
+     */
+    void add(uint64_t value = 1) {
+        value_.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Получить значение счетчика.
+     * 
+     * @return uint64_t Значение счетчика.
+     */
+    uint64_t get() const {
+        return value_.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<uint64_t> value_{0}; /**< Значение счетчика. */
+};
+
+/**
+ * @brief Класс LatencyHistogram - гистограмма задержек в наносекундах.
+ * 
+ * Корзины устроены как в HDR-гистограмме: значения меньше 16 хранятся точно,
+ * а каждый следующий двоичный порядок делится на 16 равных корзин, что дает
+ * относительную погрешность не более 1/16 во всем диапазоне uint64_t.
+ * Запись - одно атомарное увеличение корзины без блокировок.
+ */
+class LatencyHistogram {
+public:
+    static constexpr unsigned kSubBucketBits = 4; /**< Двоичный логарифм числа корзин порядка. */
+    static constexpr unsigned kSubBuckets = 1u << kSubBucketBits; /**< Число корзин одного порядка. */
+    static constexpr size_t kBucketCount = (64 - kSubBucketBits + 1) * kSubBuckets; /**< Общее число корзин. */
+
+    /**
+     * @brief Записать значение.
+     * 
+     * @param nanoseconds Задержка в наносекундах.
+     */
+    void record(uint64_t nanoseconds) {
+        buckets_[bucketIndex(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(nanoseconds, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Записать длительность.
+     * 
+     * @param duration Длительность.
+     */
+    template <typename Rep, typename Period>
+    void record(std::chrono::duration<Rep, Period> duration) {
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+        record(static_cast<uint64_t>(ns > 0 ? ns : 0));
+    }
+
+    /**
+     * @brief Получить количество записанных значений.
+     * 
+     * @return uint64_t Количество значений.
+     */
+    uint64_t count() const;
+
+    /**
+     * @brief Получить сумму записанных значений.
+     * 
+     * @return uint64_t Сумма в наносекундах.
+     */
+    uint64_t sum() const;
+
+    /**
+     * @brief Получить квантиль распределения.
+     * 
+     * @param quantile Квантиль от 0 до 1.
+     * @return uint64_t Верхняя граница корзины квантиля в наносекундах.
+     */
+    uint64_t quantile(double quantile) const;
+
+    /**
+     * @brief Получить индекс корзины значения.
+     * 
+     * @param value Значение.
+     * @return size_t Индекс корзины.
+     */
+    static size_t bucketIndex(uint64_t value);
+
+    /**
+     * @brief Получить верхнюю границу корзины.
+     * 
+     * @param index Индекс корзины.
+     * @return uint64_t Наибольшее значение корзины.
+     */
+    static uint64_t bucketUpperBound(size_t index);
+
+private:
+    std::array<std::atomic<uint64_t>, kBucketCount> buckets_{}; /**< Корзины. */
+    std::atomic<uint64_t> count_{0}; /**< Количество значений. */
+    std::atomic<uint64_t> sum_{0}; /**< Сумма значений. */
+};
+
+/**
+ * @brief Структура SinkMetrics - показатели одного приемника графа вывода.
+ * 
+ * Экспортируются с меткой sink="<имя>".
+ */
+struct SinkMetrics {
+    /**
+     * @brief Конструктор SinkMetrics.
+     * 
+     * @param sink_name Имя приемника.
+     */
+    explicit SinkMetrics(std::string sink_name) : name(std::move(sink_name)) {}
+
+    const std::string name; /**< Имя приемника. */
+    MetricCounter bulks; /**< Выведено пачек. */
+    MetricCounter dropped; /**< Потеряно пачек при заполненной очереди. */
+    std::atomic<uint64_t> depth{0}; /**< Пачек в очереди. */
+    std::atomic<uint64_t> lag{0}; /**< Время ожидания последней извлеченной пачки в наносекундах. */
+    LatencyHistogram queueWait; /**< Время ожидания пачки в очереди приемника. */
+};
+
+/**
+ * @brief Класс Metrics - показатели работы bulk.
+ * 
+ * Общий экземпляр заполняется чтением, сборкой блоков и выводом,
+ * а MetricsReporter выгружает его снимок в текстовом формате Prometheus.
+ */
+class Metrics {
+public:
+    /**
+     * @brief Получить общий экземпляр показателей.
+     * 
+     * @return Metrics& Показатели процесса.
+     */
+    static Metrics& instance();
+
+    /**
+     * @brief Записать снимок показателей в текстовом формате Prometheus.
+     * 
+     * @param os Поток вывода.
+     */
+    void writePrometheus(std::ostream& os) const;
+
+    /**
+     * @brief Зарегистрировать показатели приемника графа вывода.
+     * 
+     * @param name Имя приемника.
+     * @return SinkMetrics& Показатели, действительные до завершения процесса.
+     */
+    SinkMetrics& addSink(const std::string& name);
+
+    MetricCounter inputBytes; /**< Прочитано байтов ввода. */
+    MetricCounter commands; /**< Принято команд. */
+    MetricCounter bulks; /**< Выведено пачек. */
+    MetricCounter blocks; /**< Выведено блоков. */
+    MetricCounter consoleBytes; /**< Записано байтов в консоль. */
+    MetricCounter storeBytes; /**< Записано байтов команд в хранилище. */
+    MetricCounter compressedBytes; /**< Записано сжатых байтов в хранилище. */
+    MetricCounter droppedBulks; /**< Отброшено пачек при заполненной очереди конвейера. */
+    MetricCounter syncs; /**< Сбросов хранилища на диск. */
+    MetricCounter spills; /**< Выгрузок динамических блоков во временные файлы. */
+    MetricCounter spilledBytes; /**< Выгружено байтов команд во временные файлы. */
+    LatencyHistogram parseLatency; /**< Время разбора порции ввода. */
+    LatencyHistogram queueWait; /**< Время ожидания пачки в очереди вывода. */
+    LatencyHistogram writeLatency; /**< Время сохранения блока. */
+    LatencyHistogram syncLatency; /**< Время сброса хранилища на диск. */
+    MetricCounter forwardLost; /**< Пачек, не переданных по сокету пересылки. */
+
+private:
+    mutable std::mutex sinks_mutex_; /**< Мьютекс списка приемников. */
+    std::deque<SinkMetrics> sinks_; /**< Показатели приемников графа вывода. */
+};
@@ -0,0 +1,102 @@
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <pthread.h>
+#include <signal.h>
+#include <time.h>
+#include "metrics.h"
+#include "metricsReporter.h"
+
+MetricsReporter::MetricsReporter(std::string stats_file, size_t interval)
+    : stats_file_(std::move(stats_file)), interval_(interval), stop_(false) {
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGUSR1);
+    pthread_sigmask(SIG_BLOCK, &set, nullptr);
+
+    thread_ = std::thread(&MetricsReporter::run, this);
+}
+
+MetricsReporter::~MetricsReporter() {
+    // Поток ждет сигнала без опроса, поэтому его будит направленный ему SIGUSR1
+    stop_ = true;
+    pthread_kill(thread_.native_handle(), SIGUSR1);
+    thread_.join();
+
+    if (!stats_file_.empty()) {
+        dump();
+    }
+}
+
+void MetricsReporter::dump() const {
+    if (stats_file_.empty()) {
+        Metrics::instance().writePrometheus(std::cerr);
+        std::cerr.flush();
+        return;
+    }
+
+    std::string tmp = stats_file_ + ".tmp";
+    {
+        std::ofstream file(tmp, std::ios::trunc);
+
+        if (!file.is_open()) {
+            std::cerr << "Unable to open stats file: " << tmp << std::endl;
+            return;
+        }
+
+        Metrics::instance().writePrometheus(file);
+    }
+
+    if (std::rename(tmp.c_str(), stats_file_.c_str()) != 0) {
+        std::cerr << "Unable to replace stats file: " << stats_file_ << std::endl;
+    }
+}
+
+void MetricsReporter::run() {
+    // Сигналы завершения должен получать основной поток: в режиме сервера
+    // он читает их через signalfd, иначе они завершили бы процесс отсюда
+    sigset_t stop_set;
+    sigemptyset(&stop_set);
+    sigaddset(&stop_set, SIGINT);
+    sigaddset(&stop_set, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stop_set, nullptr);
+
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGUSR1);
+
+    bool periodic = interval_ > 0 && !stats_file_.empty();
+    auto next = std::chrono::steady_clock::now() + std::chrono::seconds(interval_);
+
+    while (true) {
+        int signal;
+
+        if (periodic) {
+            // Ожидание длится до следующей периодической записи
+            auto left = std::max(next - std::chrono::steady_clock::now(), std::chrono::steady_clock::duration::zero());
+            auto seconds = std::chrono::duration_cast<std::chrono::seconds>(left);
+            const timespec timeout{static_cast<time_t>(seconds.count()),
+                                   static_cast<long>(std::chrono::duration_cast<std::chrono::nanoseconds>(left - seconds).count())};
+            signal = sigtimedwait(&set, nullptr, &timeout);
+        } else {
+            signal = sigwaitinfo(&set, nullptr);
+        }
+
+        if (stop_) {
+            break;
+        }
+
+        if (signal == SIGUSR1) {
+            dump();
+        }
+
+        if (periodic && std::chrono::steady_clock::now() >= next) {
+            dump();
+            next += std::chrono::seconds(interval_);
+        }
+    }
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <atomic>
+#include <string>
+#include <thread>
+#include "metrics.h"
+
+/**
+ * @brief Класс MetricsReporter выгружает снимки показателей.
+ * 
+ * Снимок в текстовом формате Prometheus записывается по сигналу SIGUSR1
+ * и, если задан файл показателей, периодически. Файл заменяется атомарно
+ * (запись во временный файл и rename), без файла снимок выводится в stderr.
+ * 
+ * Сигнал принимается выделенным потоком через sigtimedwait, поэтому объект
+ * нужно создавать до запуска остальных потоков: конструктор блокирует
+ * SIGUSR1 в вызывающем потоке, и новые потоки наследуют эту маску.
+ * Поток не опрашивает флаги: он спит в sigtimedwait до следующей записи
+ * файла или, без периодической записи, до сигнала. Для остановки
+ * деструктор направляет SIGUSR1 самому потоку.
+ */
+class MetricsReporter {
+public:
+    /**
+     * @brief Конструктор MetricsReporter.
+     * 
+     * @param stats_file Файл показателей, пустая строка - вывод в stderr.
+     * @param interval Период записи файла в секундах, 0 - только по сигналу.
+     */
+    MetricsReporter(std::string stats_file, size_t interval);
+
+    // Запрещаем копирование и присваивание
+    MetricsReporter(const MetricsReporter&) = delete;
+    MetricsReporter& operator=(const MetricsReporter&) = delete;
+
+    /**
+     * @brief Деструктор останавливает поток и записывает последний снимок в файл.
+     */
+    ~MetricsReporter();
+
+    /**
+     * @brief Записать снимок показателей.
+     */
+    void dump() const;
+
+private:
+    /**
+     * @brief Цикл потока выгрузки.
+     */
+    void run();
+
+    std::string stats_file_; /**< Файл показателей. */
+    size_t interval_; /**< Период записи файла в секундах. */
+    std::atomic<bool> stop_; /**< Флаг остановки потока. */
+    std::thread thread_; /**< Поток выгрузки. */
+};
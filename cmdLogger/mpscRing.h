@@ -0,0 +1,360 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Действие производителя при заполненной очереди.
+ */
+enum class FullPolicy {
+    Block, /**< Ждать освобождения места. */
+    Spin,  /**< Повторять попытку, уступая процессор. */
+    Drop   /**< Отбросить элемент и учесть его в счетчике. */
+};
+
+/**
+ * @brief Класс MpscRing - ограниченная очередь многих производителей и одного потребителя.
+ *
+ * Кольцевой буфер без блокировок на основе порядковых номеров ячеек
+ * (схема Д. Вьюкова): производитель занимает позицию сравнением с обменом
+ * индекса хвоста и публикует элемент записью номера ячейки, единственный
+ * потребитель забирает готовые ячейки пачкой без атомарных операций
+ * чтения-изменения-записи. Индексы производителей и потребителя, а также
+ * ячейки лежат в отдельных строках кэша.
+ *
+ * Мьютекс и условные переменные используются только для засыпания:
+ * потребителя - на пустой очереди, производителей - на заполненной
+ * при FullPolicy::Block. Пробуждение выполняется, только если кто-то
+ * действительно ждет.
+ *
+ * close() вызывается после того, как производители закончили работу;
+ * потребитель забирает оставшиеся элементы, после чего popBatch() возвращает 0.
+ *
+ * @tparam T Тип элементов, должен иметь конструктор по умолчанию и перемещение.
+ */
+template <typename T>
+class MpscRing {
+public:
+    /**
+     * @brief Конструктор MpscRing.
+     *
+     * @param capacity Емкость, округляется вверх до степени двойки.
+     * @param policy Действие при заполненной очереди.
+     */
+    explicit MpscRing(size_t capacity = 1024, FullPolicy policy = FullPolicy::Block)
+        : capacity_(roundCapacity(capacity)), mask_(capacity_ - 1), policy_(policy),
+          slots_(new Slot[capacity_]) {
+        for (size_t i = 0; i < capacity_; ++i) {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // Запрещаем копирование и присваивание
+    MpscRing(const MpscRing&) = delete;
+    MpscRing& operator=(const MpscRing&) = delete;
+
+    /**
+     * @brief Добавить элемент в очередь.
+     *
+     * @param value Добавляемый элемент.
+     * @return bool Возвращает false, если очередь закрыта или элемент отброшен.
+     */
+    bool push(T value) {
+        for (unsigned attempt = 0; ; ++attempt) {
+            if (closed_.load(std::memory_order_acquire)) {
+                return false;
+            }
+
+            if (tryPush(value)) {
+                wakeConsumer();
+                return true;
+            }
+
+            if (policy_ == FullPolicy::Drop) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+
+            if (policy_ == FullPolicy::Spin || attempt < kSpinAttempts) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            waitNotFull();
+        }
+    }
+
+    /**
+     * @brief Извлечь пачку элементов, ожидая появления хотя бы одного.
+     *
+     * Вызывается только одним потоком-потребителем.
+     *
+     * @param out Вектор, в конец которого добавляются элементы.
+     * @param max Наибольшее количество элементов.
+     * @return size_t Количество извлеченных элементов, 0 - очередь закрыта и пуста.
+     */
+    size_t popBatch(std::vector<T>& out, size_t max) {
+        for (unsigned attempt = 0; ; ++attempt) {
+            size_t count = tryPopBatch(out, max);
+
+            if (count > 0) {
+                wakeProducers();
+                return count;
+            }
+
+            if (closed_.load(std::memory_order_acquire)) {
+                // Элементы, опубликованные до закрытия, уже видны
+                return tryPopBatch(out, max);
+            }
+
+            if (attempt < kSpinAttempts) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            waitNotEmpty();
+        }
+    }
+
+    /**
+     * @brief Извлечь пачку элементов, ожидая не дольше заданного момента.
+     *
+     * Вызывается только одним потоком-потребителем.
+     *
+     * @param out Вектор, в конец которого добавляются элементы.
+     * @param max Наибольшее количество элементов.
+     * @param deadline Момент, после которого ожидание прекращается.
+     * @return size_t Количество извлеченных элементов, 0 - истекло время или очередь закрыта и пуста.
+     */
+    size_t popBatchUntil(std::vector<T>& out, size_t max, std::chrono::steady_clock::time_point deadline) {
+        while (true) {
+            size_t count = tryPopBatch(out, max);
+
+            if (count > 0) {
+                wakeProducers();
+                return count;
+            }
+
+            if (closed_.load(std::memory_order_acquire)) {
+                return tryPopBatch(out, max);
+            }
+
+            if (std::chrono::steady_clock::now() >= deadline) {
+                return 0;
+            }
+
+            waitNotEmpty(&deadline);
+        }
+    }
+
+    /**
+     * @brief Закрыть очередь и разбудить всех ожидающих.
+     */
+    void close() {
+        closed_.store(true, std::memory_order_release);
+        std::lock_guard<std::mutex> lock(mutex_);
+        not_empty_.notify_all();
+        not_full_.notify_all();
+    }
+
+    /**
+     * @brief Получить количество отброшенных элементов.
+     *
+     * @return uint64_t Количество элементов, отброшенных при FullPolicy::Drop.
+     */
+    uint64_t dropped() const {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Получить емкость очереди.
+     *
+     * @return size_t Емкость.
+     */
+    size_t capacity() const {
+        return capacity_;
+    }
+
+private:
+    static constexpr unsigned kSpinAttempts = 64; /**< Попыток с уступкой процессора перед засыпанием. */
+
+    /**
+     * @brief Ячейка очереди.
+     *
+     * Номер ячейки равен позиции для записи, если ячейка свободна,
+     * и позиции плюс один, если элемент опубликован.
+     */
+    struct alignas(64) Slot {
+        std::atomic<size_t> sequence; /**< Номер ячейки. */
+        T value; /**< Элемент. */
+    };
+
+    /**
+     * @brief Округлить емкость до степени двойки.
+     *
+     * @param capacity Требуемая емкость.
+     * @return size_t Емкость не меньше 2.
+     */
+    static size_t roundCapacity(size_t capacity) {
+        size_t result = 2;
+
+        while (result < capacity) {
+            result <<= 1;
+        }
+
+        return result;
+    }
+
+    /**
+     * @brief Попытаться добавить элемент без ожидания.
+     *
+     * @param value Элемент, перемещается только при успехе.
+     * @return bool Возвращает false, если очередь заполнена.
+     */
+    bool tryPush(T& value) {
+        size_t pos = tail_.load(std::memory_order_relaxed);
+
+        while (true) {
+            Slot& slot = slots_[pos & mask_];
+            size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(sequence - pos);
+
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    slot.value = std::move(value);
+                    slot.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @brief Забрать готовые элементы без ожидания.
+     *
+     * @param out Вектор для элементов.
+     * @param max Наибольшее количество элементов.
+     * @return size_t Количество извлеченных элементов.
+     */
+    size_t tryPopBatch(std::vector<T>& out, size_t max) {
+        size_t count = 0;
+
+        while (count < max) {
+            Slot& slot = slots_[head_ & mask_];
+
+            if (slot.sequence.load(std::memory_order_acquire) != head_ + 1) {
+                break;
+            }
+
+            out.push_back(std::move(slot.value));
+            slot.value = T();
+            slot.sequence.store(head_ + capacity_, std::memory_order_release);
+            ++head_;
+            ++count;
+        }
+
+        return count;
+    }
+
+    /**
+     * @brief Проверить, опубликован ли следующий элемент для потребителя.
+     */
+    bool readable() const {
+        return slots_[head_ & mask_].sequence.load(std::memory_order_acquire) == head_ + 1;
+    }
+
+    /**
+     * @brief Проверить, свободна ли следующая позиция для производителей.
+     */
+    bool writable() const {
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        return slots_[pos & mask_].sequence.load(std::memory_order_acquire) == pos;
+    }
+
+    /**
+     * @brief Уснуть до появления элемента или закрытия очереди.
+     *
+     * @param deadline Момент окончания ожидания, nullptr - без ограничения.
+     */
+    void waitNotEmpty(const std::chrono::steady_clock::time_point* deadline = nullptr) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        consumer_waiting_.store(true, std::memory_order_relaxed);
+        // Парный барьер в wakeConsumer(): либо производитель увидит флаг,
+        // либо потребитель увидит опубликованный элемент
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (!readable() && !closed_.load(std::memory_order_acquire)) {
+            if (deadline != nullptr) {
+                not_empty_.wait_until(lock, *deadline);
+            } else {
+                not_empty_.wait(lock);
+            }
+        }
+
+        consumer_waiting_.store(false, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Уснуть до освобождения места или закрытия очереди.
+     */
+    void waitNotFull() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        producers_waiting_.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (!writable() && !closed_.load(std::memory_order_acquire)) {
+            not_full_.wait(lock);
+        }
+
+        producers_waiting_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Разбудить потребителя, если он ждет.
+     */
+    void wakeConsumer() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (consumer_waiting_.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            not_empty_.notify_one();
+        }
+    }
+
+    /**
+     * @brief Разбудить производителей, если они ждут.
+     */
+    void wakeProducers() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (producers_waiting_.load(std::memory_order_relaxed) > 0) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            not_full_.notify_all();
+        }
+    }
+
+    const size_t capacity_; /**< Емкость, степень двойки. */
+    const size_t mask_; /**< Маска позиции в буфере. */
+    const FullPolicy policy_; /**< Действие при заполненной очереди. */
+    std::unique_ptr<Slot[]> slots_; /**< Ячейки очереди. */
+
+    alignas(64) std::atomic<size_t> tail_{0}; /**< Позиция записи производителей. */
+    alignas(64) size_t head_ = 0; /**< Позиция чтения потребителя. */
+    alignas(64) std::atomic<bool> closed_{false}; /**< Флаг закрытия очереди. */
+    std::atomic<bool> consumer_waiting_{false}; /**< Потребитель спит. */
+    std::atomic<size_t> producers_waiting_{0}; /**< Количество спящих производителей. */
+    std::atomic<uint64_t> dropped_{0}; /**< Количество отброшенных элементов. */
+    std::mutex mutex_; /**< Мьютекс засыпания. */
+    std::condition_variable not_empty_; /**< Условие появления элементов. */
+    std::condition_variable not_full_; /**< Условие освобождения места. */
+};
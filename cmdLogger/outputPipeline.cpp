@@ -0,0 +1,455 @@
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include "blockStore.h"
+#include "bulkSink.h"
+#include "commandBlock.h"
+#include "latencyTracer.h"
+#include "metrics.h"
+#include "outputPipeline.h"
+
+
+namespace {
+
+constexpr size_t kBatchSize = 64; /**< Наибольшее количество пачек, забираемых из очереди за раз. */
+constexpr const char* kConsoleOutput = "console"; /**< Имя вывода в консоль в трассах задержек. */
+constexpr const char* kStoreOutput = "store"; /**< Имя вывода в хранилище в трассах задержек. */
+
+using Stage = LatencyTracer::Stage;
+
+}
+
+OutputPipeline::OutputPipeline(const LoggerOptions& options,
+                               std::unique_ptr<BulkSink> console,
+                               std::unique_ptr<BulkSink> files)
+    : durability_(options.durability), group_size_(options.groupSize),
+      group_time_(options.groupTime), console_(std::move(console)), files_(std::move(files)) {
+    if (!options.sinks.empty()) {
+        startSinks(options);
+        return;
+    }
+
+    if (!console_) {
+        console_ = std::make_unique<ConsoleSink>();
+    }
+
+    if (!files_) {
+        files_ = std::make_unique<StoreSink>(makeBlockStore(options));
+    }
+
+    if (durability_ == Durability::Group || (options.pipeline && durability_ != Durability::None)) {
+        console_queue_ = std::make_unique<MpscRing<Job>>(options.queueCapacity, options.queuePolicy);
+
+        // Сжатие - самая дорогая часть записи, оно не должно идти в одном потоке фиксации
+        if (options.compression != Compression::None) {
+            startFileThreads(options);
+        }
+
+        console_thread_ = std::thread(&OutputPipeline::commitLoop, this);
+    } else if (options.pipeline) {
+        console_queue_ = std::make_unique<MpscRing<Job>>(options.queueCapacity, options.queuePolicy);
+        console_thread_ = std::thread(&OutputPipeline::consoleLoop, this);
+        startFileThreads(options);
+    }
+}
+
+void OutputPipeline::startFileThreads(const LoggerOptions& options) {
+    for (std::size_t i = 0; i < std::max<std::size_t>(options.fileThreads, 1); ++i) {
+        file_queues_.push_back(std::make_unique<MpscRing<Job>>(options.queueCapacity, options.queuePolicy));
+    }
+
+    for (auto& queue : file_queues_) {
+        file_threads_.emplace_back(&OutputPipeline::fileLoop, this, std::ref(*queue));
+    }
+}
+
+void OutputPipeline::startSinks(const LoggerOptions& options) {
+    for (const SinkOptions& sink : options.sinks) {
+        auto node = std::make_unique<SinkNode>();
+        node->sink = makeSink(sink, options);
+        node->queue = std::make_unique<BoundedQueue<Job>>(sink.queueCapacity, sink.overflow, sink.sampleEvery);
+        node->metrics = &Metrics::instance().addSink(sink.name);
+
+        // Хранилище допускает запись из нескольких потоков, порядок важен только консоли и пересылке
+        size_t workers = sink.type == SinkType::Store ? std::max<std::size_t>(options.fileThreads, 1) : 1;
+
+        for (size_t i = 0; i < workers; ++i) {
+            node->workers.emplace_back(&OutputPipeline::sinkLoop, this, std::ref(*node));
+        }
+
+        sinks_.push_back(std::move(node));
+    }
+}
+
+OutputPipeline::~OutputPipeline() {
+    try {
+        drain();
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+    }
+}
+
+void OutputPipeline::submit(Bulk bulk) {
+    if (bulk.empty()) {
+        return;
+    }
+
+    Metrics& metrics = Metrics::instance();
+    metrics.bulks.add();
+    metrics.blocks.add(bulk.size());
+    LatencyTracer& tracer = LatencyTracer::instance();
+    tracer.recordBlocks(bulk, Stage::Close);
+
+    if (!sinks_.empty()) {
+        auto shared = std::make_shared<const Bulk>(std::move(bulk));
+        auto now = std::chrono::steady_clock::now();
+
+        for (const auto& node : sinks_) {
+            if (node->queue->push(Job{shared, now, nullptr}) > 0) {
+                node->metrics->dropped.add();
+            }
+
+            node->metrics->depth.store(node->queue->size(), std::memory_order_relaxed);
+        }
+
+        return;
+    }
+
+    if (!console_thread_.joinable()) {
+        if (durability_ == Durability::None) {
+            console_->write(bulk);
+            tracer.recordBlocks(bulk, Stage::Write, kConsoleOutput);
+            files_->write(bulk);
+            files_->submit();
+            tracer.recordBlocks(bulk, Stage::Write, kStoreOutput);
+            return;
+        }
+
+        files_->write(bulk);
+        tracer.recordBlocks(bulk, Stage::Write, kStoreOutput);
+        auto start = std::chrono::steady_clock::now();
+        files_->sync();
+        metrics.syncLatency.record(std::chrono::steady_clock::now() - start);
+        metrics.syncs.add();
+        tracer.recordBlocks(bulk, Stage::Sync, kStoreOutput);
+        console_->write(bulk);
+        tracer.recordBlocks(bulk, Stage::Write, kConsoleOutput);
+        return;
+    }
+
+    auto shared = std::make_shared<const Bulk>(std::move(bulk));
+    auto now = std::chrono::steady_clock::now();
+
+    if (file_queues_.empty()) {
+        enqueue(*console_queue_, Job{std::move(shared), now, nullptr});
+        return;
+    }
+
+    // При гарантии сохранности поток фиксации ждет записи пачки пулом
+    auto written = durability_ != Durability::None ? std::make_shared<WriteStatus>() : nullptr;
+    size_t file_queue = next_file_queue_.fetch_add(1, std::memory_order_relaxed) % file_queues_.size();
+    enqueue(*console_queue_, Job{shared, now, written});
+    enqueue(*file_queues_[file_queue], Job{std::move(shared), now, written});
+}
+
+void OutputPipeline::enqueue(MpscRing<Job>& queue, Job job) {
+    std::shared_ptr<WriteStatus> written = job.written;
+
+    if (!queue.push(std::move(job))) {
+        Metrics::instance().droppedBulks.add();
+
+        // Отброшенная очередью записи пачка не будет подтверждена
+        if (written && &queue != console_queue_.get()) {
+            finishWrite(*written, false);
+        }
+    }
+}
+
+void OutputPipeline::drain() {
+    if (console_queue_) {
+        console_queue_->close();
+    }
+
+    for (auto& queue : file_queues_) {
+        queue->close();
+    }
+
+    if (console_thread_.joinable()) {
+        console_thread_.join();
+    }
+
+    for (auto& thread : file_threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+
+    for (const auto& node : sinks_) {
+        node->queue->close();
+    }
+
+    for (const auto& node : sinks_) {
+        for (auto& thread : node->workers) {
+            if (thread.joinable()) {
+                thread.join();
+            }
+        }
+
+        try {
+            node->sink->flush();
+        } catch (...) {
+            storeError();
+        }
+    }
+
+    try {
+        // В режиме графа вывода приемники консоли и файлов не создаются
+        if (console_) {
+            console_->flush();
+        }
+
+        if (files_) {
+            files_->flush();
+        }
+    } catch (...) {
+        storeError();
+    }
+
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(error_mutex_);
+        std::swap(error, error_);
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void OutputPipeline::sinkLoop(SinkNode& node) {
+    std::vector<Job> jobs;
+    LatencyTracer& tracer = LatencyTracer::instance();
+    const char* output = node.metrics->name.c_str();
+
+    while (node.queue->popBatch(jobs, kBatchSize) > 0) {
+        node.metrics->depth.store(node.queue->size(), std::memory_order_relaxed);
+
+        for (const Job& job : jobs) {
+            auto wait = std::chrono::steady_clock::now() - job.enqueued;
+            Metrics::instance().queueWait.record(wait);
+            node.metrics->queueWait.record(wait);
+            node.metrics->lag.store(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(wait).count()),
+                                    std::memory_order_relaxed);
+            tracer.recordBlocks(*job.bulk, Stage::Dequeue, output);
+
+            try {
+                node.sink->write(*job.bulk);
+                tracer.recordBlocks(*job.bulk, Stage::Write, output);
+                node.metrics->bulks.add();
+            } catch (...) {
+                storeError();
+            }
+        }
+
+        jobs.clear();
+
+        try {
+            node.sink->submit();
+        } catch (...) {
+            storeError();
+        }
+    }
+}
+
+void OutputPipeline::consoleLoop() {
+    std::vector<Job> jobs;
+    LatencyTracer& tracer = LatencyTracer::instance();
+
+    while (console_queue_->popBatch(jobs, kBatchSize) > 0) {
+        for (const Job& job : jobs) {
+            Metrics::instance().queueWait.record(std::chrono::steady_clock::now() - job.enqueued);
+            tracer.recordBlocks(*job.bulk, Stage::Dequeue, kConsoleOutput);
+
+            try {
+                console_->write(*job.bulk);
+                tracer.recordBlocks(*job.bulk, Stage::Write, kConsoleOutput);
+            } catch (...) {
+                storeError();
+            }
+        }
+
+        jobs.clear();
+    }
+}
+
+void OutputPipeline::commitLoop() {
+    std::vector<Job> jobs;
+    std::vector<Job> group;
+    size_t group_bytes = 0;
+    auto deadline = std::chrono::steady_clock::time_point::max();
+    LatencyTracer& tracer = LatencyTracer::instance();
+
+    while (true) {
+        size_t count = group.empty() ? console_queue_->popBatch(jobs, kBatchSize)
+                                     : console_queue_->popBatchUntil(jobs, kBatchSize, deadline);
+
+        if (count == 0 && group.empty()) {
+            break;
+        }
+
+        for (Job& job : jobs) {
+            Metrics::instance().queueWait.record(std::chrono::steady_clock::now() - job.enqueued);
+            // Консоль получает пачку из той же очереди после сброса окна на диск
+            tracer.recordBlocks(*job.bulk, Stage::Dequeue, kConsoleOutput);
+
+            // Несохраненная пачка не попадает в окно и не подтверждается в консоли
+            if (job.written) {
+                if (!waitWrite(*job.written)) {
+                    continue;
+                }
+            } else {
+                tracer.recordBlocks(*job.bulk, Stage::Dequeue, kStoreOutput);
+
+                try {
+                    files_->write(*job.bulk);
+                    tracer.recordBlocks(*job.bulk, Stage::Write, kStoreOutput);
+                } catch (...) {
+                    storeError();
+                    continue;
+                }
+            }
+
+            if (group.empty()) {
+                deadline = std::chrono::steady_clock::now() + group_time_;
+            }
+
+            for (const auto& block : *job.bulk) {
+                group_bytes += block.getByteSize();
+            }
+
+            group.push_back(std::move(job));
+
+            if (durability_ == Durability::Block) {
+                commitGroup(group);
+            }
+        }
+
+        jobs.clear();
+
+        // Записи пула передаются хранилищу его потоками
+        try {
+            if (file_queues_.empty()) {
+                files_->submit();
+            }
+        } catch (...) {
+            // Неизвестно, какие из отложенных записей окна дошли до хранилища
+            storeError();
+            group.clear();
+        }
+
+        // Окно закрывается по объему, по времени, при закрытии очереди
+        // или когда новых пачек не пришло до конца окна
+        if (!group.empty() && (count == 0 || group_bytes >= group_size_ || std::chrono::steady_clock::now() >= deadline)) {
+            commitGroup(group);
+        }
+
+        if (group.empty()) {
+            group_bytes = 0;
+        }
+    }
+}
+
+void OutputPipeline::commitGroup(std::vector<Job>& group) {
+    Metrics& metrics = Metrics::instance();
+    LatencyTracer& tracer = LatencyTracer::instance();
+
+    try {
+        auto start = std::chrono::steady_clock::now();
+        files_->sync();
+        metrics.syncLatency.record(std::chrono::steady_clock::now() - start);
+        metrics.syncs.add();
+
+        for (const Job& job : group) {
+            tracer.recordBlocks(*job.bulk, Stage::Sync, kStoreOutput);
+        }
+
+        for (const Job& job : group) {
+            console_->write(*job.bulk);
+            tracer.recordBlocks(*job.bulk, Stage::Write, kConsoleOutput);
+        }
+    } catch (...) {
+        // Пачки окна не подтверждаются в консоли, если их не удалось сбросить
+        storeError();
+    }
+
+    group.clear();
+}
+
+void OutputPipeline::fileLoop(MpscRing<Job>& queue) {
+    std::vector<Job> jobs;
+    LatencyTracer& tracer = LatencyTracer::instance();
+
+    std::vector<bool> written;
+
+    while (queue.popBatch(jobs, kBatchSize) > 0) {
+        written.assign(jobs.size(), true);
+
+        for (size_t i = 0; i < jobs.size(); ++i) {
+            const Job& job = jobs[i];
+            Metrics::instance().queueWait.record(std::chrono::steady_clock::now() - job.enqueued);
+            tracer.recordBlocks(*job.bulk, Stage::Dequeue, kStoreOutput);
+
+            try {
+                files_->write(*job.bulk);
+                tracer.recordBlocks(*job.bulk, Stage::Write, kStoreOutput);
+            } catch (...) {
+                storeError();
+                written[i] = false;
+            }
+        }
+
+        // Записи всей пачки передаются системе одним вызовом
+        bool submitted = true;
+
+        try {
+            files_->submit();
+        } catch (...) {
+            storeError();
+            submitted = false;
+        }
+
+        for (size_t i = 0; i < jobs.size(); ++i) {
+            if (jobs[i].written) {
+                finishWrite(*jobs[i].written, written[i] && submitted);
+            }
+        }
+
+        jobs.clear();
+    }
+}
+
+void OutputPipeline::finishWrite(WriteStatus& status, bool written) {
+    {
+        std::lock_guard<std::mutex> lock(written_mutex_);
+        status.state = written ? WriteStatus::Written : WriteStatus::Failed;
+    }
+
+    written_cv_.notify_all();
+}
+
+bool OutputPipeline::waitWrite(const WriteStatus& status) {
+    std::unique_lock<std::mutex> lock(written_mutex_);
+    written_cv_.wait(lock, [&status]() { return status.state != WriteStatus::Pending; });
+    return status.state == WriteStatus::Written;
+}
+
+void OutputPipeline::storeError() {
+    std::lock_guard<std::mutex> lock(error_mutex_);
+
+    if (!error_) {
+        error_ = std::current_exception();
+    }
+}
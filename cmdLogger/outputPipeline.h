@@ -0,0 +1,214 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "boundedQueue.h"
+#include "bulkSink.h"
+#include "commandBlock.h"
+#include "loggerOptions.h"
+#include "metrics.h"
+#include "mpscRing.h"
+
+/**
+ * @brief Класс OutputPipeline выводит завершенные пачки блоков.
+ * 
+ * Пачка передается приемнику консоли, который печатает ее одной строкой
+ * "bulk: ...", и файловому приемнику, который сохраняет каждый ее блок
+ * в хранилище блоков (BlockStore). В синхронном режиме это делается
+ * в вызывающем потоке. В режиме конвейера пачки передаются через очереди
+ * одному потоку консоли, который сохраняет порядок вывода, и пулу потоков
+ * записи в файлы, поэтому медленный диск не задерживает чтение команд.
+ * Очереди - ограниченные кольцевые буферы MpscRing без блокировок,
+ * у каждого потока записи своя очередь, пачки распределяются по кругу.
+ * Поведение при заполнении очереди задается LoggerOptions::queuePolicy.
+ * 
+ * Если задана гарантия сохранности (LoggerOptions::durability), пачка
+ * выводится в консоль только после того, как ее блоки сброшены на диск.
+ * В режиме конвейера тогда вместо потоков консоли и записи работает один
+ * поток фиксации: он сохраняет пачки по порядку, накапливает окно фиксации
+ * до groupSize байтов команд или groupTime мс, сбрасывает окно на диск
+ * одним вызовом sync() и только затем печатает его пачки. Режим Group
+ * всегда работает в отдельном потоке. При сжатии блоков пачки сжимаются
+ * и записываются пулом из fileThreads потоков записи, а поток фиксации
+ * по порядку дожидается записи каждой пачки, так что сжатие не
+ * ограничено одним потоком.
+ * 
+ * Если заданы приемники графа вывода (LoggerOptions::sinks), пачка вместо
+ * этого передается каждому приемнику через его собственную ограниченную
+ * очередь BoundedQueue со своим действием при переполнении и своими
+ * потоками: у хранилища - fileThreads потоков, у остальных - по одному.
+ * Пачка передается приемникам по очереди в вызывающем потоке, поэтому
+ * заполненная очередь с ожиданием задерживает и остальные приемники;
+ * вытеснение и выборка не задерживают вообще. Разбор --sink по умолчанию
+ * задает ожидание только хранилищу, так что медленная консоль или
+ * пересылка не задерживают сохранение. Показатели каждого приемника
+ * регистрируются в Metrics.
+ */
+class OutputPipeline {
+public:
+    /**
+     * @brief Конструктор OutputPipeline.
+     * 
+     * @param options Настройки вывода.
+     * @param console Приемник консоли, по умолчанию ConsoleSink.
+     * @param files Файловый приемник, по умолчанию StoreSink с хранилищем из настроек.
+     */
+    explicit OutputPipeline(const LoggerOptions& options = LoggerOptions(),
+                            std::unique_ptr<BulkSink> console = nullptr,
+                            std::unique_ptr<BulkSink> files = nullptr);
+
+    // Запрещаем копирование и присваивание
+    OutputPipeline(const OutputPipeline&) = delete;
+    OutputPipeline& operator=(const OutputPipeline&) = delete;
+
+    /**
+     * @brief Деструктор дожидается вывода всех переданных пачек.
+     */
+    ~OutputPipeline();
+
+    /**
+     * @brief Передать пачку блоков на вывод.
+     * 
+     * @param bulk Пачка блоков.
+     * @throws std::runtime_error В синхронном режиме, если пачку не удается вывести.
+     */
+    void submit(Bulk bulk);
+
+    /**
+     * @brief Дождаться вывода всех переданных пачек и остановить потоки.
+     * 
+     * @throws std::runtime_error Если в потоке вывода произошла ошибка.
+     */
+    void drain();
+
+private:
+    using BulkPtr = std::shared_ptr<const Bulk>; /**< Пачка, разделяемая потоками вывода. */
+
+    /**
+     * @brief Состояние записи пачки пулом потоков при гарантии сохранности.
+     *
+     * Поле state защищено мьютексом written_mutex_ конвейера.
+     */
+    struct WriteStatus {
+        enum State { Pending, Written, Failed };
+        State state = Pending; /**< Результат записи. */
+    };
+
+    /**
+     * @brief Пачка в очереди вывода.
+     */
+    struct Job {
+        BulkPtr bulk; /**< Пачка блоков. */
+        std::chrono::steady_clock::time_point enqueued; /**< Время постановки в очередь. */
+        std::shared_ptr<WriteStatus> written; /**< Состояние записи пулом для потока фиксации или nullptr. */
+    };
+
+    /**
+     * @brief Приемник графа вывода с очередью и потоками.
+     */
+    struct SinkNode {
+        std::unique_ptr<BulkSink> sink; /**< Приемник. */
+        std::unique_ptr<BoundedQueue<Job>> queue; /**< Очередь пачек приемника. */
+        SinkMetrics* metrics = nullptr; /**< Показатели приемника. */
+        std::vector<std::thread> workers; /**< Потоки приемника. */
+    };
+
+    /**
+     * @brief Создать приемники графа вывода и запустить их потоки.
+     * 
+     * @param options Настройки вывода.
+     */
+    void startSinks(const LoggerOptions& options);
+
+    /**
+     * @brief Создать очереди и запустить пул потоков записи в файлы.
+     * 
+     * @param options Настройки вывода.
+     */
+    void startFileThreads(const LoggerOptions& options);
+
+    /**
+     * @brief Цикл потока приемника графа вывода.
+     * 
+     * @param node Приемник.
+     */
+    void sinkLoop(SinkNode& node);
+
+    /**
+     * @brief Цикл потока вывода в консоль.
+     */
+    void consoleLoop();
+
+    /**
+     * @brief Цикл потока фиксации пачек при заданной гарантии сохранности.
+     *
+     * Пачка, которую не удалось записать в хранилище, в окно не попадает,
+     * а при ошибке передачи отложенных записей отбрасывается все окно:
+     * консоль подтверждает только сброшенные на диск пачки.
+     */
+    void commitLoop();
+
+    /**
+     * @brief Сбросить окно фиксации на диск и вывести его пачки в консоль.
+     * 
+     * @param group Пачки окна, очищается.
+     */
+    void commitGroup(std::vector<Job>& group);
+
+    /**
+     * @brief Цикл потока записи в файлы.
+     * 
+     * @param queue Очередь потока.
+     */
+    void fileLoop(MpscRing<Job>& queue);
+
+    /**
+     * @brief Сообщить потоку фиксации результат записи пачки пулом.
+     * 
+     * @param status Состояние записи пачки.
+     * @param written Пачка записана.
+     */
+    void finishWrite(WriteStatus& status, bool written);
+
+    /**
+     * @brief Дождаться записи пачки пулом.
+     * 
+     * @param status Состояние записи пачки.
+     * @return bool Возвращает true, если пачка записана.
+     */
+    bool waitWrite(const WriteStatus& status);
+
+    /**
+     * @brief Передать пачку в очередь с учетом отброшенных пачек.
+     * 
+     * @param queue Очередь.
+     * @param job Пачка.
+     */
+    void enqueue(MpscRing<Job>& queue, Job job);
+
+    /**
+     * @brief Запомнить первую ошибку потока вывода.
+     */
+    void storeError();
+
+    Durability durability_; /**< Гарантия сохранности блоков. */
+    size_t group_size_; /**< Наибольший объем команд окна фиксации. */
+    std::chrono::milliseconds group_time_; /**< Наибольшая длительность окна фиксации. */
+    std::unique_ptr<BulkSink> console_; /**< Приемник консоли. */
+    std::unique_ptr<BulkSink> files_; /**< Файловый приемник. */
+    std::unique_ptr<MpscRing<Job>> console_queue_; /**< Очередь пачек для консоли. */
+    std::vector<std::unique_ptr<MpscRing<Job>>> file_queues_; /**< Очереди пачек потоков записи в файлы. */
+    std::atomic<size_t> next_file_queue_{0}; /**< Счетчик распределения пачек по потокам записи. */
+    std::thread console_thread_; /**< Поток вывода в консоль или поток фиксации. */
+    std::vector<std::thread> file_threads_; /**< Пул потоков записи в файлы. */
+    std::vector<std::unique_ptr<SinkNode>> sinks_; /**< Приемники графа вывода. */
+    std::mutex written_mutex_; /**< Мьютекс состояний записи пачек. */
+    std::condition_variable written_cv_; /**< Сигнал о записи пачки пулом. */
+    std::mutex error_mutex_; /**< Мьютекс первой ошибки. */
+    std::exception_ptr error_; /**< Первая ошибка потоков вывода. */
+};
@@ -0,0 +1,390 @@
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <fcntl.h>
+#include <unistd.h>
+#include "commandBlock.h"
+#include "gzipCompressor.h"
+#include "ioVector.h"
+#include "metrics.h"
+#include "segmentStore.h"
+#include "timeIndex.h"
+
+namespace {
+
+void throwSystemError(const std::string& what) {
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+}
+
+SegmentStore::SegmentStore(std::string dir, size_t segment_size, size_t segment_age, bool durable,
+                           std::unique_ptr<UringWriter> uring, int compress_level, std::unique_ptr<TimeIndex> index)
+    : dir_(std::move(dir)), segment_size_(segment_size), segment_age_(segment_age), fd_(-1), offset_(0),
+      durable_(durable), uring_(std::move(uring)), index_(std::move(index)), compress_level_(compress_level),
+      dir_unsynced_(false), segment_unsynced_(false) {}
+
+SegmentStore::~SegmentStore() {
+    if (compress_level_ > 0) {
+        try {
+            flushFrame();
+        } catch (const std::exception&) {
+            // Ошибка уже не может быть передана вызывающему
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // Деструктор UringWriter тоже дожидается записей, но сегмент нужно обрезать после них
+    if (uring_) {
+        try {
+            uring_->waitAll();
+        } catch (const std::exception&) {
+            // Ошибка уже не может быть передана вызывающему
+        }
+    }
+
+    if (fd_ >= 0) {
+        if (::ftruncate(fd_, static_cast<off_t>(offset_)) != 0) {
+            // Хвост сегмента остается заполненным нулями
+        }
+
+        ::close(fd_);
+    }
+}
+
+std::string SegmentStore::formatHeader(const CommandBlock& block) {
+    return "bulk ts=" + std::to_string(block.getBlockStartTimeSeconds())
+        + " seq=" + std::to_string(block.getSequence())
+        + " count=" + std::to_string(block.getSize())
+        + " bytes=" + std::to_string(block.getByteSize()) + "\n";
+}
+
+void SegmentStore::save(const CommandBlock& block) {
+    std::string header = formatHeader(block);
+
+    if (compress_level_ > 0) {
+        saveCompressed(header, block);
+        return;
+    }
+
+    std::string_view bytes = block.getBytes();
+    size_t record_size = header.size() + block.getByteSize();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    prepareSegment(record_size, block.getBlockStartTimeSeconds(), block.getSequence());
+
+    if (!block.hasContiguousBytes()) {
+        writeChunked(header, block);
+    } else if (uring_) {
+        uring_->write(fd_, static_cast<off_t>(offset_), header, bytes);
+    } else {
+        IoVector iov;
+        iov.add(header);
+        iov.add(bytes);
+        iov.writeAt(fd_, static_cast<off_t>(offset_));
+    }
+
+    long long ts = block.getBlockStartTimeSeconds();
+    indexPart(offset_, record_size, ts, ts, 1);
+    offset_ += record_size;
+    segment_unsynced_ = true;
+}
+
+void SegmentStore::saveCompressed(const std::string& header, const CommandBlock& block) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    size_t record_size = header.size() + block.getByteSize();
+    long long ts = block.getBlockStartTimeSeconds();
+
+    // Крупный блок сжимается отдельным членом, не копируясь в кадр
+    if (record_size >= kFrameSize) {
+        Frame frame;
+        bool has_frame = takeFrame(frame);
+
+        Frame single;
+        single.ts = single.minTs = single.maxTs = ts;
+        single.seq = block.getSequence();
+        single.blocks = 1;
+        single.ticket = next_ticket_++;
+        lock.unlock();
+
+        if (has_frame) {
+            try {
+                writeFrame([&frame](GzipCompressor& compressor) { return compressor.compress(frame.data); }, frame);
+            } catch (...) {
+                writeFrame(nullptr, single);
+                throw;
+            }
+        }
+
+        writeFrame([&header, &block](GzipCompressor& compressor) { return compressor.compress(header, block); },
+                   single);
+        return;
+    }
+
+    if (frame_.data.empty()) {
+        frame_.ts = frame_.minTs = frame_.maxTs = ts;
+        frame_.seq = block.getSequence();
+    }
+
+    frame_.data += header;
+    block.forEachChunk([this](std::string_view chunk) { frame_.data += chunk; });
+    frame_.minTs = std::min(frame_.minTs, ts);
+    frame_.maxTs = std::max(frame_.maxTs, ts);
+    ++frame_.blocks;
+
+    if (frame_.data.size() >= kFrameSize) {
+        Frame frame;
+        takeFrame(frame);
+        lock.unlock();
+        writeFrame([&frame](GzipCompressor& compressor) { return compressor.compress(frame.data); }, frame);
+    }
+}
+
+bool SegmentStore::takeFrame(Frame& frame) {
+    if (frame_.data.empty()) {
+        return false;
+    }
+
+    frame = std::move(frame_);
+    frame_ = Frame();
+    frame.ticket = next_ticket_++;
+    return true;
+}
+
+void SegmentStore::writeFrame(const CompressFunc& compress, const Frame& frame) {
+    std::string_view compressed;
+    std::exception_ptr error;
+
+    if (compress) {
+        try {
+            compressed = compress(GzipCompressor::forThread(compress_level_));
+        } catch (...) {
+            error = std::current_exception();
+        }
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    turn_.wait(lock, [this, &frame]() { return written_ticket_ == frame.ticket; });
+
+    // Очередь кадров продвигается и при ошибке, иначе остальные потоки ждали бы вечно
+    struct TurnGuard {
+        SegmentStore* store;
+
+        ~TurnGuard() {
+            ++store->written_ticket_;
+            store->turn_.notify_all();
+        }
+    } guard{this};
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+
+    if (!compress) {
+        return;
+    }
+
+    prepareSegment(compressed.size(), frame.ts, frame.seq);
+
+    if (uring_) {
+        uring_->write(fd_, static_cast<off_t>(offset_), compressed, {});
+    } else {
+        IoVector iov;
+        iov.add(compressed);
+        iov.writeAt(fd_, static_cast<off_t>(offset_));
+    }
+
+    indexPart(offset_, compressed.size(), frame.minTs, frame.maxTs, frame.blocks);
+
+    offset_ += compressed.size();
+    segment_unsynced_ = true;
+    Metrics::instance().compressedBytes.add(compressed.size());
+}
+
+void SegmentStore::flushFrame() {
+    Frame frame;
+    std::unique_lock<std::mutex> lock(mutex_);
+    bool has_frame = takeFrame(frame);
+    lock.unlock();
+
+    if (has_frame) {
+        writeFrame([&frame](GzipCompressor& compressor) { return compressor.compress(frame.data); }, frame);
+    }
+
+    // Кадры, сжимаемые другими потоками, тоже должны быть записаны
+    lock.lock();
+    turn_.wait(lock, [this]() { return written_ticket_ == next_ticket_; });
+}
+
+void SegmentStore::prepareSegment(size_t record_size, long long ts, size_t seq) {
+    if (fd_ >= 0) {
+        bool full = offset_ > 0 && offset_ + record_size > segment_size_;
+        bool expired = segment_age_.count() > 0 && std::chrono::steady_clock::now() - opened_ >= segment_age_;
+
+        if (full || expired) {
+            closeSegment();
+        }
+    }
+
+    if (fd_ < 0) {
+        openSegment(ts, seq);
+    }
+}
+
+void SegmentStore::indexPart(size_t offset, size_t length, long long min_ts, long long max_ts, uint32_t blocks) {
+    if (!index_) {
+        return;
+    }
+
+    TimeIndex::Entry part;
+    part.minTs = min_ts;
+    part.maxTs = max_ts;
+    part.fileTs = segment_ts_;
+    part.fileSeq = segment_seq_;
+    part.fileSuffix = segment_suffix_;
+    part.offset = offset;
+    part.length = length;
+    part.flags = TimeIndex::kSegment | (compress_level_ > 0 ? TimeIndex::kCompressed : 0);
+    part.blocks = blocks;
+    index_->add(part);
+}
+
+void SegmentStore::writeChunked(const std::string& header, const CommandBlock& block) {
+    off_t offset = static_cast<off_t>(offset_);
+
+    auto writeChunk = [this, &offset](std::string_view chunk) {
+        if (uring_) {
+            uring_->write(fd_, offset, chunk, {});
+        } else {
+            IoVector iov;
+            iov.add(chunk);
+            iov.writeAt(fd_, offset);
+        }
+
+        offset += static_cast<off_t>(chunk.size());
+    };
+
+    writeChunk(header);
+    block.forEachChunk(writeChunk);
+}
+
+void SegmentStore::flush() {
+    if (compress_level_ > 0) {
+        flushFrame();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (fd_ >= 0) {
+        closeSegment();
+    }
+
+    if (index_) {
+        index_->flush();
+    }
+}
+
+void SegmentStore::submit() {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (uring_) {
+        uring_->submit();
+    }
+}
+
+void SegmentStore::sync() {
+    if (compress_level_ > 0) {
+        flushFrame();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (fd_ >= 0 && segment_unsynced_) {
+        if (uring_) {
+            uring_->sync(fd_);
+        } else if (::fdatasync(fd_) != 0) {
+            throwSystemError("fdatasync");
+        }
+
+        segment_unsynced_ = false;
+    }
+
+    if (dir_unsynced_) {
+        syncDirectory(dir_);
+        dir_unsynced_ = false;
+    }
+
+    // Индекс сбрасывается после данных, чтобы не ссылаться на несохраненные участки
+    if (index_) {
+        index_->sync();
+    }
+}
+
+void SegmentStore::openSegment(long long ts, size_t seq) {
+    std::string base = dir_ + "/bulk" + std::to_string(ts) + "-" + std::to_string(seq);
+    std::string extension = compress_level_ > 0 ? ".seg.gz" : ".seg";
+    std::string path = base + extension;
+    segment_ts_ = ts;
+    segment_seq_ = seq;
+    segment_suffix_ = 0;
+
+    for (int attempt = 1; ; ++attempt) {
+        fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+
+        if (fd_ >= 0) {
+            break;
+        }
+
+        if (errno != EEXIST) {
+            throwSystemError("Unable to create segment " + path);
+        }
+
+        path = base + "-" + std::to_string(attempt) + extension;
+        segment_suffix_ = static_cast<uint32_t>(attempt);
+    }
+
+    // Предварительное выделение - оптимизация, ошибка не критична
+    ::posix_fallocate(fd_, 0, static_cast<off_t>(segment_size_));
+
+    offset_ = 0;
+    opened_ = std::chrono::steady_clock::now();
+    dir_unsynced_ = durable_;
+}
+
+void SegmentStore::closeSegment() {
+    int fd = fd_;
+    fd_ = -1;
+
+    if (uring_) {
+        try {
+            uring_->waitAll();
+        } catch (...) {
+            ::close(fd);
+            throw;
+        }
+    }
+
+    if (::ftruncate(fd, static_cast<off_t>(offset_)) != 0) {
+        int error = errno;
+        ::close(fd);
+        throw std::system_error(error, std::generic_category(), "ftruncate");
+    }
+
+    if (durable_ && ::fdatasync(fd) != 0) {
+        int error = errno;
+        ::close(fd);
+        throw std::system_error(error, std::generic_category(), "fdatasync");
+    }
+
+    segment_unsynced_ = false;
+
+    if (::close(fd) != 0) {
+        throwSystemError("close");
+    }
+}
@@ -0,0 +1,228 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include "blockStore.h"
+#include "commandBlock.h"
+#include "gzipCompressor.h"
+#include "timeIndex.h"
+#include "uringWriter.h"
+
+/**
+ * @brief Класс SegmentStore дописывает блоки команд в сегментные файлы.
+ * 
+ * Вместо отдельного файла на каждый блок блоки последовательно дописываются
+ * в заранее выделенный (posix_fallocate) сегмент bulk<время>-<номер>.seg.
+ * Каждой записи предшествует строка заголовка
+ * 
+ *     bulk ts=<время начала> seq=<номер блока> count=<команд> bytes=<длина>
+ * 
+ * за которой следуют <длина> байтов команд, каждая с завершающим '\n'.
+ * Новый сегмент открывается, когда запись не помещается в текущий или
+ * когда истек наибольший возраст сегмента. При закрытии сегмент обрезается
+ * до записанной длины; после аварийного завершения хвост сегмента
+ * заполнен нулевыми байтами, на которых чтение записей прекращается.
+ * 
+ * В режиме сохранности sync() сбрасывает на диск текущий сегмент одним
+ * вызовом fdatasync, закрываемые сегменты сбрасываются перед закрытием,
+ * а после создания сегмента сбрасывается и каталог.
+ * 
+ * С UringWriter записи ставятся в очередь io_uring по вычисленным смещениям
+ * и выполняются асинхронно, сброс на диск выполняется операцией io_uring
+ * после завершения всех записей.
+ * 
+ * При сжатии сегмент называется bulk<время>-<номер>.seg.gz. Записи (заголовок
+ * вместе с командами) накапливаются в кадр до kFrameSize байтов, и каждый
+ * кадр сжимается в отдельный член gzip, который распаковывается независимо
+ * от соседних. Кадр сжимает поток, заполнивший его, без мьютекса, так что
+ * потоки записи сжимают кадры параллельно, а записываются кадры по порядку
+ * номеров очереди. Блок размером от kFrameSize сжимается отдельным членом.
+ * flush(), sync() и деструктор записывают незаполненный кадр. Весь сегмент
+ * распаковывается gzip -d или bulk_cat в обычный формат сегмента.
+ * 
+ * С индексом TimeIndex каждая запись (при сжатии - каждый член gzip)
+ * передается индексу вместе с сегментом и смещением после записи.
+ */
+class SegmentStore : public BlockStore {
+public:
+    /**
+     * @brief Конструктор SegmentStore.
+     * 
+     * @param dir Каталог сегментных файлов.
+     * @param segment_size Размер сегмента в байтах.
+     * @param segment_age Наибольший возраст сегмента в секундах, 0 - без ограничения.
+     * @param durable Сбрасывать сегменты на диск перед закрытием и по sync().
+     * @param uring Асинхронная запись, nullptr - блокирующая запись.
+     * @param compress_level Уровень сжатия zlib, 0 - без сжатия.
+     * @param index Индекс блоков по времени, nullptr - без индекса.
+     */
+    SegmentStore(std::string dir, size_t segment_size, size_t segment_age, bool durable = false,
+                 std::unique_ptr<UringWriter> uring = nullptr, int compress_level = 0,
+                 std::unique_ptr<TimeIndex> index = nullptr);
+
+    // Запрещаем копирование и присваивание
+    SegmentStore(const SegmentStore&) = delete;
+    SegmentStore& operator=(const SegmentStore&) = delete;
+
+    /**
+     * @brief Деструктор закрывает текущий сегмент.
+     */
+    ~SegmentStore() override;
+
+    /**
+     * @brief Дописать блок команд в текущий сегмент.
+     * 
+     * @param block Блок команд.
+     * @throws std::system_error Если не удается создать сегмент или записать в него.
+     */
+    void save(const CommandBlock& block) override;
+
+    /**
+     * @brief Закрыть текущий сегмент, обрезав его до записанной длины.
+     * 
+     * @throws std::system_error Если сегмент не удается обрезать.
+     */
+    void flush() override;
+
+    void submit() override;
+
+    /**
+     * @brief Сбросить на диск текущий сегмент и, если создавались сегменты, каталог.
+     * 
+     * @throws std::system_error Если данные не удается сбросить на диск.
+     */
+    void sync() override;
+
+    /**
+     * @brief Сформировать строку заголовка записи блока.
+     * 
+     * @param block Блок команд.
+     * @return std::string Заголовок с завершающим '\n'.
+     */
+    static std::string formatHeader(const CommandBlock& block);
+
+private:
+    /**
+     * @brief Кадр сжатия - записи, сжимаемые одним членом gzip.
+     */
+    struct Frame {
+        std::string data; /**< Записи кадра. */
+        long long ts = 0; /**< Время начала первого блока кадра. */
+        size_t seq = 0; /**< Номер первого блока кадра. */
+        long long minTs = 0; /**< Наименьшее время начала блока кадра. */
+        long long maxTs = 0; /**< Наибольшее время начала блока кадра. */
+        uint32_t blocks = 0; /**< Количество блоков кадра. */
+        uint64_t ticket = 0; /**< Номер кадра в очереди записи. */
+    };
+
+    static constexpr size_t kFrameSize = 64 << 10; /**< Объем записей, после которого кадр сжимается. */
+
+    /**
+     * @brief Создать новый сегмент.
+     * 
+     * @param ts Время начала первого блока сегмента.
+     * @param seq Номер первого блока сегмента.
+     */
+    void openSegment(long long ts, size_t seq);
+
+    /**
+     * @brief Закрыть текущий сегмент, если запись в него не помещается или он устарел, и открыть новый.
+     * 
+     * Вызывается под мьютексом.
+     * 
+     * @param record_size Размер записи.
+     * @param ts Время начала блока записи.
+     * @param seq Номер блока записи.
+     */
+    void prepareSegment(size_t record_size, long long ts, size_t seq);
+
+    /**
+     * @brief Добавить блок в кадр сжатия и сжать заполненный кадр.
+     * 
+     * @param header Заголовок записи.
+     * @param block Блок команд.
+     */
+    void saveCompressed(const std::string& header, const CommandBlock& block);
+
+    /**
+     * @brief Забрать накопленный кадр, присвоив ему номер в очереди записи.
+     * 
+     * Вызывается под мьютексом.
+     * 
+     * @param frame Кадр.
+     * @return bool Возвращает false, если кадр пуст.
+     */
+    bool takeFrame(Frame& frame);
+
+    /**
+     * @brief Функция сжатия кадра сжатием потока записи.
+     */
+    using CompressFunc = std::function<std::string_view(GzipCompressor&)>;
+
+    /**
+     * @brief Сжать кадр, дождаться его очереди и записать его в сегмент.
+     * 
+     * Номер очереди освобождается и при ошибке сжатия или записи.
+     * 
+     * @param compress Функция сжатия кадра; пустая функция только освобождает номер очереди.
+     * @param frame Кадр: первый блок, время блоков и номер в очереди записи; данные не используются.
+     */
+    void writeFrame(const CompressFunc& compress, const Frame& frame);
+
+    /**
+     * @brief Передать индексу записанную часть текущего сегмента.
+     * 
+     * Вызывается под мьютексом.
+     * 
+     * @param offset Смещение части.
+     * @param length Длина части.
+     * @param min_ts Наименьшее время начала блока части.
+     * @param max_ts Наибольшее время начала блока части.
+     * @param blocks Количество блоков части.
+     */
+    void indexPart(size_t offset, size_t length, long long min_ts, long long max_ts, uint32_t blocks);
+
+    /**
+     * @brief Сжать и записать незаполненный кадр и дождаться записи всех кадров.
+     */
+    void flushFrame();
+
+    /**
+     * @brief Закрыть текущий сегмент.
+     */
+    void closeSegment();
+
+    /**
+     * @brief Записать заголовок и блок без непрерывного текста порциями с текущего смещения.
+     * 
+     * @param header Заголовок записи.
+     * @param block Выгруженный блок или блок в режиме словаря.
+     */
+    void writeChunked(const std::string& header, const CommandBlock& block);
+
+    std::mutex mutex_; /**< Мьютекс записи в сегмент. */
+    std::string dir_; /**< Каталог сегментных файлов. */
+    size_t segment_size_; /**< Размер сегмента в байтах. */
+    std::chrono::seconds segment_age_; /**< Наибольший возраст сегмента. */
+    int fd_; /**< Дескриптор текущего сегмента. */
+    size_t offset_; /**< Длина записанных данных текущего сегмента. */
+    std::chrono::steady_clock::time_point opened_; /**< Время создания текущего сегмента. */
+    bool durable_; /**< Сбрасывать сегменты на диск. */
+    std::unique_ptr<UringWriter> uring_; /**< Асинхронная запись. */
+    std::unique_ptr<TimeIndex> index_; /**< Индекс блоков по времени. */
+    long long segment_ts_ = 0; /**< Время из имени текущего сегмента. */
+    size_t segment_seq_ = 0; /**< Номер из имени текущего сегмента. */
+    uint32_t segment_suffix_ = 0; /**< Номер, добавленный к имени текущего сегмента. */
+    int compress_level_; /**< Уровень сжатия, 0 - без сжатия. */
+    Frame frame_; /**< Незаполненный кадр сжатия. */
+    uint64_t next_ticket_ = 0; /**< Номер следующего кадра в очереди записи. */
+    uint64_t written_ticket_ = 0; /**< Номер кадра, ожидающего записи. */
+    std::condition_variable turn_; /**< Сигнал записи очередного кадра. */
+    bool dir_unsynced_; /**< После последнего sync() создавались сегменты. */
+    bool segment_unsynced_; /**< В текущий сегмент писали после последнего sync(). */
+};
@@ -0,0 +1,122 @@
+#include <algorithm>
+#include <cerrno>
+#include <string>
+#include <system_error>
+#include <vector>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "spillFile.h"
+
+namespace {
+
+constexpr size_t kReadChunk = 64 * 1024; /**< Размер порции чтения. */
+
+void throwSystemError(const std::string& what) {
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+}
+
+std::atomic<size_t> MemoryLease::total_{0};
+
+SpillFile::SpillFile(const std::string& dir) : fd_(-1), size_(0) {
+    fd_ = ::open(dir.c_str(), O_TMPFILE | O_RDWR | O_CLOEXEC, 0600);
+
+    if (fd_ < 0) {
+        // Файловая система без O_TMPFILE: создаем файл и сразу удаляем его имя
+        std::string path = dir + "/bulk-spill-XXXXXX";
+        std::vector<char> name(path.begin(), path.end());
+        name.push_back('\0');
+        fd_ = ::mkostemp(name.data(), O_CLOEXEC);
+
+        if (fd_ < 0) {
+            throwSystemError("Unable to create spill file in " + dir);
+        }
+
+        ::unlink(name.data());
+    }
+}
+
+SpillFile::~SpillFile() {
+    ::close(fd_);
+}
+
+void SpillFile::append(std::string_view bytes) {
+    while (!bytes.empty()) {
+        ssize_t written = ::pwrite(fd_, bytes.data(), bytes.size(), static_cast<off_t>(size_));
+
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            throwSystemError("spill write");
+        }
+
+        size_ += static_cast<size_t>(written);
+        bytes.remove_prefix(static_cast<size_t>(written));
+    }
+}
+
+void SpillFile::read(const std::function<void(std::string_view)>& consumer) const {
+    std::vector<char> buffer(kReadChunk);
+    size_t offset = 0;
+
+    while (offset < size_) {
+        ssize_t count = ::pread(fd_, buffer.data(), std::min(buffer.size(), size_ - offset), static_cast<off_t>(offset));
+
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            throwSystemError("spill read");
+        }
+
+        if (count == 0) {
+            throw std::system_error(EIO, std::generic_category(), "spill file truncated");
+        }
+
+        consumer(std::string_view(buffer.data(), static_cast<size_t>(count)));
+        offset += static_cast<size_t>(count);
+    }
+}
+
+size_t SpillFile::size() const {
+    return size_;
+}
+
+MemoryLease::MemoryLease(MemoryLease&& other) noexcept : bytes_(other.bytes_) {
+    other.bytes_ = 0;
+}
+
+MemoryLease& MemoryLease::operator=(MemoryLease&& other) noexcept {
+    if (this != &other) {
+        release();
+        bytes_ = other.bytes_;
+        other.bytes_ = 0;
+    }
+
+    return *this;
+}
+
+MemoryLease::~MemoryLease() {
+    release();
+}
+
+void MemoryLease::add(size_t bytes) {
+    bytes_ += bytes;
+    total_.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void MemoryLease::release() {
+    if (bytes_ > 0) {
+        total_.fetch_sub(bytes_, std::memory_order_relaxed);
+        bytes_ = 0;
+    }
+}
+
+size_t MemoryLease::total() {
+    return total_.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,108 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief Класс SpillFile - временный файл для команд большого блока.
+ *
+ * Файл создается безымянным (O_TMPFILE) или удаляется сразу после создания,
+ * поэтому исчезает при закрытии дескриптора, в том числе после аварийного
+ * завершения процесса. Данные только дописываются в конец и читаются
+ * последовательно порциями.
+ */
+class SpillFile {
+public:
+    /**
+     * @brief Конструктор SpillFile.
+     *
+     * @param dir Каталог временного файла.
+     * @throws std::system_error Если файл не удается создать.
+     */
+    explicit SpillFile(const std::string& dir);
+
+    // Запрещаем копирование и присваивание
+    SpillFile(const SpillFile&) = delete;
+    SpillFile& operator=(const SpillFile&) = delete;
+
+    /**
+     * @brief Деструктор закрывает и тем самым удаляет файл.
+     */
+    ~SpillFile();
+
+    /**
+     * @brief Дописать данные в конец файла.
+     *
+     * @param bytes Данные.
+     * @throws std::system_error Если данные не удается записать.
+     */
+    void append(std::string_view bytes);
+
+    /**
+     * @brief Прочитать файл от начала порциями.
+     *
+     * @param consumer Получатель порций, каждая действительна только во время вызова.
+     * @throws std::system_error Если файл не удается прочитать.
+     */
+    void read(const std::function<void(std::string_view)>& consumer) const;
+
+    /**
+     * @brief Получить размер данных.
+     *
+     * @return size_t Размер в байтах.
+     */
+    size_t size() const;
+
+private:
+    int fd_; /**< Дескриптор файла. */
+    size_t size_; /**< Размер записанных данных. */
+};
+
+/**
+ * @brief Класс MemoryLease учитывает память динамических блоков в общем бюджете.
+ *
+ * Сумма всех учтенных байтов процесса доступна через total() и сравнивается
+ * с общим бюджетом выгрузки. При перемещении учет переходит к новому
+ * владельцу, при уничтожении учтенные байты освобождаются.
+ */
+class MemoryLease {
+public:
+    MemoryLease() = default;
+
+    MemoryLease(MemoryLease&& other) noexcept;
+    MemoryLease& operator=(MemoryLease&& other) noexcept;
+
+    // Запрещаем копирование: учет не дублируется
+    MemoryLease(const MemoryLease&) = delete;
+    MemoryLease& operator=(const MemoryLease&) = delete;
+
+    /**
+     * @brief Деструктор освобождает учтенные байты.
+     */
+    ~MemoryLease();
+
+    /**
+     * @brief Учесть дополнительные байты.
+     *
+     * @param bytes Количество байтов.
+     */
+    void add(size_t bytes);
+
+    /**
+     * @brief Освободить все учтенные байты.
+     */
+    void release();
+
+    /**
+     * @brief Получить сумму учтенных байтов всех экземпляров.
+     *
+     * @return size_t Байтов в памяти динамических блоков.
+     */
+    static size_t total();
+
+private:
+    size_t bytes_ = 0; /**< Учтенные байты экземпляра. */
+    static std::atomic<size_t> total_; /**< Учтенные байты всех экземпляров. */
+};
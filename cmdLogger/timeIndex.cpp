@@ -0,0 +1,187 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "timeIndex.h"
+
+static_assert(sizeof(TimeIndex::Entry) == 64, "Entry layout is part of the index format");
+static_assert(sizeof(TimeIndex::Header) == 16, "Header layout is part of the index format");
+
+namespace {
+
+void throwSystemError(const std::string& what) {
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+void writeAll(int fd, const void* data, size_t size, const std::string& path) {
+    const char* bytes = static_cast<const char*>(data);
+
+    while (size > 0) {
+        ssize_t written = ::write(fd, bytes, size);
+
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            throwSystemError("write " + path);
+        }
+
+        bytes += written;
+        size -= static_cast<size_t>(written);
+    }
+}
+
+}
+
+TimeIndex::TimeIndex(const std::string& dir)
+    : path_(dir + "/" + kFileName), fd_(-1), has_pending_(false), horizon_(0), has_horizon_(false) {
+    fd_ = ::open(path_.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+
+    if (fd_ < 0) {
+        throwSystemError("Unable to open index " + path_);
+    }
+
+    try {
+        struct stat st {};
+
+        if (::fstat(fd_, &st) != 0) {
+            throwSystemError("fstat " + path_);
+        }
+
+        size_t size = static_cast<size_t>(st.st_size);
+
+        if (size == 0) {
+            Header header{};
+            std::memcpy(header.magic, kMagic, sizeof(kMagic));
+            header.version = kVersion;
+            header.entrySize = sizeof(Entry);
+            writeAll(fd_, &header, sizeof(header), path_);
+        } else {
+            Header header{};
+
+            if (size < sizeof(header) || ::pread(fd_, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header))
+                || std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion
+                || header.entrySize != sizeof(Entry)) {
+                throw std::runtime_error("Unsupported index format: " + path_);
+            }
+
+            // Запись, оборванная сбоем, отбрасывается, чтобы новые записи не сместились
+            size_t tail = (size - sizeof(header)) % sizeof(Entry);
+
+            if (tail != 0 && ::ftruncate(fd_, static_cast<off_t>(size - tail)) != 0) {
+                throwSystemError("ftruncate " + path_);
+            }
+
+            // Граница продолжается от последней записи
+            size -= tail;
+
+            if (size > sizeof(header)) {
+                Entry last;
+
+                if (::pread(fd_, &last, sizeof(last), static_cast<off_t>(size - sizeof(last)))
+                    != static_cast<ssize_t>(sizeof(last))) {
+                    throwSystemError("pread " + path_);
+                }
+
+                horizon_ = horizon(last);
+                has_horizon_ = true;
+            }
+        }
+    } catch (...) {
+        ::close(fd_);
+        throw;
+    }
+}
+
+TimeIndex::~TimeIndex() {
+    try {
+        flush();
+    } catch (const std::exception&) {
+        // Ошибка уже не может быть передана вызывающему
+    }
+
+    ::close(fd_);
+}
+
+void TimeIndex::add(const Entry& part) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (has_pending_) {
+        bool same_file = pending_.flags == part.flags && pending_.fileTs == part.fileTs
+            && pending_.fileSeq == part.fileSeq && pending_.fileSuffix == part.fileSuffix
+            && (pending_.flags & kSegment) != 0;
+        bool adjacent = pending_.offset + pending_.length == part.offset;
+        bool small = pending_.length + part.length <= kSpanBytes;
+        bool recent = std::max(pending_.maxTs, part.maxTs) - std::min(pending_.minTs, part.minTs) < kSpanSeconds;
+
+        if (same_file && adjacent && small && recent) {
+            pending_.minTs = std::min(pending_.minTs, part.minTs);
+            pending_.maxTs = std::max(pending_.maxTs, part.maxTs);
+            pending_.length += part.length;
+            pending_.blocks += part.blocks;
+            return;
+        }
+
+        writePending();
+    }
+
+    pending_ = part;
+    has_pending_ = true;
+}
+
+void TimeIndex::flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (has_pending_) {
+        writePending();
+    }
+}
+
+void TimeIndex::sync() {
+    flush();
+
+    if (::fdatasync(fd_) != 0) {
+        throwSystemError("fdatasync " + path_);
+    }
+}
+
+std::string TimeIndex::dataFileName(const Entry& entry) {
+    std::string name = "bulk" + std::to_string(entry.fileTs);
+
+    if ((entry.flags & kSegment) != 0) {
+        name += "-" + std::to_string(entry.fileSeq);
+
+        if (entry.fileSuffix != 0) {
+            name += "-" + std::to_string(entry.fileSuffix);
+        }
+
+        name += ".seg";
+    } else {
+        name += ".log";
+    }
+
+    if ((entry.flags & kCompressed) != 0) {
+        name += ".gz";
+    }
+
+    return name;
+}
+
+void TimeIndex::writePending() {
+    // Участок снимается до записи, чтобы ошибка не повторялась при каждом вызове
+    has_pending_ = false;
+
+    if (!has_horizon_ || pending_.maxTs > horizon_) {
+        horizon_ = pending_.maxTs;
+        has_horizon_ = true;
+    }
+
+    // Отставание больше 136 лет не встречается, ограничение только защищает от переполнения
+    pending_.lag = static_cast<uint32_t>(std::min<int64_t>(horizon_ - pending_.maxTs, UINT32_MAX));
+    writeAll(fd_, &pending_, sizeof(pending_), path_);
+}
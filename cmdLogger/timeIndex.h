@@ -0,0 +1,140 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+/**
+ * @brief Класс TimeIndex - разреженный индекс сохраненных блоков по времени.
+ *
+ * Индекс - файл bulk.idx в каталоге хранилища: заголовок и записи Entry
+ * постоянного размера в порядке сохранения. Запись описывает непрерывный
+ * участок файла данных: файл блока bulk<время>.log или сегмент
+ * bulk<время>-<номер>.seg, смещение и длину участка, наименьшее и
+ * наибольшее время начала блоков участка. Соседние блоки одного файла
+ * объединяются в участок, пока он меньше kSpanBytes и охватывает меньше
+ * kSpanSeconds секунд, поэтому записей индекса намного меньше, чем блоков.
+ *
+ * Записи идут в порядке сохранения, а не времени: долгий динамический блок
+ * сохраняется позже более новых. Поэтому каждая запись хранит отставание lag
+ * от наибольшего maxTs всех записей до нее включительно; сумма maxTs + lag
+ * не убывает по файлу, и начало интервала запроса находится двоичным поиском.
+ * Индекс каталога ведет один процесс.
+ *
+ * Незавершенный участок записывается в индекс при начале следующего
+ * участка, flush(), sync() и уничтожении. Каждая запись добавляется одним
+ * вызовом write() в режиме O_APPEND. Числа хранятся в порядке байтов машины,
+ * индекс читается отображением в память (bulk_query).
+ */
+class TimeIndex {
+public:
+    static constexpr uint32_t kSegment = 1; /**< Участок сегмента, иначе файл отдельного блока. */
+    static constexpr uint32_t kCompressed = 2; /**< Файл сжат gzip, участок состоит из целых членов gzip. */
+
+    static constexpr const char* kFileName = "bulk.idx"; /**< Имя файла индекса в каталоге хранилища. */
+    static constexpr size_t kSpanBytes = 1 << 20; /**< Наибольшая длина участка. */
+    static constexpr long long kSpanSeconds = 1; /**< Наибольший разброс времени начала блоков участка. */
+
+    /**
+     * @brief Запись индекса - участок файла данных.
+     */
+    struct Entry {
+        int64_t minTs = 0; /**< Наименьшее время начала блока участка в секундах. */
+        int64_t maxTs = 0; /**< Наибольшее время начала блока участка в секундах. */
+        int64_t fileTs = 0; /**< Время из имени файла данных. */
+        uint64_t fileSeq = 0; /**< Номер из имени сегмента, для файла блока - номер блока. */
+        uint64_t offset = 0; /**< Смещение участка в файле. */
+        uint64_t length = 0; /**< Длина участка в файле. */
+        uint32_t flags = 0; /**< Вид файла: kSegment, kCompressed. */
+        uint32_t blocks = 0; /**< Количество блоков участка. */
+        uint32_t fileSuffix = 0; /**< Номер, добавленный к имени сегмента при совпадении имен, 0 - без номера. */
+        uint32_t lag = 0; /**< Отставание maxTs от наибольшего maxTs предыдущих записей в секундах, заполняет индекс. */
+    };
+
+    /**
+     * @brief Заголовок файла индекса.
+     */
+    struct Header {
+        char magic[8]; /**< Сигнатура kMagic. */
+        uint32_t version; /**< Версия формата kVersion. */
+        uint32_t entrySize; /**< Размер записи Entry. */
+    };
+
+    static constexpr char kMagic[8] = {'B', 'U', 'L', 'K', 'I', 'D', 'X', '\0'}; /**< Сигнатура файла индекса. */
+    static constexpr uint32_t kVersion = 2; /**< Версия формата индекса. */
+
+    /**
+     * @brief Конструктор TimeIndex открывает индекс каталога для дописывания.
+     *
+     * @param dir Каталог хранилища.
+     * @throws std::system_error Если файл индекса не удается открыть или записать.
+     * @throws std::runtime_error Если файл индекса имеет другой формат.
+     */
+    explicit TimeIndex(const std::string& dir);
+
+    // Запрещаем копирование и присваивание
+    TimeIndex(const TimeIndex&) = delete;
+    TimeIndex& operator=(const TimeIndex&) = delete;
+
+    /**
+     * @brief Деструктор записывает незавершенный участок и закрывает индекс.
+     */
+    ~TimeIndex();
+
+    /**
+     * @brief Добавить сохраненную часть файла данных.
+     *
+     * Часть продолжает незавершенный участок, если лежит в том же файле
+     * сразу за ним, иначе участок записывается в индекс и начинается новый.
+     *
+     * @param part Часть файла: файл, смещение, длина, время и количество блоков.
+     * @throws std::system_error Если запись индекса завершилась ошибкой.
+     */
+    void add(const Entry& part);
+
+    /**
+     * @brief Записать незавершенный участок в индекс.
+     *
+     * @throws std::system_error Если запись индекса завершилась ошибкой.
+     */
+    void flush();
+
+    /**
+     * @brief Записать незавершенный участок и сбросить индекс на диск.
+     *
+     * @throws std::system_error Если индекс не удается записать или сбросить.
+     */
+    void sync();
+
+    /**
+     * @brief Получить имя файла данных участка.
+     *
+     * @param entry Запись индекса.
+     * @return std::string Имя файла относительно каталога хранилища.
+     */
+    static std::string dataFileName(const Entry& entry);
+
+    /**
+     * @brief Получить наибольший maxTs записей индекса до записи включительно.
+     *
+     * @param entry Запись индекса.
+     * @return int64_t Граница, не убывающая по файлу индекса.
+     */
+    static int64_t horizon(const Entry& entry) {
+        return entry.maxTs + static_cast<int64_t>(entry.lag);
+    }
+
+private:
+    /**
+     * @brief Записать незавершенный участок, вызывается под мьютексом.
+     */
+    void writePending();
+
+    std::string path_; /**< Путь к файлу индекса. */
+    int fd_; /**< Дескриптор файла индекса. */
+    std::mutex mutex_; /**< Мьютекс незавершенного участка. */
+    Entry pending_; /**< Незавершенный участок. */
+    bool has_pending_; /**< Есть незавершенный участок. */
+    int64_t horizon_; /**< Наибольший maxTs записанных участков. */
+    bool has_horizon_; /**< В индексе есть записи. */
+};
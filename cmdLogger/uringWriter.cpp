@@ -0,0 +1,397 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <system_error>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "uringWriter.h"
+
+namespace {
+
+constexpr uint64_t kCloseTag = uint64_t(1) << 63; /**< Признак завершения закрытия, в младших битах дескриптор. */
+constexpr uint64_t kSyncTag = uint64_t(1) << 62; /**< Признак завершения сброса на диск. */
+constexpr uint64_t kTagMask = kCloseTag | kSyncTag;
+constexpr size_t kMaxKeptBuffer = 1 << 20; /**< Наибольшая емкость буфера, сохраняемого для повторного использования. */
+constexpr unsigned kProbeOps = 256; /**< Размер таблицы операций при проверке возможностей ядра. */
+
+int uringSetup(unsigned entries, io_uring_params* params) {
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+int uringEnter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return static_cast<int>(::syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+/**
+ * @brief Проверить, что ядро поддерживает все операции записи.
+ *
+ * IORING_OP_WRITE и IORING_OP_CLOSE появились позже самого io_uring,
+ * на старом ядре io_uring_setup успешен, а записи завершались бы EINVAL.
+ *
+ * @param fd Дескриптор io_uring.
+ * @throws std::system_error Если операции не поддерживаются или проверка недоступна.
+ */
+void probeOps(int fd) {
+    std::vector<char> buffer(sizeof(io_uring_probe) + kProbeOps * sizeof(io_uring_probe_op), 0);
+    auto* probe = reinterpret_cast<io_uring_probe*>(buffer.data());
+
+    if (::syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe, kProbeOps) < 0) {
+        throw std::system_error(errno, std::generic_category(), "io_uring probe");
+    }
+
+    for (unsigned op : {IORING_OP_WRITE, IORING_OP_CLOSE, IORING_OP_FSYNC}) {
+        if (op > probe->last_op || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED)) {
+            throw std::system_error(ENOSYS, std::generic_category(), "io_uring probe");
+        }
+    }
+}
+
+void* mapRing(int fd, size_t size, off_t offset) {
+    void* ptr = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, offset);
+
+    if (ptr == MAP_FAILED) {
+        throw std::system_error(errno, std::generic_category(), "io_uring mmap");
+    }
+
+    return ptr;
+}
+
+template <typename T>
+T* ringField(void* ring, unsigned offset) {
+    return reinterpret_cast<T*>(static_cast<char*>(ring) + offset);
+}
+
+}
+
+UringWriter::UringWriter(unsigned depth, size_t max_write)
+    : max_write_(std::clamp<size_t>(max_write, 1, UINT32_MAX)), ring_fd_(-1),
+      sq_ring_(nullptr), sq_ring_size_(0), cq_ring_(nullptr), cq_ring_size_(0),
+      sqes_(nullptr), sqes_size_(0), local_tail_(0), queued_(0), in_flight_(0), error_(0) {
+    depth = std::max(depth, 1u);
+
+    // Запас элементов очереди на продолжения записей и закрытия файлов
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    ring_fd_ = uringSetup(depth * 2, &params);
+
+    if (ring_fd_ < 0) {
+        throw std::system_error(errno, std::generic_category(), "io_uring_setup");
+    }
+
+    try {
+        probeOps(ring_fd_);
+        sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+        if (params.features & IORING_FEAT_SINGLE_MMAP) {
+            sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+            sq_ring_ = mapRing(ring_fd_, sq_ring_size_, IORING_OFF_SQ_RING);
+            cq_ring_ = sq_ring_;
+        } else {
+            sq_ring_ = mapRing(ring_fd_, sq_ring_size_, IORING_OFF_SQ_RING);
+            cq_ring_ = mapRing(ring_fd_, cq_ring_size_, IORING_OFF_CQ_RING);
+        }
+
+        sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+        sqes_ = static_cast<io_uring_sqe*>(mapRing(ring_fd_, sqes_size_, IORING_OFF_SQES));
+    } catch (...) {
+        release();
+        throw;
+    }
+
+    sq_head_ = ringField<unsigned>(sq_ring_, params.sq_off.head);
+    sq_tail_ = ringField<unsigned>(sq_ring_, params.sq_off.tail);
+    sq_mask_ = *ringField<unsigned>(sq_ring_, params.sq_off.ring_mask);
+    sq_entries_ = params.sq_entries;
+    sq_array_ = ringField<unsigned>(sq_ring_, params.sq_off.array);
+    cq_head_ = ringField<unsigned>(cq_ring_, params.cq_off.head);
+    cq_tail_ = ringField<unsigned>(cq_ring_, params.cq_off.tail);
+    cq_mask_ = *ringField<unsigned>(cq_ring_, params.cq_off.ring_mask);
+    cqes_ = ringField<io_uring_cqe>(cq_ring_, params.cq_off.cqes);
+    local_tail_ = *sq_tail_;
+
+    requests_.resize(depth);
+    free_.reserve(depth);
+
+    for (uint32_t i = depth; i > 0; --i) {
+        free_.push_back(i - 1);
+    }
+}
+
+std::unique_ptr<UringWriter> UringWriter::tryCreate(unsigned depth, size_t max_write) {
+    try {
+        return std::make_unique<UringWriter>(depth, max_write);
+    } catch (const std::system_error&) {
+        return nullptr;
+    }
+}
+
+UringWriter::~UringWriter() {
+    try {
+        waitAll();
+    } catch (const std::exception&) {
+        // Ошибка уже не может быть передана вызывающему
+    }
+
+    release();
+}
+
+void UringWriter::release() {
+    if (sqes_ != nullptr) {
+        ::munmap(sqes_, sqes_size_);
+        sqes_ = nullptr;
+    }
+
+    if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) {
+        ::munmap(cq_ring_, cq_ring_size_);
+    }
+
+    cq_ring_ = nullptr;
+
+    if (sq_ring_ != nullptr) {
+        ::munmap(sq_ring_, sq_ring_size_);
+        sq_ring_ = nullptr;
+    }
+
+    if (ring_fd_ >= 0) {
+        ::close(ring_fd_);
+        ring_fd_ = -1;
+    }
+}
+
+void UringWriter::write(int fd, off_t offset, std::string_view head, std::string_view body, bool close_after) {
+    throwIfFailed();
+
+    uint32_t index = acquireRequest();
+    Request& request = requests_[index];
+    request.buffer.reserve(head.size() + body.size());
+    request.buffer.assign(head);
+    request.buffer.append(body);
+    request.expected = request.buffer.size();
+    request.fd = fd;
+    request.offset = offset;
+    request.written = 0;
+    request.close_after = close_after;
+
+    if (!hasRoom()) {
+        enter(0);
+    }
+
+    prepare(index);
+
+    if (queued_ >= sq_entries_ / 2) {
+        enter(0);
+    }
+}
+
+void UringWriter::submit() {
+    throwIfFailed();
+
+    if (queued_ > 0) {
+        enter(0);
+    }
+
+    reap();
+}
+
+void UringWriter::sync(int fd) {
+    throwIfFailed();
+
+    if (!hasRoom()) {
+        enter(0);
+    }
+
+    // IOSQE_IO_DRAIN откладывает сброс до завершения всех ранее переданных записей
+    io_uring_sqe* sqe = nextSqe();
+    sqe->opcode = IORING_OP_FSYNC;
+    sqe->fd = fd;
+    sqe->fsync_flags = IORING_FSYNC_DATASYNC;
+    sqe->flags |= IOSQE_IO_DRAIN;
+    sqe->user_data = kSyncTag | static_cast<uint32_t>(fd);
+
+    waitAll();
+}
+
+void UringWriter::waitAll() {
+    while (queued_ > 0 || in_flight_ > 0 || !pending_.empty()) {
+        enter(1);
+    }
+
+    throwIfFailed();
+}
+
+bool UringWriter::idle() {
+    reap();
+    return queued_ == 0 && in_flight_ == 0 && pending_.empty();
+}
+
+bool UringWriter::hasRoom() const {
+    return local_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) < sq_entries_;
+}
+
+void UringWriter::prepare(uint64_t user_data) {
+    io_uring_sqe* sqe = nextSqe();
+    sqe->user_data = user_data;
+
+    if (user_data & kCloseTag) {
+        sqe->opcode = IORING_OP_CLOSE;
+        sqe->fd = static_cast<int>(user_data & ~kTagMask);
+        return;
+    }
+
+    // Длина операции - 32 бита, поэтому большие записи выполняются частями
+    const Request& request = requests_[static_cast<uint32_t>(user_data)];
+    size_t length = std::min(request.expected - request.written, max_write_);
+    sqe->opcode = IORING_OP_WRITE;
+    sqe->fd = request.fd;
+    sqe->addr = reinterpret_cast<uint64_t>(request.buffer.data() + request.written);
+    sqe->len = static_cast<uint32_t>(length);
+    sqe->off = static_cast<uint64_t>(request.offset) + request.written;
+}
+
+void UringWriter::preparePending() {
+    size_t count = 0;
+
+    while (count < pending_.size() && hasRoom()) {
+        prepare(pending_[count++]);
+    }
+
+    pending_.erase(pending_.begin(), pending_.begin() + static_cast<std::ptrdiff_t>(count));
+}
+
+io_uring_sqe* UringWriter::nextSqe() {
+    unsigned index = local_tail_ & sq_mask_;
+    io_uring_sqe* sqe = &sqes_[index];
+    std::memset(sqe, 0, sizeof(*sqe));
+    sq_array_[index] = index;
+    ++local_tail_;
+    ++queued_;
+    return sqe;
+}
+
+uint32_t UringWriter::acquireRequest() {
+    reap();
+
+    while (free_.empty()) {
+        enter(1);
+    }
+
+    uint32_t index = free_.back();
+    free_.pop_back();
+    return index;
+}
+
+void UringWriter::enter(unsigned wait) {
+    __atomic_store_n(sq_tail_, local_tail_, __ATOMIC_RELEASE);
+
+    while (true) {
+        unsigned flags = wait > 0 ? IORING_ENTER_GETEVENTS : 0;
+        int submitted = uringEnter(ring_fd_, queued_, wait, flags);
+
+        if (submitted >= 0) {
+            queued_ -= static_cast<unsigned>(submitted);
+            in_flight_ += static_cast<unsigned>(submitted);
+            break;
+        }
+
+        if (errno == EINTR) {
+            continue;
+        }
+
+        if ((errno == EAGAIN || errno == EBUSY) && in_flight_ > 0) {
+            // Ядру не хватает места для завершений: забираем их и повторяем
+            reap();
+            wait = 1;
+            continue;
+        }
+
+        throw std::system_error(errno, std::generic_category(), "io_uring_enter");
+    }
+
+    reap();
+}
+
+void UringWriter::reap() {
+    unsigned head = *cq_head_;
+    unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+
+    while (head != tail) {
+        complete(cqes_[head & cq_mask_]);
+        ++head;
+    }
+
+    __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+
+    // Продолжения записей и закрытия ставятся в очередь после разбора завершений
+    preparePending();
+}
+
+void UringWriter::complete(const io_uring_cqe& cqe) {
+    --in_flight_;
+
+    auto recordError = [this](int error, const char* what) {
+        if (error_ == 0) {
+            error_ = error;
+            error_what_ = what;
+        }
+    };
+
+    if (cqe.user_data & kCloseTag) {
+        if (cqe.res < 0) {
+            recordError(-cqe.res, "io_uring close");
+        }
+
+        return;
+    }
+
+    if (cqe.user_data & kSyncTag) {
+        if (cqe.res < 0) {
+            recordError(-cqe.res, "io_uring fdatasync");
+        }
+
+        return;
+    }
+
+    auto index = static_cast<uint32_t>(cqe.user_data);
+    Request& request = requests_[index];
+
+    if (cqe.res > 0) {
+        request.written += static_cast<size_t>(cqe.res);
+
+        // Короткая запись или очередная часть большой: дописываем остаток
+        if (request.written < request.expected) {
+            pending_.push_back(index);
+            return;
+        }
+    } else if (cqe.res < 0) {
+        recordError(-cqe.res, "io_uring write");
+    } else if (request.written < request.expected) {
+        recordError(EIO, "io_uring short write");
+    }
+
+    if (request.close_after) {
+        // Файл закрывается после всей записи; после ошибки - сразу, без очереди
+        if (request.written == request.expected) {
+            pending_.push_back(kCloseTag | static_cast<uint32_t>(request.fd));
+        } else {
+            ::close(request.fd);
+        }
+    }
+
+    if (request.buffer.capacity() > kMaxKeptBuffer) {
+        std::string().swap(request.buffer);
+    }
+
+    free_.push_back(index);
+}
+
+void UringWriter::throwIfFailed() {
+    if (error_ != 0) {
+        int error = error_;
+        error_ = 0;
+        throw std::system_error(error, std::generic_category(), error_what_);
+    }
+}
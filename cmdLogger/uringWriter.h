@@ -0,0 +1,208 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <sys/types.h>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+/**
+ * @brief Класс UringWriter - асинхронная запись в файлы через io_uring.
+ *
+ * Обертка над системными вызовами io_uring_setup и io_uring_enter без
+ * liburing. Запись копируется во внутренний буфер и ставится в очередь
+ * отправки; накопленные операции передаются ядру одним вызовом submit()
+ * или автоматически при заполнении очереди. Завершения забираются без
+ * системного вызова при каждой операции, ожидание выполняется, только если
+ * заняты все буферы. Количество одновременно выполняемых записей
+ * ограничено глубиной очереди, отдельные потоки для них не нужны.
+ *
+ * Запись больше max_write выполняется частями, после короткой записи
+ * остаток ставится в очередь заново; файл с закрытием после записи
+ * закрывается, когда записаны все части.
+ *
+ * Ошибка записи запоминается и выбрасывается следующим вызовом.
+ * Экземпляр не потокобезопасен.
+ */
+class UringWriter {
+public:
+    static constexpr size_t kMaxWrite = size_t(1) << 30; /**< Наибольший размер одной операции записи по умолчанию. */
+
+    /**
+     * @brief Конструктор UringWriter.
+     *
+     * @param depth Наибольшее количество одновременно выполняемых записей.
+     * @param max_write Наибольший размер одной операции записи, не больше 4 ГиБ.
+     * @throws std::system_error Если io_uring недоступен или ядро не поддерживает нужные операции.
+     */
+    explicit UringWriter(unsigned depth, size_t max_write = kMaxWrite);
+
+    /**
+     * @brief Создать UringWriter, если io_uring доступен.
+     *
+     * Кроме io_uring проверяется поддержка ядром операций записи,
+     * закрытия и сброса файла (IORING_REGISTER_PROBE).
+     *
+     * @param depth Наибольшее количество одновременно выполняемых записей.
+     * @param max_write Наибольший размер одной операции записи.
+     * @return std::unique_ptr<UringWriter> Объект или nullptr, если io_uring недоступен.
+     */
+    static std::unique_ptr<UringWriter> tryCreate(unsigned depth, size_t max_write = kMaxWrite);
+
+    // Запрещаем копирование и присваивание
+    UringWriter(const UringWriter&) = delete;
+    UringWriter& operator=(const UringWriter&) = delete;
+
+    /**
+     * @brief Деструктор дожидается завершения всех записей.
+     */
+    ~UringWriter();
+
+    /**
+     * @brief Поставить в очередь запись двух фрагментов подряд.
+     *
+     * @param fd Файловый дескриптор.
+     * @param offset Смещение в файле.
+     * @param head Первый фрагмент.
+     * @param body Второй фрагмент.
+     * @param close_after Закрыть дескриптор после записи.
+     * @throws std::system_error Если предыдущая запись завершилась ошибкой.
+     */
+    void write(int fd, off_t offset, std::string_view head, std::string_view body, bool close_after = false);
+
+    /**
+     * @brief Передать ядру накопленные операции без ожидания их завершения.
+     *
+     * @throws std::system_error Если предыдущая запись завершилась ошибкой.
+     */
+    void submit();
+
+    /**
+     * @brief Сбросить файл на диск после всех поставленных записей и дождаться завершения.
+     *
+     * @param fd Файловый дескриптор.
+     * @throws std::system_error Если запись или сброс завершились ошибкой.
+     */
+    void sync(int fd);
+
+    /**
+     * @brief Дождаться завершения всех поставленных операций.
+     *
+     * @throws std::system_error Если запись завершилась ошибкой.
+     */
+    void waitAll();
+
+    /**
+     * @brief Проверить, завершены ли все поставленные операции.
+     *
+     * Доступные завершения обрабатываются без системного вызова.
+     *
+     * @return bool Возвращает true, если незавершенных операций нет.
+     */
+    bool idle();
+
+private:
+    /**
+     * @brief Буфер выполняемой записи.
+     */
+    struct Request {
+        std::string buffer; /**< Копия записываемых данных. */
+        size_t expected = 0; /**< Ожидаемое количество записанных байтов. */
+        size_t written = 0; /**< Уже записано байтов. */
+        int fd = -1; /**< Файловый дескриптор. */
+        off_t offset = 0; /**< Смещение начала записи в файле. */
+        bool close_after = false; /**< Закрыть дескриптор после записи. */
+    };
+
+    /**
+     * @brief Получить свободный элемент очереди отправки.
+     *
+     * @return io_uring_sqe* Обнуленный элемент.
+     */
+    io_uring_sqe* nextSqe();
+
+    /**
+     * @brief Проверить, есть ли свободный элемент очереди отправки.
+     *
+     * @return bool Возвращает true, если элемент можно занять.
+     */
+    bool hasRoom() const;
+
+    /**
+     * @brief Поставить в очередь отправки операцию.
+     *
+     * @param user_data Индекс буфера для записи очередной части или kCloseTag с дескриптором для закрытия.
+     */
+    void prepare(uint64_t user_data);
+
+    /**
+     * @brief Поставить в очередь отложенные продолжения записей и закрытия, сколько поместится.
+     */
+    void preparePending();
+
+    /**
+     * @brief Получить свободный буфер записи, при необходимости дождавшись завершений.
+     *
+     * @return uint32_t Индекс буфера.
+     */
+    uint32_t acquireRequest();
+
+    /**
+     * @brief Передать ядру накопленные операции.
+     *
+     * @param wait Количество завершений, которых нужно дождаться.
+     */
+    void enter(unsigned wait);
+
+    /**
+     * @brief Обработать доступные завершения.
+     */
+    void reap();
+
+    /**
+     * @brief Обработать одно завершение.
+     *
+     * @param cqe Завершение.
+     */
+    void complete(const io_uring_cqe& cqe);
+
+    /**
+     * @brief Выбросить запомненную ошибку.
+     */
+    void throwIfFailed();
+
+    /**
+     * @brief Освободить отображения и дескриптор io_uring.
+     */
+    void release();
+
+    size_t max_write_; /**< Наибольший размер одной операции записи. */
+    int ring_fd_; /**< Дескриптор io_uring. */
+    void* sq_ring_; /**< Отображение кольца отправки. */
+    size_t sq_ring_size_; /**< Размер отображения кольца отправки. */
+    void* cq_ring_; /**< Отображение кольца завершений. */
+    size_t cq_ring_size_; /**< Размер отображения кольца завершений. */
+    io_uring_sqe* sqes_; /**< Элементы очереди отправки. */
+    size_t sqes_size_; /**< Размер отображения элементов очереди отправки. */
+    unsigned* sq_head_; /**< Голова кольца отправки, изменяется ядром. */
+    unsigned* sq_tail_; /**< Хвост кольца отправки. */
+    unsigned sq_mask_; /**< Маска кольца отправки. */
+    unsigned sq_entries_; /**< Емкость кольца отправки. */
+    unsigned* sq_array_; /**< Индексы элементов кольца отправки. */
+    unsigned* cq_head_; /**< Голова кольца завершений. */
+    unsigned* cq_tail_; /**< Хвост кольца завершений, изменяется ядром. */
+    unsigned cq_mask_; /**< Маска кольца завершений. */
+    io_uring_cqe* cqes_; /**< Элементы кольца завершений. */
+    unsigned local_tail_; /**< Хвост с еще не опубликованными элементами. */
+    unsigned queued_; /**< Элементов, не переданных ядру. */
+    unsigned in_flight_; /**< Переданных ядру элементов без завершения. */
+    std::vector<Request> requests_; /**< Буферы записей. */
+    std::vector<uint32_t> free_; /**< Индексы свободных буферов. */
+    std::vector<uint64_t> pending_; /**< Операции, ожидающие места в очереди отправки. */
+    int error_; /**< Первая ошибка записи. */
+    std::string error_what_; /**< Операция, завершившаяся ошибкой. */
+};
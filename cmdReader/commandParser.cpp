@@ -0,0 +1,73 @@
+#include <string>
+#include <string_view>
+#include "commandParser.h"
+#include "lineScanner.h"
+
+
+template <typename Handler>
+BasicCommandParser<Handler>::BasicCommandParser(Handler& handler) : handler_(handler), depth_(0) {}
+
+template <typename Handler>
+void BasicCommandParser<Handler>::feed(const char* data, size_t size) {
+    size_t tail = LineScanner::forEachLine(data, size, [this](std::string_view line) {
+        // Только первая строка порции может продолжать разорванную строку
+        if (!pending_.empty()) {
+            pending_.append(line);
+            onLine(pending_);
+            pending_.clear();
+        } else {
+            onLine(line);
+        }
+    });
+
+    pending_.append(data + tail, size - tail);
+}
+
+template <typename Handler>
+void BasicCommandParser<Handler>::finish() {
+    if (!pending_.empty()) {
+        onLine(pending_);
+        pending_.clear();
+    }
+
+    depth_ = 0;
+    handler_.onEnd();
+}
+
+template <typename Handler>
+size_t BasicCommandParser<Handler>::depth() const {
+    return depth_;
+}
+
+template <typename Handler>
+void BasicCommandParser<Handler>::onLine(std::string_view line) {
+    switch (LineScanner::classify(line.data(), line.size())) {
+    case LineKind::Open:
+        if (depth_++ == 0) {
+            handler_.onBlockOpen();
+        }
+
+        break;
+
+    case LineKind::Close:
+        if (depth_ > 0 && --depth_ == 0) {
+            handler_.onBlockClose();
+        }
+
+        break;
+
+    case LineKind::Break:
+        if (depth_ == 0) {
+            handler_.onBreak();
+        }
+
+        break;
+
+    case LineKind::Command:
+        handler_.onCommand(line, depth_ > 0);
+        break;
+    }
+}
+
+template class BasicCommandParser<BlockEventHandler>;
+template class BasicCommandParser<SilentCommandManager>;
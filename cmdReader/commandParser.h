@@ -0,0 +1,89 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include "../cmdLogger/blockEventHandler.h"
+#include "../cmdLogger/commandManager.h"
+
+/**
+ * @brief Класс CommandParser - потоковый разборщик команд.
+ * 
+ * Данные передаются произвольными порциями байтов методом feed(), конец
+ * ввода отмечается методом finish(). Строки выделяются в переданной порции
+ * векторным поиском (LineScanner) без копирования; копируется только
+ * строка, разорванная границей порций.
+ * 
+ * Разбор - конечный автомат с состояниями "вне блока" (depth_ == 0) и
+ * "в динамическом блоке" (depth_ > 0). Вложенность хранится счетчиком,
+ * поэтому глубина вложенности не ограничена и не расходует стек:
+ *   "{"      - вне блока начинает динамический блок, внутри увеличивает глубину;
+ *   "}"      - уменьшает глубину и на нулевой глубине закрывает блок,
+ *              вне блока игнорируется;
+ *   ""       - вне блока завершает текущий статический блок, внутри игнорируется;
+ *   команда  - передается получателю с флагом динамического блока.
+ * 
+ * Тип получателя - параметр шаблона. CommandParser вызывает любой
+ * BlockEventHandler через виртуальные функции; если подставлен конечный
+ * (final) тип менеджера, вызовы на каждую команду выполняются напрямую.
+ * Определения находятся в commandParser.cpp и явно инстанцируются для
+ * BlockEventHandler и SilentCommandManager.
+ * 
+ * @tparam Handler Получатель событий разбора.
+ */
+template <typename Handler = BlockEventHandler>
+class BasicCommandParser {
+public:
+    /**
+     * @brief Конструктор BasicCommandParser.
+     * 
+     * @param handler Получатель событий разбора.
+     */
+    explicit BasicCommandParser(Handler& handler);
+
+    // Запрещаем копирование и присваивание
+    BasicCommandParser(const BasicCommandParser&) = delete;
+    BasicCommandParser& operator=(const BasicCommandParser&) = delete;
+
+    /**
+     * @brief Передать очередную порцию данных.
+     * 
+     * @param data Данные.
+     * @param size Размер данных.
+     */
+    void feed(const char* data, size_t size);
+
+    /**
+     * @brief Завершить ввод.
+     * 
+     * Разбирает последнюю строку без перевода строки и сообщает о конце ввода.
+     * После вызова разборщик готов к новому вводу.
+     */
+    void finish();
+
+    /**
+     * @brief Получить текущую глубину вложенности.
+     * 
+     * @return size_t Глубина вложенности, 0 - вне динамического блока.
+     */
+    size_t depth() const;
+
+private:
+    /**
+     * @brief Обработать одну строку.
+     * 
+     * @param line Строка без перевода строки.
+     */
+    void onLine(std::string_view line);
+
+    Handler& handler_; /**< Получатель событий разбора. */
+    std::string pending_; /**< Начало строки, разорванной границей порций. */
+    size_t depth_; /**< Глубина вложенности динамического блока. */
+};
+
+/**
+ * @brief Разборщик с получателем событий через виртуальные функции.
+ */
+using CommandParser = BasicCommandParser<BlockEventHandler>;
+
+extern template class BasicCommandParser<BlockEventHandler>;
+extern template class BasicCommandParser<SilentCommandManager>;
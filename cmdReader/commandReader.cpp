@@ -1,61 +1,73 @@
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
 #include <iostream>
 #include <string>
+#include <system_error>
+#include <poll.h>
+#include <unistd.h>
 #include "../cmdLogger/commandManager.h"
+#include "../cmdLogger/metrics.h"
 #include "commandReader.h"
 
+namespace {
+
+constexpr size_t kReadBufferSize = 1 << 20;
 
-CommandReader::CommandReader(size_t block_size) : block_size_(block_size), currentBlockIndex_(0), commandManager_(), level_(0) {
-    if (block_size_ == 0) {
-        throw std::invalid_argument("Размер блока команд должен быть больше 0");
-    }
 }
 
+CommandReader::CommandReader(size_t block_size, const LoggerOptions& options, int fd)
+    : fd_(fd), buffer_(kReadBufferSize), commandManager_(block_size, options), parser_(commandManager_) {}
+
 void CommandReader::execute() {
-    while (true) {
-        for (size_t i = 0; i < block_size_; ++i) {
-            if (!readCommand(false, i % block_size_ == 0)) {
-                break;
-            }
-        }
-        
-        commandManager_.logCommandQueue();
+    Metrics& metrics = Metrics::instance();
+
+    while (size_t size = readChunk()) {
+        auto start = std::chrono::steady_clock::now();
+        parser_.feed(buffer_.data(), size);
+        metrics.parseLatency.record(std::chrono::steady_clock::now() - start);
+        metrics.inputBytes.add(size);
+
+        // Срок проверяется один раз на порцию, а не на каждую команду
+        commandManager_.flushExpired(std::chrono::system_clock::now());
     }
+
+    parser_.finish();
+    commandManager_.finish();
 }
 
-bool CommandReader::readCommand(bool isDynamic, bool startIteration) {
-    std::string line;
+bool CommandReader::waitInput() {
+    auto deadline = commandManager_.getStaticDeadline();
 
-    if (!std::getline(std::cin, line) || line.empty()) {
-        commandManager_.logPreviosStaticBlock(currentBlockIndex_);
+    if (!deadline.has_value()) {
         return false;
     }
 
-    if (line == "{" || line == "}" || startIteration) {
-        currentBlockIndex_ = commandManager_.getNewBlockIndex();
-    }
+    auto left = std::chrono::ceil<std::chrono::milliseconds>(*deadline - std::chrono::system_clock::now());
+    pollfd pfd{fd_, POLLIN, 0};
+    int result = ::poll(&pfd, 1, static_cast<int>(std::max<long long>(left.count(), 0)));
 
-    if (line == "}") {
-        --level_;
+    if (result < 0 && errno != EINTR) {
+        throw std::system_error(errno, std::generic_category(), "poll");
+    }
 
-        if (level_ == 0) {
-            commandManager_.logCommandQueue();
-        }
+    return result == 0;
+}
 
-        return false;
+size_t CommandReader::readChunk() {
+    while (waitInput()) {
+        commandManager_.flushExpired(std::chrono::system_clock::now());
     }
 
-    if (line == "{") {
-        ++level_;
-
-        commandManager_.logPreviosStaticBlock(currentBlockIndex_);
+    while (true) {
+        ssize_t count = ::read(fd_, buffer_.data(), buffer_.size());
 
-        while (readCommand(true, startIteration)) {
-            startIteration = false;
+        if (count >= 0) {
+            return static_cast<size_t>(count);
         }
-    } else {
-        commandManager_.addCommandToBlock(currentBlockIndex_, line, isDynamic);
-    } 
-
 
-    return true;
+        if (errno != EINTR) {
+            throw std::system_error(errno, std::generic_category(), "read");
+        }
+    }
 }
@@ -1,11 +1,19 @@
 #pragma once
 #include <iostream>
 #include <string>
+#include <vector>
+#include <unistd.h>
 #include "../cmdLogger/commandManager.h"
+#include "commandParser.h"
 
 
 /**
  * @brief Класс CommandReader отвечает за чтение и выполнение команд в блоках.
+ * 
+ * Читает файловый дескриптор большими порциями вызовом read(2)
+ * и передает их разборщику команд, который формирует блоки в CommandManager.
+ * Если задано наибольшее время ожидания блока, перед чтением выполняется
+ * poll(2) с таймаутом до срока текущего статического блока.
  */
 class CommandReader {
 public:
@@ -13,9 +21,11 @@ public:
      * @brief Конструктор класса CommandReader.
      * 
      * @param block_size Размер блока команд.
+     * @param options Настройки вывода блоков.
+     * @param fd Файловый дескриптор ввода.
      * @throws std::invalid_argument Если размер блока команд равен 0.
      */
-    CommandReader(size_t block_size);
+    CommandReader(size_t block_size, const LoggerOptions& options = LoggerOptions(), int fd = STDIN_FILENO);
 
     // Запрещаем копирование и присваивание
     CommandReader(const CommandReader&) = delete;
@@ -23,25 +33,34 @@ public:
 
     /**
      * @brief Выполнить чтение команд и их выполнение.
+     * 
+     * Читает команды до конца ввода, после чего дожидается вывода всех блоков.
+     * 
+     * @throws std::system_error Если чтение завершилось ошибкой.
      */
     void execute();
 
 private:
     /**
-     * @brief Прочитать одну команду и добавить ее в блок.
+     * @brief Дождаться данных ввода до срока незаполненного статического блока.
      * 
-     * Читает одну строку из ввода, анализирует ее и добавляет команду в текущий блок.
-     * Если команда представляет собой начало нового блока или завершение блока, это также обрабатывается.
+     * Если срок не задан, ожидание не выполняется.
      * 
-     * @param isDynamic Флаг, указывающий, является ли команда динамической.
-     * @param startIteration Флаг, указывающий начало нового цикла.
-     * @return bool Возвращает true, если команда была успешно прочитана и обработана, иначе false.
+     * @return bool Возвращает true, если срок истек раньше, чем появились данные.
      */
-    bool readCommand(bool isDynamic, bool startIteration);
+    bool waitInput();
 
+    /**
+     * @brief Прочитать очередную порцию данных в буфер.
+     * 
+     * Пока данных нет, незаполненный статический блок выводится по истечении срока.
+     * 
+     * @return size_t Количество прочитанных байтов, 0 - конец ввода.
+     */
+    size_t readChunk();
 
-    size_t block_size_; /**< Размер блока команд. */
-    size_t currentBlockIndex_; /**< Индекс текущего блока команд. */
+    int fd_; /**< Файловый дескриптор ввода. */
+    std::vector<char> buffer_; /**< Буфер чтения. */
     CommandManager commandManager_; /**< Менеджер команд для обработки и логирования команд. */
-    size_t level_;
+    CommandParser parser_; /**< Разборщик команд. */
 };
@@ -0,0 +1,271 @@
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+#include "../cmdLogger/command.h"
+#include "../cmdLogger/metrics.h"
+#include "fileReplay.h"
+
+FileReplay::FileReplay(size_t block_size, const LoggerOptions& options, const std::string& path, size_t threads,
+                       size_t window_size)
+    : block_size_(block_size), threads_(threads), window_size_(std::max<size_t>(window_size, 1)), intern_(options.intern),
+      file_(path), commandManager_(block_size, options), parser_(commandManager_) {
+    if (threads_ == 0) {
+        threads_ = std::max(1u, std::thread::hardware_concurrency());
+    }
+}
+
+void FileReplay::execute() {
+    Metrics& metrics = Metrics::instance();
+    std::string_view bytes = file_.bytes();
+    size_t begin = 0;
+
+    while (begin < bytes.size()) {
+        size_t end = windowEnd(begin);
+        std::string_view window = bytes.substr(begin, end - begin);
+
+        auto start = std::chrono::steady_clock::now();
+        scanWindow(window);
+        planWindow();
+        buildBlocks(window);
+        metrics.parseLatency.record(std::chrono::steady_clock::now() - start);
+        metrics.inputBytes.add(window.size());
+
+        replayWindow(window);
+        file_.release(begin, window.size());
+        begin = end;
+    }
+
+    parser_.finish();
+    commandManager_.finish();
+}
+
+size_t FileReplay::windowEnd(size_t begin) const {
+    std::string_view bytes = file_.bytes();
+
+    if (bytes.size() - begin <= window_size_) {
+        return bytes.size();
+    }
+
+    size_t end = bytes.find('\n', begin + window_size_ - 1);
+    end = end == std::string_view::npos ? bytes.size() : end + 1;
+
+    if (end - begin > std::numeric_limits<uint32_t>::max()) {
+        throw std::runtime_error("Строка ввода длиннее 4 ГБ");
+    }
+
+    return end;
+}
+
+void FileReplay::scanWindow(std::string_view window) {
+    // Части окна выровнены по началу строки
+    size_t parts = std::min(threads_, std::max<size_t>(1, window.size() / (64 << 10)));
+    std::vector<size_t> bounds(parts + 1, window.size());
+    bounds[0] = 0;
+
+    for (size_t i = 1; i < parts; ++i) {
+        size_t pos = std::max(bounds[i - 1], i * window.size() / parts);
+        size_t newline = pos == 0 ? 0 : window.find('\n', pos - 1);
+        bounds[i] = newline == std::string_view::npos ? window.size() : newline + 1;
+    }
+
+    // Первый проход считает строки частей, второй заполняет их места в lines_
+    std::vector<size_t> counts(parts + 1, 0);
+
+    runParallel(parts, [&](size_t part) {
+        const char* data = window.data() + bounds[part];
+        size_t size = bounds[part + 1] - bounds[part];
+        size_t count = 0;
+        size_t tail = LineScanner::forEachLine(data, size, [&count](std::string_view) { ++count; });
+        counts[part + 1] = count + (tail < size ? 1 : 0);
+    });
+
+    for (size_t i = 1; i <= parts; ++i) {
+        counts[i] += counts[i - 1];
+    }
+
+    lines_.resize(counts[parts]);
+
+    runParallel(parts, [&](size_t part) {
+        const char* base = window.data();
+        const char* data = base + bounds[part];
+        size_t size = bounds[part + 1] - bounds[part];
+        Line* out = lines_.data() + counts[part];
+
+        auto addLine = [&out, base](std::string_view line) {
+            auto length = static_cast<uint32_t>(line.size());
+            *out++ = Line{static_cast<uint32_t>(line.data() - base), length, LineScanner::classify(line.data(), length)};
+        };
+
+        size_t tail = LineScanner::forEachLine(data, size, addLine);
+
+        // Последняя строка файла без перевода строки
+        if (tail < size) {
+            addLine(std::string_view(data + tail, size - tail));
+        }
+    });
+}
+
+void FileReplay::planWindow() {
+    regions_.clear();
+    built_.clear();
+    built_regions_.clear();
+
+    PlanState& state = state_;
+    size_t parsed_from = 0;
+
+    auto addBuilt = [&](size_t first, size_t last, bool dynamic) {
+        if (parsed_from < first) {
+            regions_.push_back(Region{parsed_from, first, kParsed});
+        }
+
+        built_regions_.push_back(regions_.size());
+        regions_.push_back(Region{first, last, built_.size()});
+        built_.emplace_back(dynamic, intern_);
+        parsed_from = last;
+    };
+
+    // Блок, начатый в CommandParser, дочитывается им же; после "{" в него
+    // же попадает и следующий динамический блок
+    auto finishStatic = [&](size_t end, bool by_open) {
+        if (!state.chained) {
+            addBuilt(state.static_start, end, false);
+        } else if (!by_open) {
+            state.chained = false;
+        }
+
+        state.static_count = 0;
+    };
+
+    for (size_t i = 0; i < lines_.size(); ++i) {
+        switch (lines_[i].kind) {
+        case LineKind::Open:
+            if (state.depth == 0) {
+                if (state.static_count > 0) {
+                    finishStatic(i, true);
+                }
+
+                state.dynamic_start = i;
+                state.dynamic_count = 0;
+            }
+
+            ++state.depth;
+            break;
+
+        case LineKind::Close:
+            if (state.depth > 0 && --state.depth == 0) {
+                if (state.chained) {
+                    state.chained = false;
+                } else if (state.dynamic_count > 0) {
+                    addBuilt(state.dynamic_start, i + 1, true);
+                }
+            }
+
+            break;
+
+        case LineKind::Break:
+            if (state.depth == 0 && state.static_count > 0) {
+                finishStatic(i, false);
+            }
+
+            break;
+
+        case LineKind::Command:
+            if (state.depth > 0) {
+                ++state.dynamic_count;
+            } else {
+                if (state.static_count == 0) {
+                    state.static_start = i;
+                }
+
+                if (++state.static_count == block_size_) {
+                    finishStatic(i + 1, false);
+                }
+            }
+
+            break;
+        }
+    }
+
+    if (parsed_from < lines_.size()) {
+        regions_.push_back(Region{parsed_from, lines_.size(), kParsed});
+    }
+
+    // Незавершенный блок окна уже передан CommandParser
+    state.chained = state.depth > 0 || state.static_count > 0;
+}
+
+void FileReplay::buildBlocks(std::string_view window) {
+    size_t tasks = std::min(threads_, built_regions_.size());
+
+    runParallel(tasks, [&](size_t task) {
+        uint64_t commands = 0;
+
+        for (size_t i = task; i < built_regions_.size(); i += tasks) {
+            const Region& region = regions_[built_regions_[i]];
+            CommandBlock& block = built_[region.built];
+
+            for (size_t line = region.first; line < region.last; ++line) {
+                if (lines_[line].kind == LineKind::Command) {
+                    block.AddCommand(Command(window.substr(lines_[line].offset, lines_[line].length)));
+                    ++commands;
+                }
+            }
+        }
+
+        Metrics::instance().commands.add(commands);
+    });
+}
+
+void FileReplay::replayWindow(std::string_view window) {
+    for (const auto& region : regions_) {
+        if (region.built != kParsed) {
+            commandManager_.logBuiltBlock(std::move(built_[region.built]));
+            continue;
+        }
+
+        size_t begin = lines_[region.first].offset;
+        size_t end = region.last < lines_.size() ? lines_[region.last].offset : window.size();
+        parser_.feed(window.data() + begin, end - begin);
+    }
+
+    built_.clear();
+}
+
+void FileReplay::runParallel(size_t count, const std::function<void(size_t)>& task) {
+    if (count == 0) {
+        return;
+    }
+
+    std::vector<std::exception_ptr> errors(count);
+    std::vector<std::thread> workers;
+    workers.reserve(count - 1);
+
+    for (size_t i = 1; i < count; ++i) {
+        workers.emplace_back([&task, &errors, i]() {
+            try {
+                task(i);
+            } catch (...) {
+                errors[i] = std::current_exception();
+            }
+        });
+    }
+
+    try {
+        task(0);
+    } catch (...) {
+        errors[0] = std::current_exception();
+    }
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    for (const auto& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
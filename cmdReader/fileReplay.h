@@ -0,0 +1,154 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "../cmdLogger/commandBlock.h"
+#include "../cmdLogger/commandManager.h"
+#include "commandParser.h"
+#include "lineScanner.h"
+#include "mappedFile.h"
+
+/**
+ * @brief Класс FileReplay - параллельное воспроизведение файла команд.
+ *
+ * Файл отображается в память и обрабатывается окнами, выровненными
+ * по концу строки. Для каждого окна:
+ *   1. Несколько потоков находят строки своих частей окна и определяют их
+ *      вид ("{", "}", пустая строка или команда).
+ *   2. Один проход по найденным строкам повторяет автомат CommandParser
+ *      и CommandManager (группировка по N команд, глубина вложенности)
+ *      и находит границы блоков.
+ *   3. Блоки, целиком лежащие в окне, собираются в CommandBlock
+ *      параллельно несколькими потоками.
+ *   4. Собранные блоки передаются на вывод по порядку, а строки между ними
+ *      и блоки, пересекающие границу окна, разбираются обычным
+ *      CommandParser. Поэтому вывод совпадает с выводом последовательного
+ *      чтения того же файла.
+ *
+ * Обработанные окна возвращаются системе, так что память процесса
+ * не зависит от размера файла. Ограничение LoggerOptions::maxLatency
+ * при воспроизведении файла не применяется: ввод не ожидается.
+ */
+class FileReplay {
+public:
+    static constexpr size_t kWindowSize = 16 << 20; /**< Размер окна воспроизведения по умолчанию. */
+
+    /**
+     * @brief Конструктор FileReplay.
+     *
+     * @param block_size Размер блока команд.
+     * @param options Настройки вывода блоков.
+     * @param path Путь к файлу команд.
+     * @param threads Количество потоков разбора, 0 - по числу ядер.
+     * @param window_size Размер окна воспроизведения; окно продлевается до конца строки.
+     * @throws std::invalid_argument Если размер блока команд равен 0.
+     * @throws std::system_error Если файл не удается открыть.
+     */
+    FileReplay(size_t block_size, const LoggerOptions& options, const std::string& path, size_t threads = 0,
+               size_t window_size = kWindowSize);
+
+    // Запрещаем копирование и присваивание
+    FileReplay(const FileReplay&) = delete;
+    FileReplay& operator=(const FileReplay&) = delete;
+
+    /**
+     * @brief Воспроизвести файл и дождаться вывода всех блоков.
+     *
+     * @throws std::runtime_error Если строка не помещается в окно или вывод завершился ошибкой.
+     */
+    void execute();
+
+private:
+    /**
+     * @brief Строка окна.
+     */
+    struct Line {
+        uint32_t offset; /**< Смещение от начала окна. */
+        uint32_t length; /**< Длина без перевода строки. */
+        LineKind kind; /**< Вид строки. */
+    };
+
+    /**
+     * @brief Участок строк окна [first, last).
+     */
+    struct Region {
+        size_t first; /**< Первая строка. */
+        size_t last; /**< Строка за последней. */
+        size_t built; /**< Индекс собираемого блока или kParsed. */
+    };
+
+    /**
+     * @brief Состояние разметки, переходящее между окнами.
+     */
+    struct PlanState {
+        size_t depth = 0; /**< Глубина вложенности динамического блока. */
+        size_t static_count = 0; /**< Команд в текущем статическом блоке. */
+        size_t static_start = 0; /**< Первая строка текущего статического блока. */
+        size_t dynamic_start = 0; /**< Строка "{" текущего динамического блока. */
+        size_t dynamic_count = 0; /**< Команд в текущем динамическом блоке. */
+        bool chained = false; /**< Текущий блок разбирается CommandParser. */
+    };
+
+    static constexpr size_t kParsed = static_cast<size_t>(-1); /**< Участок разбирается CommandParser. */
+
+    /**
+     * @brief Найти конец окна, начинающегося с указанного смещения.
+     *
+     * @param begin Начало окна.
+     * @return size_t Смещение за концом строки, завершающей окно.
+     */
+    size_t windowEnd(size_t begin) const;
+
+    /**
+     * @brief Найти и классифицировать строки окна параллельно.
+     *
+     * @param window Байты окна.
+     */
+    void scanWindow(std::string_view window);
+
+    /**
+     * @brief Найти границы блоков окна и разделить его на участки.
+     */
+    void planWindow();
+
+    /**
+     * @brief Собрать блоки, целиком лежащие в окне, параллельно.
+     *
+     * @param window Байты окна.
+     */
+    void buildBlocks(std::string_view window);
+
+    /**
+     * @brief Передать участки окна на вывод по порядку.
+     *
+     * @param window Байты окна.
+     */
+    void replayWindow(std::string_view window);
+
+    /**
+     * @brief Выполнить задачи в нескольких потоках.
+     *
+     * Задача с индексом 0 выполняется в вызывающем потоке.
+     *
+     * @param count Количество задач.
+     * @param task Задача, получающая свой индекс.
+     * @throws Первое исключение, выброшенное задачами.
+     */
+    static void runParallel(size_t count, const std::function<void(size_t)>& task);
+
+    size_t block_size_; /**< Размер статического блока команд. */
+    size_t threads_; /**< Количество потоков разбора. */
+    size_t window_size_; /**< Размер окна воспроизведения. */
+    bool intern_; /**< Собирать блоки в режиме словаря. */
+    MappedFile file_; /**< Отображенный файл. */
+    CommandManager commandManager_; /**< Менеджер команд для вывода блоков. */
+    CommandParser parser_; /**< Разборщик участков между собранными блоками. */
+    std::vector<Line> lines_; /**< Строки текущего окна. */
+    std::vector<Region> regions_; /**< Участки текущего окна. */
+    std::vector<CommandBlock> built_; /**< Блоки текущего окна, собираемые параллельно. */
+    std::vector<size_t> built_regions_; /**< Участки собираемых блоков. */
+    PlanState state_; /**< Состояние разметки. */
+};
@@ -0,0 +1,139 @@
+#include <cstring>
+#include <string>
+#include "lineScanner.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define BULK_SCANNER_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+size_t findNewlinesScalar(const char* data, size_t size, uint32_t* out) {
+    size_t count = 0;
+    const char* begin = data;
+    const char* end = data + size;
+
+    while (const char* newline = static_cast<const char*>(std::memchr(begin, '\n', end - begin))) {
+        out[count++] = static_cast<uint32_t>(newline - data);
+        begin = newline + 1;
+    }
+
+    return count;
+}
+
+/**
+ * @brief Дописать смещения переводов строк хвоста, не кратного ширине вектора.
+ */
+size_t findNewlinesTail(const char* data, size_t begin, size_t size, uint32_t* out, size_t count) {
+    for (size_t i = begin; i < size; ++i) {
+        if (data[i] == '\n') {
+            out[count++] = static_cast<uint32_t>(i);
+        }
+    }
+
+    return count;
+}
+
+/**
+ * @brief Записать смещения установленных битов маски.
+ */
+inline size_t appendMask(uint64_t mask, size_t base, uint32_t* out, size_t count) {
+    while (mask != 0) {
+        out[count++] = static_cast<uint32_t>(base + static_cast<size_t>(__builtin_ctzll(mask)));
+        mask &= mask - 1;
+    }
+
+    return count;
+}
+
+#ifdef BULK_SCANNER_X86
+
+__attribute__((target("sse2")))
+size_t findNewlinesSse2(const char* data, size_t size, uint32_t* out) {
+    const __m128i newline = _mm_set1_epi8('\n');
+    size_t count = 0;
+    size_t i = 0;
+
+    for (; i + 16 <= size; i += 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        auto mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, newline)));
+        count = appendMask(mask, i, out, count);
+    }
+
+    return findNewlinesTail(data, i, size, out, count);
+}
+
+__attribute__((target("avx2")))
+size_t findNewlinesAvx2(const char* data, size_t size, uint32_t* out) {
+    const __m256i newline = _mm256_set1_epi8('\n');
+    size_t count = 0;
+    size_t i = 0;
+
+    for (; i + 64 <= size; i += 64) {
+        __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 32));
+        uint64_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(low, newline)))
+            | static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(high, newline)))) << 32;
+        count = appendMask(mask, i, out, count);
+    }
+
+    return findNewlinesTail(data, i, size, out, count);
+}
+
+#endif
+
+/**
+ * @brief Описание ядра.
+ */
+struct KernelInfo {
+    const char* name; /**< Название. */
+    LineScanner::Kernel kernel; /**< Функция поиска. */
+    bool (*supported)(); /**< Проверка поддержки процессором. */
+};
+
+const KernelInfo kKernels[] = {
+#ifdef BULK_SCANNER_X86
+    {"avx2", findNewlinesAvx2, [] { return __builtin_cpu_supports("avx2") != 0; }},
+    {"sse2", findNewlinesSse2, [] { return __builtin_cpu_supports("sse2") != 0; }},
+#endif
+    {"scalar", findNewlinesScalar, [] { return true; }},
+};
+
+}
+
+LineScanner::Kernel& LineScanner::activeKernel() {
+    // Ядра перечислены от самого быстрого, выбирается первое поддерживаемое
+    static Kernel kernel = [] {
+        for (const auto& info : kKernels) {
+            if (info.supported()) {
+                return info.kernel;
+            }
+        }
+
+        return findNewlinesScalar;
+    }();
+
+    return kernel;
+}
+
+const char* LineScanner::kernelName() {
+    for (const auto& info : kKernels) {
+        if (info.kernel == activeKernel()) {
+            return info.name;
+        }
+    }
+
+    return "scalar";
+}
+
+bool LineScanner::setKernel(const std::string& name) {
+    for (const auto& info : kKernels) {
+        if (name == info.name && info.supported()) {
+            activeKernel() = info.kernel;
+            return true;
+        }
+    }
+
+    return false;
+}
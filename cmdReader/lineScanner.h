@@ -0,0 +1,132 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief Вид строки ввода.
+ */
+enum class LineKind : uint8_t {
+    Command, /**< Команда. */
+    Open,    /**< "{". */
+    Close,   /**< "}". */
+    Break    /**< Пустая строка. */
+};
+
+/**
+ * @brief Класс LineScanner - векторный поиск строк во входном буфере.
+ *
+ * Переводы строк ищутся ядром, выбранным при первом обращении по
+ * возможностям процессора: AVX2 (64 байта за итерацию), SSE2 (16 байтов)
+ * или переносимый поиск memchr. Ядро сравнивает блок байтов с '\n' одной
+ * векторной инструкцией и записывает смещения найденных символов по маске.
+ * Вид строки определяется по ее длине и единственному байту, поэтому
+ * сравнение со строками "{" и "}" не требуется.
+ */
+class LineScanner {
+public:
+    /**
+     * @brief Ядро поиска переводов строк.
+     *
+     * Записывает в out смещения всех '\n' в data[0, size) по возрастанию.
+     * Емкость out должна быть не меньше size.
+     *
+     * @return size_t Количество найденных переводов строк.
+     */
+    using Kernel = size_t (*)(const char* data, size_t size, uint32_t* out);
+
+    /**
+     * @brief Найти переводы строк активным ядром.
+     *
+     * @param data Данные.
+     * @param size Размер данных, не больше kSliceSize.
+     * @param out Смещения найденных переводов строк.
+     * @return size_t Количество найденных переводов строк.
+     */
+    static size_t findNewlines(const char* data, size_t size, uint32_t* out) {
+        return activeKernel()(data, size, out);
+    }
+
+    /**
+     * @brief Определить вид строки.
+     *
+     * @param data Начало строки.
+     * @param length Длина строки без перевода строки.
+     * @return LineKind Вид строки.
+     */
+    static LineKind classify(const char* data, size_t length) {
+        if (length == 0) {
+            return LineKind::Break;
+        }
+
+        if (length == 1) {
+            if (*data == '{') {
+                return LineKind::Open;
+            }
+
+            if (*data == '}') {
+                return LineKind::Close;
+            }
+        }
+
+        return LineKind::Command;
+    }
+
+    /**
+     * @brief Передать получателю все строки буфера, завершенные переводом строки.
+     *
+     * Буфер обрабатывается частями по kSliceSize байтов, смещения переводов
+     * строк части хранятся на стеке.
+     *
+     * @param data Данные.
+     * @param size Размер данных.
+     * @param consumer Получатель строк без перевода строки, вызывается как consumer(std::string_view).
+     * @return size_t Смещение начала незавершенной последней строки (size, если ее нет).
+     */
+    template <typename Consumer>
+    static size_t forEachLine(const char* data, size_t size, Consumer&& consumer) {
+        uint32_t newlines[kSliceSize];
+        size_t line_start = 0;
+
+        for (size_t slice = 0; slice < size; slice += kSliceSize) {
+            size_t count = findNewlines(data + slice, std::min(kSliceSize, size - slice), newlines);
+
+            for (size_t i = 0; i < count; ++i) {
+                size_t end = slice + newlines[i];
+                consumer(std::string_view(data + line_start, end - line_start));
+                line_start = end + 1;
+            }
+        }
+
+        return line_start;
+    }
+
+    /**
+     * @brief Получить название активного ядра.
+     *
+     * @return const char* "avx2", "sse2" или "scalar".
+     */
+    static const char* kernelName();
+
+    /**
+     * @brief Выбрать ядро по названию.
+     *
+     * Используется замерами для сравнения ядер, вызывается до начала разбора.
+     *
+     * @param name Название ядра: "avx2", "sse2" или "scalar".
+     * @return bool Возвращает false, если ядро не поддерживается процессором.
+     */
+    static bool setKernel(const std::string& name);
+
+    static constexpr size_t kSliceSize = 4096; /**< Размер части буфера, обрабатываемой за один вызов ядра. */
+
+private:
+    /**
+     * @brief Получить активное ядро, выбранное по возможностям процессора.
+     *
+     * @return Kernel& Ядро.
+     */
+    static Kernel& activeKernel();
+};
@@ -0,0 +1,68 @@
+#include <cerrno>
+#include <string>
+#include <system_error>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "mappedFile.h"
+
+
+MappedFile::MappedFile(const std::string& path) : data_(nullptr), size_(0) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+    if (fd < 0) {
+        throw std::system_error(errno, std::generic_category(), "Unable to open " + path);
+    }
+
+    struct stat st;
+
+    if (::fstat(fd, &st) != 0) {
+        int error = errno;
+        ::close(fd);
+        throw std::system_error(error, std::generic_category(), "Unable to stat " + path);
+    }
+
+    size_ = static_cast<size_t>(st.st_size);
+
+    // Пустой файл отобразить нельзя, его содержимое - пустая строка
+    if (size_ > 0) {
+        void* ptr = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (ptr == MAP_FAILED) {
+            int error = errno;
+            ::close(fd);
+            throw std::system_error(error, std::generic_category(), "Unable to map " + path);
+        }
+
+        data_ = static_cast<char*>(ptr);
+        ::madvise(data_, size_, MADV_SEQUENTIAL);
+    }
+
+    ::close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (data_ != nullptr) {
+        ::munmap(data_, size_);
+    }
+}
+
+std::string_view MappedFile::bytes() const {
+    return std::string_view(data_, size_);
+}
+
+void MappedFile::release(size_t offset, size_t size) const {
+    if (data_ == nullptr) {
+        return;
+    }
+
+    // madvise принимает только адреса, выровненные по странице
+    const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    size_t begin = (offset + page - 1) / page * page;
+    size_t end = (offset + size) / page * page;
+
+    if (begin < end) {
+        ::madvise(data_ + begin, end - begin, MADV_DONTNEED);
+    }
+}
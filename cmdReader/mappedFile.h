@@ -0,0 +1,52 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief Класс MappedFile - файл, отображенный в память только для чтения.
+ *
+ * Отображение освобождается при уничтожении объекта. Обработанные части
+ * можно вернуть системе методом release(), чтобы при чтении больших файлов
+ * потребление памяти процесса не росло вместе с прочитанным объемом.
+ */
+class MappedFile {
+public:
+    /**
+     * @brief Конструктор MappedFile.
+     *
+     * @param path Путь к файлу.
+     * @throws std::system_error Если файл не удается открыть или отобразить.
+     */
+    explicit MappedFile(const std::string& path);
+
+    // Запрещаем копирование и присваивание
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * @brief Деструктор освобождает отображение.
+     */
+    ~MappedFile();
+
+    /**
+     * @brief Получить содержимое файла.
+     *
+     * @return std::string_view Байты файла, для пустого файла - пустая строка.
+     */
+    std::string_view bytes() const;
+
+    /**
+     * @brief Вернуть системе страницы обработанной части файла.
+     *
+     * Последующее обращение к этим байтам снова прочитает их из файла.
+     *
+     * @param offset Начало части.
+     * @param size Длина части.
+     */
+    void release(size_t offset, size_t size) const;
+
+private:
+    char* data_; /**< Начало отображения. */
+    size_t size_; /**< Размер файла. */
+};
@@ -0,0 +1,345 @@
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include "programOptions.h"
+
+namespace {
+
+size_t parseCount(const std::string& name, const std::string& value) {
+    size_t pos = 0;
+    unsigned long long result = 0;
+
+    try {
+        result = std::stoull(value, &pos);
+    } catch (const std::exception&) {
+        pos = 0;
+    }
+
+    if (value.empty() || pos != value.size() || value[0] == '-') {
+        throw std::invalid_argument("Некорректное значение параметра " + name + ": " + value);
+    }
+
+    return static_cast<size_t>(result);
+}
+
+size_t parseSize(const std::string& name, const std::string& value) {
+    size_t multiplier = 1;
+    std::string digits = value;
+
+    if (!digits.empty()) {
+        switch (digits.back()) {
+        case 'K': case 'k': multiplier = size_t(1) << 10; break;
+        case 'M': case 'm': multiplier = size_t(1) << 20; break;
+        case 'G': case 'g': multiplier = size_t(1) << 30; break;
+        default: break;
+        }
+
+        if (multiplier > 1) {
+            digits.pop_back();
+        }
+    }
+
+    size_t result = parseCount(name, digits) * multiplier;
+
+    if (result == 0) {
+        throw std::invalid_argument("Некорректное значение параметра " + name + ": " + value);
+    }
+
+    return result;
+}
+
+SinkOptions parseSink(const std::string& spec) {
+    SinkOptions sink;
+    size_t comma = spec.find(',');
+    std::string kind = spec.substr(0, comma);
+
+    if (kind == "stdout") {
+        sink.type = SinkType::Console;
+    } else if (kind == "store") {
+        sink.type = SinkType::Store;
+    } else if (kind == "null") {
+        sink.type = SinkType::Null;
+    } else if (kind.rfind("unix:", 0) == 0 && kind.size() > 5) {
+        sink.type = SinkType::Forward;
+        sink.address = kind.substr(5);
+    } else {
+        throw std::invalid_argument("Неизвестный приемник: " + kind);
+    }
+
+    sink.name = kind;
+
+    // Ожидание в очереди задерживает поток чтения, а с ним и остальные приемники,
+    // поэтому ждать по умолчанию может только хранилище
+    sink.overflow = sink.type == SinkType::Store ? OverflowPolicy::Block : OverflowPolicy::DropOldest;
+
+    while (comma != std::string::npos) {
+        size_t next = spec.find(',', comma + 1);
+        std::string setting = spec.substr(comma + 1, next == std::string::npos ? std::string::npos : next - comma - 1);
+        size_t eq = setting.find('=');
+        std::string key = setting.substr(0, eq);
+        std::string value = eq == std::string::npos ? std::string() : setting.substr(eq + 1);
+        comma = next;
+
+        if (key == "queue") {
+            sink.queueCapacity = parseCount("--sink " + key, value);
+
+            if (sink.queueCapacity == 0) {
+                throw std::invalid_argument("Некорректное значение параметра --sink queue: " + value);
+            }
+        } else if (key == "overflow") {
+            if (value == "block") {
+                sink.overflow = OverflowPolicy::Block;
+            } else if (value == "drop-oldest") {
+                sink.overflow = OverflowPolicy::DropOldest;
+            } else if (value == "sample" || value.rfind("sample:", 0) == 0) {
+                sink.overflow = OverflowPolicy::Sample;
+
+                if (value.size() > 6) {
+                    sink.sampleEvery = parseCount("--sink overflow=sample", value.substr(7));
+                }
+
+                if (sink.sampleEvery == 0) {
+                    throw std::invalid_argument("Некорректное значение параметра --sink overflow: " + value);
+                }
+            } else {
+                throw std::invalid_argument("Неизвестное действие при заполнении очереди приемника: " + value);
+            }
+        } else {
+            throw std::invalid_argument("Неизвестная настройка приемника: " + setting);
+        }
+    }
+
+    return sink;
+}
+
+}
+
+ProgramOptions parseProgramOptions(int argc, char* argv[]) {
+    ProgramOptions options;
+    bool hasBlockSize = false;
+    bool traceSampleSet = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+
+        if (arg.rfind("--", 0) != 0) {
+            if (hasBlockSize) {
+                throw std::invalid_argument("Лишний параметр: " + arg);
+            }
+
+            options.blockSize = parseCount("N", arg);
+            hasBlockSize = true;
+            continue;
+        }
+
+        std::string name = arg;
+        std::string value;
+        bool hasValue = false;
+        auto eq = arg.find('=');
+
+        if (eq != std::string::npos) {
+            name = arg.substr(0, eq);
+            value = arg.substr(eq + 1);
+            hasValue = true;
+        }
+
+        auto nextValue = [&]() {
+            if (!hasValue) {
+                if (i + 1 >= argc) {
+                    throw std::invalid_argument("Не задано значение параметра " + name);
+                }
+
+                value = argv[++i];
+                hasValue = true;
+            }
+
+            return value;
+        };
+
+        if (name == "--pipeline") {
+            options.logger.pipeline = true;
+        } else if (name == "--file-threads") {
+            options.logger.fileThreads = parseCount(name, nextValue());
+            options.logger.pipeline = true;
+        } else if (name == "--queue-size") {
+            options.logger.queueCapacity = parseCount(name, nextValue());
+            options.logger.pipeline = true;
+
+            if (options.logger.queueCapacity == 0) {
+                throw std::invalid_argument("Некорректное значение параметра " + name + ": " + value);
+            }
+        } else if (name == "--queue-full") {
+            const std::string policy = nextValue();
+
+            if (policy == "block") {
+                options.logger.queuePolicy = FullPolicy::Block;
+            } else if (policy == "spin") {
+                options.logger.queuePolicy = FullPolicy::Spin;
+            } else if (policy == "drop") {
+                options.logger.queuePolicy = FullPolicy::Drop;
+            } else {
+                throw std::invalid_argument("Неизвестное действие при заполнении очереди: " + policy);
+            }
+
+            options.logger.pipeline = true;
+        } else if (name == "--store") {
+            const std::string store = nextValue();
+
+            if (store == "files") {
+                options.logger.store = StoreType::Files;
+            } else if (store == "segments") {
+                options.logger.store = StoreType::Segments;
+            } else {
+                throw std::invalid_argument("Неизвестный способ сохранения: " + store);
+            }
+        } else if (name == "--segment-dir") {
+            options.logger.segmentDir = nextValue();
+            options.logger.store = StoreType::Segments;
+        } else if (name == "--segment-size") {
+            options.logger.segmentSize = parseSize(name, nextValue());
+            options.logger.store = StoreType::Segments;
+        } else if (name == "--segment-age") {
+            options.logger.segmentAge = parseCount(name, nextValue());
+            options.logger.store = StoreType::Segments;
+        } else if (name == "--compress") {
+            const std::string compression = nextValue();
+
+            if (compression == "none") {
+                options.logger.compression = Compression::None;
+            } else if (compression == "zlib") {
+                options.logger.compression = Compression::Zlib;
+                options.logger.pipeline = true;
+            } else {
+                throw std::invalid_argument("Неизвестный способ сжатия: " + compression);
+            }
+        } else if (name == "--compress-level") {
+            size_t level = parseCount(name, nextValue());
+
+            if (level < 1 || level > 9) {
+                throw std::invalid_argument("Некорректное значение параметра " + name + ": " + value);
+            }
+
+            options.logger.compressLevel = static_cast<int>(level);
+            options.logger.compression = Compression::Zlib;
+            options.logger.pipeline = true;
+        } else if (name == "--io-backend") {
+            const std::string backend = nextValue();
+
+            if (backend == "sync") {
+                options.logger.ioBackend = IoBackend::Sync;
+            } else if (backend == "uring") {
+                options.logger.ioBackend = IoBackend::Uring;
+            } else {
+                throw std::invalid_argument("Неизвестный способ записи: " + backend);
+            }
+        } else if (name == "--uring-depth") {
+            options.logger.uringDepth = parseCount(name, nextValue());
+            options.logger.ioBackend = IoBackend::Uring;
+
+            if (options.logger.uringDepth == 0 || options.logger.uringDepth > 4096) {
+                throw std::invalid_argument("Некорректное значение параметра " + name + ": " + value);
+            }
+        } else if (name == "--durability") {
+            const std::string durability = nextValue();
+
+            if (durability == "none") {
+                options.logger.durability = Durability::None;
+            } else if (durability == "block") {
+                options.logger.durability = Durability::Block;
+            } else if (durability == "group") {
+                options.logger.durability = Durability::Group;
+            } else {
+                throw std::invalid_argument("Неизвестная гарантия сохранности: " + durability);
+            }
+        } else if (name == "--group-size") {
+            options.logger.groupSize = parseSize(name, nextValue());
+            options.logger.durability = Durability::Group;
+        } else if (name == "--group-time") {
+            options.logger.groupTime = parseCount(name, nextValue());
+            options.logger.durability = Durability::Group;
+        } else if (name == "--spill-block") {
+            const std::string size = nextValue();
+            options.logger.spillBlock = size == "0" ? 0 : parseSize(name, size);
+        } else if (name == "--spill-total") {
+            options.logger.spillTotal = parseSize(name, nextValue());
+        } else if (name == "--spill-dir") {
+            options.logger.spillDir = nextValue();
+        } else if (name == "--sink") {
+            SinkOptions sink = parseSink(nextValue());
+            size_t same = 0;
+
+            for (const auto& other : options.logger.sinks) {
+                same += other.name == sink.name || other.name.rfind(sink.name + "#", 0) == 0;
+            }
+
+            // Одинаковые приемники различаются в показателях номером
+            if (same > 0) {
+                sink.name += "#" + std::to_string(same + 1);
+            }
+
+            options.logger.sinks.push_back(std::move(sink));
+            options.logger.pipeline = true;
+        } else if (name == "--index") {
+            options.logger.index = true;
+        } else if (name == "--intern") {
+            options.logger.intern = true;
+        } else if (name == "--max-latency") {
+            options.logger.maxLatency = parseCount(name, nextValue());
+        } else if (name == "--listen") {
+            options.listen = nextValue();
+        } else if (name == "--input") {
+            options.input = nextValue();
+        } else if (name == "--input-threads") {
+            options.inputThreads = parseCount(name, nextValue());
+
+            if (options.inputThreads == 0) {
+                throw std::invalid_argument("Некорректное значение параметра " + name + ": " + value);
+            }
+        } else if (name == "--stats-file") {
+            options.statsFile = nextValue();
+        } else if (name == "--stats-interval") {
+            options.statsInterval = parseCount(name, nextValue());
+        } else if (name == "--trace-file") {
+            options.traceFile = nextValue();
+        } else if (name == "--trace-sample") {
+            options.traceSample = parseCount(name, nextValue());
+            traceSampleSet = true;
+
+            if (options.traceSample == 0) {
+                throw std::invalid_argument("Некорректное значение параметра --trace-sample: 0");
+            }
+        } else {
+            throw std::invalid_argument("Неизвестный параметр: " + name);
+        }
+    }
+
+    if (!hasBlockSize) {
+        throw std::invalid_argument("Не задан размер блока команд");
+    }
+
+    if (!options.listen.empty() && !options.input.empty()) {
+        throw std::invalid_argument("Параметры --listen и --input несовместимы");
+    }
+
+    if (!options.logger.sinks.empty() && options.logger.durability != Durability::None) {
+        throw std::invalid_argument("Параметры --sink и --durability несовместимы");
+    }
+
+    if (traceSampleSet && options.traceFile.empty()) {
+        throw std::invalid_argument("Параметр --trace-sample требует --trace-file");
+    }
+
+    return options;
+}
+
+std::string programUsage() {
+    return "Использование: bulk N [--pipeline] [--file-threads K] [--queue-size N] [--queue-full block|spin|drop]\n"
+           "            [--store files|segments] [--segment-dir DIR] [--segment-size BYTES[K|M|G]] [--segment-age SEC]\n"
+           "            [--io-backend sync|uring] [--uring-depth N] [--compress none|zlib] [--compress-level 1-9]\n"
+           "            [--durability none|block|group] [--group-size BYTES[K|M|G]] [--group-time MS]\n"
+           "            [--spill-block BYTES[K|M|G]|0] [--spill-total BYTES[K|M|G]] [--spill-dir DIR]\n"
+           "            [--stats-file PATH] [--stats-interval SEC] [--max-latency MS] [--intern] [--index]\n"
+           "            [--trace-file PATH] [--trace-sample K]\n"
+           "            [--sink stdout|store|null|unix:PATH[,queue=N][,overflow=block|drop-oldest|sample[:K]]]...\n"
+           "            [--listen unix:PATH|tcp:PORT] [--input FILE] [--input-threads K]\n";
+}
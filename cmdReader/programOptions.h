@@ -0,0 +1,67 @@
+#pragma once
+#include <string>
+#include "../cmdLogger/loggerOptions.h"
+
+/**
+ * @brief Структура ProgramOptions хранит параметры командной строки.
+ */
+struct ProgramOptions {
+    size_t blockSize = 0; /**< Размер блока команд. */
+    LoggerOptions logger; /**< Настройки вывода блоков. */
+    std::string statsFile; /**< Файл показателей, пустая строка - вывод по SIGUSR1 в stderr. */
+    size_t statsInterval = 10; /**< Период записи файла показателей в секундах. */
+    std::string traceFile; /**< Файл трасс задержек, пустая строка - трассировка выключена. */
+    size_t traceSample = 1000; /**< Каждая какая команда потока трассируется. */
+    std::string listen; /**< Адрес сервера, пустая строка - чтение стандартного ввода. */
+    std::string input; /**< Файл команд для параллельного воспроизведения, пустая строка - стандартный ввод. */
+    size_t inputThreads = 0; /**< Количество потоков разбора файла, 0 - по числу ядер. */
+};
+
+/**
+ * @brief Разобрать параметры командной строки.
+ * 
+ * Первый позиционный параметр - размер блока команд N. Остальные параметры
+ * задаются в виде "--имя значение" или "--имя=значение":
+ *   --pipeline          выводить блоки в отдельных потоках;
+ *   --file-threads K    количество потоков записи в файлы (включает --pipeline);
+ *   --queue-size N      емкость очереди конвейера в пачках (включает --pipeline);
+ *   --queue-full P      действие при заполненной очереди: block, spin или drop (включает --pipeline);
+ *   --store TYPE        способ сохранения блоков: files или segments;
+ *   --segment-dir DIR   каталог сегментных файлов (включает --store segments);
+ *   --segment-size SIZE размер сегмента, допускаются суффиксы K, M, G;
+ *   --segment-age SEC   наибольший возраст сегмента в секундах;
+ *   --durability MODE   гарантия сохранности: none, block или group;
+ *   --group-size SIZE   наибольший объем окна фиксации (включает --durability group);
+ *   --group-time MS     наибольшая длительность окна фиксации (включает --durability group);
+ *   --io-backend TYPE   способ записи блоков в файлы: sync или uring;
+ *   --uring-depth N     наибольшее количество одновременных записей io_uring (включает --io-backend uring);
+ *   --spill-block SIZE  объем динамического блока, после которого он выгружается в файл, 0 - без выгрузки;
+ *   --spill-total SIZE  общий объем динамических блоков в памяти;
+ *   --spill-dir DIR     каталог временных файлов выгрузки;
+ *   --compress TYPE     сжатие сохраняемых блоков: none или zlib;
+ *   --compress-level N  уровень сжатия zlib от 1 до 9 (включает --compress zlib);
+ *   --stats-file PATH   файл показателей в формате Prometheus;
+ *   --stats-interval SEC период записи файла показателей, 0 - только по SIGUSR1;
+ *   --trace-file PATH   файл трасс задержек в формате Chrome trace event;
+ *   --trace-sample K    трассировать каждую K-ю команду потока (требует --trace-file);
+ *   --max-latency MS    наибольшее время ожидания незаполненного статического блока;
+ *   --intern            хранить команды блоков номерами в общем словаре;
+ *   --index             вести индекс сохраненных блоков по времени в файле bulk.idx;
+ *   --sink SPEC         добавить приемник графа вывода (включает --pipeline), можно повторять;
+ *   --listen ADDR       принимать команды от клиентов по адресу unix:/путь или tcp:порт;
+ *   --input FILE        воспроизвести файл команд, отобразив его в память;
+ *   --input-threads K   количество потоков разбора файла, по умолчанию по числу ядер.
+ * 
+ * @param argc Количество аргументов.
+ * @param argv Аргументы командной строки.
+ * @return ProgramOptions Разобранные параметры.
+ * @throws std::invalid_argument Если параметры заданы некорректно.
+ */
+ProgramOptions parseProgramOptions(int argc, char* argv[]);
+
+/**
+ * @brief Получить строку с описанием параметров командной строки.
+ * 
+ * @return std::string Описание параметров.
+ */
+std::string programUsage();
@@ -0,0 +1,336 @@
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <iostream>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "../cmdLogger/metrics.h"
+#include "commandServer.h"
+
+namespace {
+
+constexpr size_t kReadBufferSize = 1 << 20;
+constexpr int kMaxEvents = 256;
+constexpr int kMaxReadsPerEvent = 16;
+
+void throwSystemError(const std::string& what) {
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+}
+
+CommandServer::CommandServer(size_t block_size, const LoggerOptions& options, const std::string& listen)
+    : signal_fd_(createSignalFd()), epoll_fd_(::epoll_create1(EPOLL_CLOEXEC)), listen_fd_(-1),
+      listen_paused_(false), fd_limit_reported_(false), manager_(block_size, options), buffer_(kReadBufferSize) {
+    if (epoll_fd_ < 0) {
+        throwSystemError("epoll_create1");
+    }
+
+    openListener(listen);
+
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = listen_fd_;
+
+    if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, listen_fd_, &event) != 0) {
+        throwSystemError("epoll_ctl");
+    }
+
+    event.data.fd = signal_fd_;
+
+    if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, signal_fd_, &event) != 0) {
+        throwSystemError("epoll_ctl");
+    }
+}
+
+CommandServer::~CommandServer() {
+    for (auto& connection : connections_) {
+        ::close(connection.first);
+    }
+
+    if (listen_fd_ >= 0) {
+        ::close(listen_fd_);
+    }
+
+    if (!unix_path_.empty()) {
+        ::unlink(unix_path_.c_str());
+    }
+
+    if (epoll_fd_ >= 0) {
+        ::close(epoll_fd_);
+    }
+
+    if (signal_fd_ >= 0) {
+        ::close(signal_fd_);
+    }
+}
+
+int CommandServer::createSignalFd() {
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGINT);
+    sigaddset(&set, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &set, nullptr);
+
+    int fd = ::signalfd(-1, &set, SFD_NONBLOCK | SFD_CLOEXEC);
+
+    if (fd < 0) {
+        throwSystemError("signalfd");
+    }
+
+    return fd;
+}
+
+void CommandServer::openListener(const std::string& listen) {
+    if (listen.rfind("unix:", 0) == 0) {
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        unix_path_ = listen.substr(5);
+
+        if (unix_path_.empty() || unix_path_.size() >= sizeof(addr.sun_path)) {
+            throw std::invalid_argument("Некорректный путь сокета: " + unix_path_);
+        }
+
+        std::strcpy(addr.sun_path, unix_path_.c_str());
+        ::unlink(unix_path_.c_str());
+
+        listen_fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+        if (listen_fd_ < 0 || ::bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            throwSystemError("Unable to bind " + listen);
+        }
+    } else if (listen.rfind("tcp:", 0) == 0) {
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        try {
+            std::string text = listen.substr(4);
+            size_t pos = 0;
+            unsigned long port = std::stoul(text, &pos);
+
+            if (pos != text.size() || port > 65535) {
+                throw std::out_of_range("port");
+            }
+
+            addr.sin_port = htons(static_cast<uint16_t>(port));
+        } catch (const std::exception&) {
+            throw std::invalid_argument("Некорректный порт: " + listen.substr(4));
+        }
+
+        listen_fd_ = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        int reuse = 1;
+
+        if (listen_fd_ < 0
+            || ::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) != 0
+            || ::bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            throwSystemError("Unable to bind " + listen);
+        }
+    } else {
+        throw std::invalid_argument("Некорректный адрес: " + listen + " (ожидается unix:/путь или tcp:порт)");
+    }
+
+    if (::listen(listen_fd_, SOMAXCONN) != 0) {
+        throwSystemError("listen");
+    }
+}
+
+void CommandServer::run() {
+    epoll_event events[kMaxEvents];
+    bool running = true;
+
+    while (running) {
+        int count = ::epoll_wait(epoll_fd_, events, kMaxEvents, waitTimeout());
+
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            throwSystemError("epoll_wait");
+        }
+
+        for (int i = 0; i < count; ++i) {
+            int fd = events[i].data.fd;
+
+            if (fd == signal_fd_) {
+                running = false;
+            } else if (fd == listen_fd_) {
+                acceptConnections();
+            } else if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR | EPOLLRDHUP)) {
+                readConnection(fd);
+            }
+        }
+
+        if (listen_paused_ && std::chrono::steady_clock::now() >= listen_retry_) {
+            resumeListener();
+        }
+
+        manager_.flushExpired(std::chrono::system_clock::now());
+    }
+
+    while (!connections_.empty()) {
+        closeConnection(connections_.begin()->first);
+    }
+
+    manager_.onEnd();
+    manager_.finish();
+}
+
+size_t CommandServer::connectionCount() const {
+    return connections_.size();
+}
+
+void CommandServer::raiseFileLimit() {
+    rlimit limit{};
+
+    if (::getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        ::setrlimit(RLIMIT_NOFILE, &limit);
+    }
+}
+
+void CommandServer::acceptConnections() {
+    while (true) {
+        int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return;
+            }
+
+            if (errno == EMFILE || errno == ENFILE) {
+                pauseListener();
+                return;
+            }
+
+            throwSystemError("accept4");
+        }
+
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLRDHUP;
+        event.data.fd = fd;
+
+        if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) != 0) {
+            ::close(fd);
+            throwSystemError("epoll_ctl");
+        }
+
+        connections_.emplace(fd, std::make_unique<ConnectionContext>(manager_));
+    }
+}
+
+void CommandServer::pauseListener() {
+    if (::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, listen_fd_, nullptr) != 0) {
+        throwSystemError("epoll_ctl");
+    }
+
+    if (!std::exchange(fd_limit_reported_, true)) {
+        std::cerr << "Too many open files, new connections wait until a connection closes" << std::endl;
+    }
+
+    listen_paused_ = true;
+    listen_retry_ = std::chrono::steady_clock::now() + kAcceptRetry;
+}
+
+void CommandServer::resumeListener() {
+    if (!listen_paused_) {
+        return;
+    }
+
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = listen_fd_;
+
+    if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, listen_fd_, &event) != 0) {
+        throwSystemError("epoll_ctl");
+    }
+
+    listen_paused_ = false;
+}
+
+void CommandServer::readConnection(int fd) {
+    auto it = connections_.find(fd);
+
+    if (it == connections_.end()) {
+        return;
+    }
+
+    Metrics& metrics = Metrics::instance();
+
+    // Ограничение чтений не дает одному клиенту занять цикл событий;
+    // epoll работает по уровню и сообщит об оставшихся данных снова
+    for (int reads = 0; reads < kMaxReadsPerEvent; ) {
+        ssize_t count = ::read(fd, buffer_.data(), buffer_.size());
+
+        if (count > 0) {
+            auto start = std::chrono::steady_clock::now();
+            it->second->receive(buffer_.data(), static_cast<size_t>(count));
+            metrics.parseLatency.record(std::chrono::steady_clock::now() - start);
+            metrics.inputBytes.add(static_cast<uint64_t>(count));
+            ++reads;
+            continue;
+        }
+
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return;
+        }
+
+        closeConnection(fd);
+        return;
+    }
+}
+
+void CommandServer::closeConnection(int fd) {
+    auto it = connections_.find(fd);
+
+    if (it == connections_.end()) {
+        return;
+    }
+
+    it->second->close();
+    connections_.erase(it);
+    ::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    ::close(fd);
+
+    // Освободился дескриптор: ожидающее подключение можно принять
+    resumeListener();
+}
+
+int CommandServer::waitTimeout() const {
+    auto deadline = manager_.getStaticDeadline();
+    long long timeout = -1;
+
+    if (deadline.has_value()) {
+        auto left = std::chrono::ceil<std::chrono::milliseconds>(*deadline - std::chrono::system_clock::now());
+        timeout = std::max<long long>(left.count(), 0);
+    }
+
+    if (listen_paused_) {
+        auto left = std::chrono::ceil<std::chrono::milliseconds>(listen_retry_ - std::chrono::steady_clock::now());
+        long long retry = std::max<long long>(left.count(), 0);
+        timeout = timeout < 0 ? retry : std::min(timeout, retry);
+    }
+
+    return static_cast<int>(timeout);
+}
@@ -0,0 +1,136 @@
+#pragma once
+#include <chrono>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../cmdLogger/commandManager.h"
+#include "../cmdLogger/loggerOptions.h"
+#include "connectionContext.h"
+
+/**
+ * @brief Класс CommandServer принимает команды от многих клиентов.
+ * 
+ * Сервер слушает Unix-сокет ("unix:/путь") или TCP-порт на 127.0.0.1
+ * ("tcp:порт") и обслуживает все подключения в одном потоке через epoll.
+ * Каждое подключение получает свой ConnectionContext, статические команды
+ * всех подключений собираются общим CommandManager. Сервер работает
+ * до получения SIGINT или SIGTERM, после чего закрывает подключения
+ * и выводит оставшиеся блоки.
+ *
+ * Если дескрипторы процесса исчерпаны (EMFILE, ENFILE), слушающий сокет
+ * снимается с epoll: иначе epoll по уровню сообщал бы о нем снова и цикл
+ * занимал бы процессор. Ожидающие подключения остаются в очереди сокета
+ * и принимаются, когда закрывается подключение или проходит kAcceptRetry.
+ */
+class CommandServer {
+public:
+    static constexpr std::chrono::milliseconds kAcceptRetry{100}; /**< Период повторного приема при исчерпанных дескрипторах. */
+
+    /**
+     * @brief Конструктор CommandServer.
+     * 
+     * Блокирует SIGINT и SIGTERM в вызывающем потоке до создания потоков
+     * вывода, чтобы сигналы принимались только циклом событий.
+     * 
+     * @param block_size Размер статического блока команд.
+     * @param options Настройки вывода блоков.
+     * @param listen Адрес в виде "unix:/путь" или "tcp:порт".
+     * @throws std::invalid_argument Если адрес задан некорректно.
+     * @throws std::system_error Если сокет не удается создать.
+     */
+    CommandServer(size_t block_size, const LoggerOptions& options, const std::string& listen);
+
+    // Запрещаем копирование и присваивание
+    CommandServer(const CommandServer&) = delete;
+    CommandServer& operator=(const CommandServer&) = delete;
+
+    /**
+     * @brief Деструктор закрывает сокеты.
+     */
+    ~CommandServer();
+
+    /**
+     * @brief Обслуживать подключения до получения сигнала завершения.
+     * 
+     * @throws std::system_error Если цикл событий завершился ошибкой.
+     */
+    void run();
+
+    /**
+     * @brief Получить количество открытых подключений.
+     * 
+     * @return size_t Количество подключений.
+     */
+    size_t connectionCount() const;
+
+    /**
+     * @brief Поднять мягкое ограничение открытых файлов до жесткого.
+     *
+     * Ограничение по умолчанию (обычно 1024) меньше числа клиентов,
+     * которых обслуживает сервер. Ошибка setrlimit не мешает работе.
+     */
+    static void raiseFileLimit();
+
+private:
+    /**
+     * @brief Заблокировать сигналы завершения и создать signalfd.
+     * 
+     * @return int Дескриптор signalfd.
+     */
+    static int createSignalFd();
+
+    /**
+     * @brief Создать слушающий сокет.
+     * 
+     * @param listen Адрес сокета.
+     */
+    void openListener(const std::string& listen);
+
+    /**
+     * @brief Принять все ожидающие подключения.
+     */
+    void acceptConnections();
+
+    /**
+     * @brief Снять слушающий сокет с epoll до освобождения дескрипторов.
+     */
+    void pauseListener();
+
+    /**
+     * @brief Вернуть слушающий сокет в epoll, если он был снят.
+     */
+    void resumeListener();
+
+    /**
+     * @brief Прочитать данные подключения.
+     * 
+     * @param fd Дескриптор подключения.
+     */
+    void readConnection(int fd);
+
+    /**
+     * @brief Закрыть подключение и вывести его незавершенный блок.
+     * 
+     * @param fd Дескриптор подключения.
+     */
+    void closeConnection(int fd);
+
+    /**
+     * @brief Получить таймаут epoll_wait до срока статического блока.
+     * 
+     * @return int Таймаут в миллисекундах, -1 - без ограничения.
+     */
+    int waitTimeout() const;
+
+    int signal_fd_; /**< Дескриптор signalfd. */
+    int epoll_fd_; /**< Дескриптор epoll. */
+    int listen_fd_; /**< Слушающий сокет. */
+    std::string unix_path_; /**< Путь Unix-сокета, удаляемый при завершении. */
+    bool listen_paused_; /**< Слушающий сокет снят с epoll из-за исчерпания дескрипторов. */
+    std::chrono::steady_clock::time_point listen_retry_; /**< Время повторного приема подключений. */
+    bool fd_limit_reported_; /**< Сообщение об исчерпании дескрипторов уже выведено. */
+    CommandManager manager_; /**< Общий менеджер команд. */
+    std::unordered_map<int, std::unique_ptr<ConnectionContext>> connections_; /**< Подключения. */
+    std::vector<char> buffer_; /**< Буфер чтения. */
+};
@@ -0,0 +1,40 @@
+#include <string_view>
+#include "../cmdLogger/commandManager.h"
+#include "connectionContext.h"
+
+
+ConnectionContext::ConnectionContext(CommandManager& manager)
+    : manager_(manager), parser_(*this), dynamic_block_index_(CommandManager::kNewBlock) {}
+
+void ConnectionContext::receive(const char* data, size_t size) {
+    parser_.feed(data, size);
+}
+
+void ConnectionContext::close() {
+    parser_.finish();
+}
+
+void ConnectionContext::onCommand(std::string_view command, bool isDynamic) {
+    if (isDynamic) {
+        dynamic_block_index_ = manager_.addCommandToBlock(dynamic_block_index_, command, true).blockIndex;
+    } else {
+        manager_.onCommand(command, false);
+    }
+}
+
+void ConnectionContext::onBlockOpen() {
+    dynamic_block_index_ = CommandManager::kNewBlock;
+}
+
+void ConnectionContext::onBlockClose() {
+    manager_.logBlock(dynamic_block_index_);
+    dynamic_block_index_ = CommandManager::kNewBlock;
+}
+
+void ConnectionContext::onBreak() {
+    manager_.onBreak();
+}
+
+void ConnectionContext::onEnd() {
+    onBlockClose();
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <string_view>
+#include "../cmdLogger/blockEventHandler.h"
+#include "../cmdLogger/commandManager.h"
+#include "../cmdReader/commandParser.h"
+
+/**
+ * @brief Класс ConnectionContext - контекст одного подключения к серверу.
+ * 
+ * У каждого подключения свой разборщик и свой динамический блок, а статические
+ * команды всех подключений передаются общему CommandManager и собираются
+ * в общий блок по N команд. Начало динамического блока в одном подключении
+ * не прерывает общий статический блок. При закрытии подключения его
+ * незавершенный динамический блок выводится.
+ */
+class ConnectionContext : public BlockEventHandler {
+public:
+    /**
+     * @brief Конструктор ConnectionContext.
+     * 
+     * @param manager Общий менеджер команд.
+     */
+    explicit ConnectionContext(CommandManager& manager);
+
+    // Запрещаем копирование и присваивание
+    ConnectionContext(const ConnectionContext&) = delete;
+    ConnectionContext& operator=(const ConnectionContext&) = delete;
+
+    /**
+     * @brief Передать данные, полученные от клиента.
+     * 
+     * @param data Данные.
+     * @param size Размер данных.
+     */
+    void receive(const char* data, size_t size);
+
+    /**
+     * @brief Завершить подключение.
+     */
+    void close();
+
+    void onCommand(std::string_view command, bool isDynamic) override;
+    void onBlockOpen() override;
+    void onBlockClose() override;
+    void onBreak() override;
+    void onEnd() override;
+
+private:
+    CommandManager& manager_; /**< Общий менеджер команд. */
+    CommandParser parser_; /**< Разборщик команд подключения. */
+    size_t dynamic_block_index_; /**< Индекс динамического блока подключения. */
+};
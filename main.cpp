@@ -1,26 +1,61 @@
 
 #include <iostream>
 #include <string>
+#include "./cmdLogger/latencyTracer.h"
+#include "./cmdLogger/metricsReporter.h"
 #include "./cmdReader/commandReader.h"
+#include "./cmdReader/fileReplay.h"
+#include "./cmdReader/programOptions.h"
+#include "./cmdServer/commandServer.h"
 
 
 int main(int argc, char* argv[]) {
     // Проверка на наличие аргумента командной строки для размера блока команд
     if (argc < 2) {
-        std::cerr << "Ошибка: укажите размер блока команд.\n";
+        std::cerr << "Ошибка: укажите размер блока команд.\n" << programUsage();
         return 1; // Завершаем программу с кодом ошибки
     }
 
+    ProgramOptions options;
+
+    try {
+        // Разбираем размер блока и параметры вывода
+        options = parseProgramOptions(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << "Ошибка: " << e.what() << "\n" << programUsage();
+        return 1;
+    }
+
+    // Выгрузка показателей по SIGUSR1 и в файл; создается до остальных потоков
+    MetricsReporter metricsReporter(options.statsFile, options.statsInterval);
+
+    // Трассировка включается до запуска потоков, выгружается после вывода всех блоков
+    if (!options.traceFile.empty()) {
+        LatencyTracer::instance().enable(options.traceSample);
+    }
+
     try {
-        // Преобразуем строковый аргумент в число
-        size_t block_size = std::stoul(argv[1]);
+        if (!options.listen.empty()) {
+            // Принимаем команды от клиентов через сокет; каждому клиенту нужен дескриптор
+            CommandServer::raiseFileLimit();
+            CommandServer server(options.blockSize, options.logger, options.listen);
+            server.run();
+        } else if (!options.input.empty()) {
+            // Воспроизводим файл команд в несколько потоков
+            FileReplay replay(options.blockSize, options.logger, options.input, options.inputThreads);
+            replay.execute();
+        } else {
+            // Создаем объект для обработки команд с заданным размером блока
+            CommandReader commandReader(options.blockSize, options.logger);
+            commandReader.execute();
+        }
 
-        // Создаем объект для обработки команд с заданным размером блока
-        CommandReader commandReader(block_size);
-        commandReader.execute();
+        if (!options.traceFile.empty()) {
+            LatencyTracer::instance().dump(options.traceFile);
+        }
     } catch (const std::exception& e) {
-        // Обработка ошибок при некорректном размере блока команд
-        std::cerr << "Некорректный размер блока: " << e.what() << std::endl;
+        // Обработка ошибок при некорректном размере блока или выводе команд
+        std::cerr << "Ошибка: " << e.what() << std::endl;
         return 1;
     }
 
@@ -0,0 +1,234 @@
+#include <algorithm>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "../cmdLibrary/bulkAsync.h"
+#include "testUtils.h"
+
+namespace {
+
+/**
+ * @brief Разобрать строку пачки на команды.
+ *
+ * @param line Строка вида "bulk: a, b, c".
+ * @return std::vector<std::string> Команды или пустой список, если строка не пачка.
+ */
+std::vector<std::string> bulkCommands(const std::string& line) {
+    const std::string prefix = "bulk: ";
+    std::vector<std::string> commands;
+
+    if (line.compare(0, prefix.size(), prefix) != 0) {
+        return commands;
+    }
+
+    for (size_t begin = prefix.size(); begin <= line.size();) {
+        size_t end = line.find(", ", begin);
+        end = end == std::string::npos ? line.size() : end;
+        commands.push_back(line.substr(begin, end - begin));
+        begin = end + 2;
+    }
+
+    return commands;
+}
+
+/**
+ * @brief Номер потока из команды вида "t<поток>...".
+ *
+ * @param command Команда.
+ * @return size_t Номер потока.
+ */
+size_t commandThread(const std::string& command) {
+    return std::stoul(command.substr(1));
+}
+
+/**
+ * @brief Номер команды потока из команды вида "t<поток>s<номер>".
+ *
+ * @param command Команда.
+ * @return size_t Номер команды.
+ */
+size_t commandNumber(const std::string& command) {
+    return std::stoul(command.substr(command.find('s') + 1));
+}
+
+/**
+ * @brief Передать данные подключению порциями, разрывающими строки.
+ *
+ * @param handle Подключение.
+ * @param data Данные.
+ * @param chunk Размер порции.
+ * @return bool Возвращает true, если все порции приняты.
+ */
+bool receiveChunks(bulk_handle* handle, const std::string& data, size_t chunk) {
+    for (size_t offset = 0; offset < data.size(); offset += chunk) {
+        if (bulk_receive(handle, data.data() + offset, std::min(chunk, data.size() - offset)) != 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(asyncLibrary)
+
+// Восемь потоков с общим N: каждая команда выводится ровно один раз,
+// статические команды потока - по порядку, динамические блоки - целиком
+BOOST_AUTO_TEST_CASE(eight_threads_share_one_logger) {
+    constexpr size_t kThreads = 8;
+    constexpr size_t kStatic = 2000;
+    constexpr size_t kBlockEvery = 100;
+    constexpr size_t kBlockCommands = 5;
+
+    TempDir dir(true);
+    StdoutCapture capture(dir.path() + "/stdout");
+    std::vector<std::thread> threads;
+    std::vector<int> results(kThreads, 0);
+
+    for (size_t t = 0; t < kThreads; ++t) {
+        threads.emplace_back([t, &results]() {
+            bulk_handle* handle = bulk_connect(3);
+
+            if (!handle) {
+                results[t] = -1;
+                return;
+            }
+
+            std::string data;
+
+            for (size_t i = 0; i < kStatic; ++i) {
+                data += "t" + std::to_string(t) + "s" + std::to_string(i) + "\n";
+
+                if (i % kBlockEvery == kBlockEvery - 1) {
+                    data += "{\n";
+
+                    for (size_t k = 0; k < kBlockCommands; ++k) {
+                        data += "t" + std::to_string(t) + "d" + std::to_string(i) + "k" + std::to_string(k) + "\n";
+                    }
+
+                    data += "}\n";
+                }
+            }
+
+            bool received = receiveChunks(handle, data, 7 + t);
+            results[t] = bulk_disconnect(handle) == 0 && received ? 1 : -1;
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::vector<std::string> lines = capture.restore();
+
+    for (size_t t = 0; t < kThreads; ++t) {
+        BOOST_REQUIRE_EQUAL(results[t], 1);
+    }
+
+    std::map<std::string, size_t> seen;
+    std::vector<size_t> next_static(kThreads, 0);
+
+    for (const auto& line : lines) {
+        std::vector<std::string> commands = bulkCommands(line);
+        BOOST_REQUIRE_MESSAGE(!commands.empty(), "unexpected output line: " << line);
+
+        if (commands.front().find('d') != std::string::npos) {
+            // Динамический блок выводится одной пачкой без чужих команд
+            BOOST_REQUIRE_EQUAL(commands.size(), kBlockCommands);
+            std::string block = commands.front().substr(0, commands.front().rfind('k'));
+
+            for (size_t k = 0; k < kBlockCommands; ++k) {
+                BOOST_REQUIRE_EQUAL(commands[k], block + "k" + std::to_string(k));
+            }
+        } else {
+            BOOST_REQUIRE_LE(commands.size(), 3u);
+
+            for (const auto& command : commands) {
+                size_t t = commandThread(command);
+                BOOST_REQUIRE_LT(t, kThreads);
+                BOOST_REQUIRE_EQUAL(commandNumber(command), next_static[t]++);
+            }
+        }
+
+        for (const auto& command : commands) {
+            BOOST_REQUIRE_MESSAGE(++seen[command] == 1, "command printed twice: " << command);
+        }
+    }
+
+    BOOST_CHECK_EQUAL(seen.size(), kThreads * (kStatic + kStatic / kBlockEvery * kBlockCommands));
+
+    for (size_t t = 0; t < kThreads; ++t) {
+        BOOST_CHECK_EQUAL(next_static[t], kStatic);
+    }
+}
+
+// Подключения постоянно открываются и закрываются: новое подключение не
+// выводит блоки, пока прежний менеджер того же N выводит оставшиеся
+BOOST_AUTO_TEST_CASE(reconnect_waits_for_finishing_logger) {
+    constexpr size_t kThreads = 8;
+    constexpr size_t kRounds = 200;
+
+    TempDir dir(true);
+    StdoutCapture capture(dir.path() + "/stdout");
+    std::vector<std::thread> threads;
+    std::vector<int> results(kThreads, 1);
+
+    for (size_t t = 0; t < kThreads; ++t) {
+        threads.emplace_back([t, &results]() {
+            size_t number = 0;
+
+            for (size_t round = 0; round < kRounds; ++round) {
+                bulk_handle* handle = bulk_connect(2);
+
+                if (!handle) {
+                    results[t] = -1;
+                    return;
+                }
+
+                std::string data;
+
+                for (size_t i = 0; i < 3; ++i) {
+                    data += "t" + std::to_string(t) + "s" + std::to_string(number++) + "\n";
+                }
+
+                bool received = receiveChunks(handle, data, data.size());
+
+                if (bulk_disconnect(handle) != 0 || !received) {
+                    results[t] = -1;
+                }
+            }
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::vector<std::string> lines = capture.restore();
+
+    for (size_t t = 0; t < kThreads; ++t) {
+        BOOST_REQUIRE_EQUAL(results[t], 1);
+    }
+
+    std::vector<size_t> next(kThreads, 0);
+
+    for (const auto& line : lines) {
+        std::vector<std::string> commands = bulkCommands(line);
+        BOOST_REQUIRE_MESSAGE(!commands.empty(), "unexpected output line: " << line);
+
+        for (const auto& command : commands) {
+            size_t t = commandThread(command);
+            BOOST_REQUIRE_LT(t, kThreads);
+            BOOST_REQUIRE_EQUAL(commandNumber(command), next[t]++);
+        }
+    }
+
+    for (size_t t = 0; t < kThreads; ++t) {
+        BOOST_CHECK_EQUAL(next[t], kRounds * 3);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,84 @@
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "../cmdLogger/blockStore.h"
+#include "../cmdLogger/commandBlock.h"
+#include "../cmdLogger/uringWriter.h"
+#include "testUtils.h"
+
+namespace {
+
+/**
+ * @brief Сохранять одновременно из нескольких потоков блоки одной секунды.
+ *
+ * После каждого раунда файл блока должен целиком совпадать с одним из
+ * блоков раунда: блоки разной длины, поэтому перемешанная запись заметна.
+ *
+ * @param store Хранилище.
+ */
+void checkSameSecondBlocks(BlockStore& store) {
+    constexpr size_t kThreads = 4;
+    constexpr size_t kRounds = 100;
+
+    for (size_t round = 0; round < kRounds; ++round) {
+        std::vector<CommandBlock> blocks;
+        std::set<std::string> texts;
+
+        for (size_t t = 0; t < kThreads; ++t) {
+            CommandBlock block;
+            size_t commands = 1000 + (round * 7 + t * 3001) % 20000;
+
+            for (size_t i = 0; i < commands; ++i) {
+                block.AddCommand<FixedClock>(Command("r" + std::to_string(round) + "t" + std::to_string(t) + "c" + std::to_string(i)));
+            }
+
+            texts.insert(std::string(block.getBytes()));
+            blocks.push_back(std::move(block));
+        }
+
+        std::vector<std::thread> threads;
+
+        for (const auto& block : blocks) {
+            threads.emplace_back([&store, &block]() {
+                store.save(block);
+                store.submit();
+            });
+        }
+
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        store.flush();
+        BOOST_REQUIRE_MESSAGE(texts.count(readFile(blocks.front().getFileName())) == 1,
+                              "bulk file mixes several blocks in round " << round);
+    }
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(blockStore)
+
+BOOST_AUTO_TEST_CASE(same_second_files_are_not_mixed) {
+    TempDir dir(true);
+    FileBlockStore store;
+    checkSameSecondBlocks(store);
+}
+
+BOOST_AUTO_TEST_CASE(same_second_files_are_not_mixed_with_uring) {
+    auto uring = UringWriter::tryCreate(64);
+
+    if (!uring) {
+        BOOST_TEST_MESSAGE("io_uring is unavailable, test skipped");
+        return;
+    }
+
+    TempDir dir(true);
+    FileBlockStore store(false, std::move(uring));
+    checkSameSecondBlocks(store);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,156 @@
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "../cmdLogger/boundedQueue.h"
+
+namespace {
+
+constexpr size_t kProducers = 4;
+constexpr size_t kConsumers = 4;
+constexpr uint64_t kItems = 50000;
+
+/**
+ * @brief Итог работы нескольких производителей и потребителей.
+ */
+struct Exchange {
+    std::vector<uint64_t> seen = std::vector<uint64_t>(kProducers * kItems, 0); /**< Сколько раз получен каждый элемент. */
+    uint64_t lost = 0; /**< Потерянных элементов по данным push(). */
+    bool ordered = true; /**< Каждый потребитель получил элементы каждого производителя по порядку. */
+};
+
+/**
+ * @brief Передать элементы через очередь несколькими производителями и потребителями.
+ *
+ * Элемент - номер производителя, умноженный на kItems, плюс порядковый номер.
+ * Очередь одна и общая, поэтому каждый потребитель видит элементы одного
+ * производителя по возрастанию, даже если часть из них забрали другие.
+ *
+ * @param queue Очередь.
+ * @return Exchange Итог.
+ */
+Exchange run(BoundedQueue<uint64_t>& queue) {
+    Exchange exchange;
+    std::vector<uint64_t> lost(kProducers, 0);
+    std::vector<std::vector<uint64_t>> received(kConsumers);
+    std::vector<std::thread> producers;
+    std::vector<std::thread> consumers;
+
+    for (size_t c = 0; c < kConsumers; ++c) {
+        consumers.emplace_back([&queue, &received, c]() {
+            std::vector<uint64_t> batch;
+
+            while (queue.popBatch(batch, 32) > 0) {
+                received[c].insert(received[c].end(), batch.begin(), batch.end());
+                batch.clear();
+            }
+        });
+    }
+
+    for (size_t p = 0; p < kProducers; ++p) {
+        producers.emplace_back([&queue, &lost, p]() {
+            for (uint64_t i = 0; i < kItems; ++i) {
+                lost[p] += queue.push(p * kItems + i);
+            }
+        });
+    }
+
+    for (auto& producer : producers) {
+        producer.join();
+    }
+
+    queue.close();
+
+    for (auto& consumer : consumers) {
+        consumer.join();
+    }
+
+    for (uint64_t count : lost) {
+        exchange.lost += count;
+    }
+
+    for (const auto& items : received) {
+        std::vector<uint64_t> last(kProducers, 0);
+        std::vector<bool> any(kProducers, false);
+
+        for (uint64_t value : items) {
+            size_t producer = value / kItems;
+
+            if (producer >= kProducers || (any[producer] && value <= last[producer])) {
+                exchange.ordered = false;
+                continue;
+            }
+
+            any[producer] = true;
+            last[producer] = value;
+            ++exchange.seen[value];
+        }
+    }
+
+    return exchange;
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(boundedQueue)
+
+BOOST_AUTO_TEST_CASE(block_policy_delivers_every_item_once) {
+    BoundedQueue<uint64_t> queue(16, OverflowPolicy::Block);
+    Exchange exchange = run(queue);
+
+    BOOST_CHECK(exchange.ordered);
+    BOOST_CHECK_EQUAL(exchange.lost, 0u);
+
+    for (uint64_t count : exchange.seen) {
+        BOOST_REQUIRE_EQUAL(count, 1u);
+    }
+}
+
+// Вытесненные элементы учитываются ровно один раз, остальные доходят без повторов
+BOOST_AUTO_TEST_CASE(drop_oldest_policy_accounts_for_every_item) {
+    BoundedQueue<uint64_t> queue(16, OverflowPolicy::DropOldest);
+    Exchange exchange = run(queue);
+    uint64_t delivered = 0;
+
+    BOOST_CHECK(exchange.ordered);
+
+    for (uint64_t count : exchange.seen) {
+        BOOST_REQUIRE_LE(count, 1u);
+        delivered += count;
+    }
+
+    BOOST_CHECK_EQUAL(delivered + exchange.lost, kProducers * kItems);
+}
+
+BOOST_AUTO_TEST_CASE(sample_policy_accounts_for_every_item) {
+    BoundedQueue<uint64_t> queue(16, OverflowPolicy::Sample, 4);
+    Exchange exchange = run(queue);
+    uint64_t delivered = 0;
+
+    BOOST_CHECK(exchange.ordered);
+
+    for (uint64_t count : exchange.seen) {
+        BOOST_REQUIRE_LE(count, 1u);
+        delivered += count;
+    }
+
+    BOOST_CHECK_EQUAL(delivered + exchange.lost, kProducers * kItems);
+}
+
+BOOST_AUTO_TEST_CASE(close_wakes_blocked_producer) {
+    BoundedQueue<uint64_t> queue(1, OverflowPolicy::Block);
+    BOOST_CHECK_EQUAL(queue.push(1), 0u);
+
+    size_t lost = 0;
+    std::thread producer([&queue, &lost]() {
+        lost = queue.push(2);
+    });
+
+    queue.close();
+    producer.join();
+
+    BOOST_CHECK_EQUAL(lost, 1u);
+    BOOST_CHECK_EQUAL(queue.size(), 1u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
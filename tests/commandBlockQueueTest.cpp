@@ -0,0 +1,192 @@
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unistd.h>
+#include <boost/test/unit_test.hpp>
+#include "../cmdLogger/commandBlock.h"
+#include "../cmdLogger/commandBlockQueue.h"
+#include "../cmdLogger/commandManager.h"
+
+namespace {
+
+/**
+ * @brief Получить размер резидентной памяти процесса.
+ *
+ * @return size_t Размер в байтах.
+ */
+size_t residentBytes() {
+    size_t pages = 0;
+    size_t resident = 0;
+    FILE* statm = std::fopen("/proc/self/statm", "r");
+
+    if (statm) {
+        if (std::fscanf(statm, "%zu %zu", &pages, &resident) != 2) {
+            resident = 0;
+        }
+
+        std::fclose(statm);
+    }
+
+    return resident * static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(commandBlockQueue)
+
+BOOST_AUTO_TEST_CASE(indices_are_stable_after_retirement) {
+    CommandBlockQueue queue;
+
+    size_t first = queue.addBlock(CommandBlock());
+    size_t second = queue.addBlock(CommandBlock());
+    queue.getBlockAtIndex(second)->get().AddCommand(Command("cmd"));
+
+    BOOST_CHECK_EQUAL(first, 0u);
+    BOOST_CHECK_EQUAL(second, 1u);
+    BOOST_CHECK_EQUAL(queue.getBlockAtIndex(second)->get().getSequence(), 1u);
+
+    queue.deleteBlockByIndex(first);
+
+    BOOST_CHECK_EQUAL(queue.Size(), 1u);
+    BOOST_CHECK_EQUAL(queue.getFirstIndex(), 1u);
+    BOOST_CHECK_EQUAL(queue.getEndIndex(), 2u);
+    BOOST_CHECK(!queue.getBlockAtIndex(first).has_value());
+    BOOST_REQUIRE(queue.getBlockAtIndex(second).has_value());
+    BOOST_CHECK_EQUAL(queue.getBlockAtIndex(second)->get().getSize(), 1u);
+
+    // Новый блок продолжает сквозную нумерацию
+    BOOST_CHECK_EQUAL(queue.addBlock(CommandBlock()), 2u);
+    BOOST_CHECK_EQUAL(queue.getActiveBlockCount(), 2u);
+}
+
+BOOST_AUTO_TEST_CASE(deactivated_blocks_are_retired_from_head) {
+    CommandBlockQueue queue;
+
+    for (int i = 0; i < 3; ++i) {
+        queue.addBlock(CommandBlock());
+    }
+
+    queue.deactivateBlock(1);
+    BOOST_CHECK_EQUAL(queue.retireInactiveBlocks(), 0u);
+    BOOST_CHECK_EQUAL(queue.getActiveBlockCount(), 2u);
+
+    queue.deactivateBlock(0);
+    BOOST_CHECK_EQUAL(queue.retireInactiveBlocks(), 2u);
+    BOOST_CHECK_EQUAL(queue.getFirstIndex(), 2u);
+    BOOST_CHECK_EQUAL(queue.Size(), 1u);
+
+    queue.deleteBlockByIndex(2);
+    BOOST_CHECK(queue.isEmpty());
+    BOOST_CHECK_EQUAL(queue.getFirstIndex(), queue.getEndIndex());
+}
+
+BOOST_AUTO_TEST_CASE(queue_window_stays_bounded) {
+    CommandBlockQueue queue;
+
+    for (size_t i = 0; i < 1000000; ++i) {
+        size_t index = queue.addBlock(CommandBlock(i % 7 == 0));
+        queue.getBlockAtIndex(index)->get().AddCommand(Command("cmd"));
+        queue.deleteBlockByIndex(index);
+
+        BOOST_REQUIRE_LE(queue.Size(), 1u);
+    }
+
+    BOOST_CHECK_EQUAL(queue.getEndIndex(), 1000000u);
+    BOOST_CHECK(queue.isEmpty());
+}
+
+// По умолчанию поток сокращен до ~3 млн команд, чтобы набор выполнялся за
+// секунды; длительный прогон на 100 млн команд - цель CTest commandBlockQueueSoak
+// (опция WITH_SOAK_TESTS) или переменная окружения BULK_SOAK_COMMANDS
+BOOST_AUTO_TEST_CASE(long_stream_memory_is_flat) {
+    SilentCommandManager manager(3);
+    size_t command = 0;
+    size_t commands = 2800000;
+
+    if (const char* soak = std::getenv("BULK_SOAK_COMMANDS")) {
+        commands = std::strtoull(soak, nullptr, 10);
+    }
+
+    // Статические команды вперемешку с динамическими блоками
+    auto feed = [&](size_t rounds) {
+        for (size_t i = 0; i < rounds; ++i) {
+            std::string text = "cmd" + std::to_string(command++);
+            manager.onCommand(text, false);
+
+            if (i % 5 == 0) {
+                manager.onBlockOpen();
+                manager.onCommand(text, true);
+                manager.onCommand(text, true);
+                manager.onBlockClose();
+            }
+        }
+    };
+
+    feed(200000);
+    size_t warm = residentBytes();
+    // Раунд - статическая команда, каждый пятый еще динамический блок из двух команд
+    feed(commands / 7 * 5);
+    size_t soaked = residentBytes();
+    manager.finish();
+
+    // Без освобождения выведенных блоков память растет на десятки мегабайт
+    BOOST_CHECK_LT(soaked, warm + (8u << 20));
+}
+
+BOOST_AUTO_TEST_CASE(active_head_does_not_pin_flushed_blocks) {
+    CommandBlockQueue queue;
+    size_t idle = queue.addBlock(CommandBlock(true));
+    queue.getBlockAtIndex(idle)->get().AddCommand(Command("open"));
+
+    for (size_t i = 0; i < 100000; ++i) {
+        size_t index = queue.addBlock(CommandBlock());
+        queue.getBlockAtIndex(index)->get().AddCommand(Command("cmd"));
+        queue.deleteBlockByIndex(index);
+
+        BOOST_REQUIRE_LE(queue.Size(), 100u);
+    }
+
+    // Перенесенный блок доступен по прежнему индексу и принимает команды
+    BOOST_CHECK_EQUAL(queue.getFirstIndex(), idle);
+    BOOST_REQUIRE(queue.getBlockAtIndex(idle).has_value());
+    queue.getBlockAtIndex(idle)->get().AddCommand(Command("more"));
+    BOOST_CHECK_EQUAL(queue.getBlockAtIndex(idle)->get().getSize(), 2u);
+    BOOST_CHECK_EQUAL(queue.getActiveBlockCount(), 1u);
+
+    // Обход пропускает освобожденные индексы
+    size_t last = queue.addBlock(CommandBlock());
+    BOOST_CHECK_EQUAL(queue.getNextIndex(idle), last);
+    BOOST_CHECK_EQUAL(queue.getNextIndex(last), queue.getEndIndex());
+
+    queue.deleteBlockByIndex(idle);
+    BOOST_CHECK(!queue.getBlockAtIndex(idle).has_value());
+    BOOST_CHECK_EQUAL(queue.getActiveBlockCount(), 1u);
+    BOOST_CHECK_EQUAL(queue.getFirstIndex(), last);
+
+    queue.deleteBlockByIndex(last);
+    BOOST_CHECK(queue.isEmpty());
+}
+
+BOOST_AUTO_TEST_CASE(idle_dynamic_block_keeps_memory_flat) {
+    SilentCommandManager manager(3);
+
+    // Динамический блок другого подключения открыт и больше не получает команд
+    size_t idle = manager.addCommandToBlock(SilentCommandManager::kNewBlock, "idle", true).blockIndex;
+
+    auto feed = [&](size_t commands) {
+        for (size_t i = 0; i < commands; ++i) {
+            manager.onCommand("cmd" + std::to_string(i), false);
+        }
+    };
+
+    feed(300000);
+    size_t warm = residentBytes();
+    feed(3000000);
+    size_t soaked = residentBytes();
+
+    BOOST_CHECK(!manager.isBlockEmpty(idle));
+    BOOST_CHECK_LT(soaked, warm + (8u << 20));
+    manager.finish();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
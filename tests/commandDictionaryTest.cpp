@@ -0,0 +1,26 @@
+#include <memory>
+#include <boost/test/unit_test.hpp>
+#include "../cmdLogger/commandDictionary.h"
+
+BOOST_AUTO_TEST_SUITE(commandDictionary)
+
+// Заполненный словарь находит известные команды, а новым номера не выдает
+BOOST_AUTO_TEST_CASE(full_dictionary_keeps_known_ids) {
+    auto dictionary = std::make_unique<CommandDictionary>(2);
+    auto first = dictionary->intern("dictionary-first");
+    auto second = dictionary->intern("dictionary-second");
+    BOOST_REQUIRE(first.has_value());
+    BOOST_REQUIRE(second.has_value());
+    BOOST_CHECK_NE(*first, *second);
+
+    auto unknown = dictionary->intern("dictionary-third");
+    auto again = dictionary->intern("dictionary-first");
+
+    BOOST_CHECK(!unknown.has_value());
+    BOOST_REQUIRE(again.has_value());
+    BOOST_CHECK_EQUAL(*again, *first);
+    BOOST_CHECK_EQUAL(dictionary->text(*second), "dictionary-second");
+    BOOST_CHECK_EQUAL(dictionary->stats().unique, 2u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,82 @@
+#include <string>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "../cmdLogger/commandManager.h"
+#include "../cmdLogger/metrics.h"
+#include "../cmdLogger/spillFile.h"
+#include "testUtils.h"
+
+BOOST_AUTO_TEST_SUITE(commandManager)
+
+// Много мелких динамических блоков, каждый намного меньше порога блока:
+// общий бюджет все равно соблюдается за счет выгрузки самых крупных
+BOOST_AUTO_TEST_CASE(small_dynamic_blocks_respect_total_budget) {
+    constexpr size_t kBlocks = 200;
+    constexpr size_t kCommands = 100;
+    constexpr size_t kBudget = 64 << 10;
+    const std::string command(31, 'x');
+
+    TempDir dir;
+    LoggerOptions options;
+    options.spillBlock = 64 << 20;
+    options.spillTotal = kBudget;
+    options.spillDir = dir.path();
+
+    SilentCommandManager manager(3, options);
+    std::vector<size_t> blocks(kBlocks, SilentCommandManager::kNewBlock);
+    uint64_t spills = Metrics::instance().spills.get();
+    size_t base = MemoryLease::total();
+
+    for (size_t i = 0; i < kCommands; ++i) {
+        for (auto& block : blocks) {
+            block = manager.addCommandToBlock(block, command, true).blockIndex;
+            BOOST_REQUIRE_LE(MemoryLease::total() - base, kBudget);
+        }
+    }
+
+    BOOST_CHECK_GT(Metrics::instance().spills.get(), spills);
+
+    for (size_t block : blocks) {
+        manager.logBlock(block);
+    }
+
+    BOOST_CHECK_EQUAL(MemoryLease::total(), base);
+}
+
+// Сотни открытых динамических блоков при малом бюджете, почти каждая команда
+// вызывает выгрузку; выгруженный блок держит открытый файл, поэтому блоков
+// меньше ограничения дескрипторов по умолчанию
+BOOST_AUTO_TEST_CASE(many_open_dynamic_blocks_under_small_budget) {
+    constexpr size_t kBlocks = 900;
+    constexpr size_t kCommands = 200;
+    constexpr size_t kBudget = 16 << 10;
+
+    TempDir dir;
+    LoggerOptions options;
+    options.spillTotal = kBudget;
+    options.spillDir = dir.path();
+
+    SilentCommandManager manager(3, options);
+    std::vector<size_t> blocks(kBlocks, SilentCommandManager::kNewBlock);
+    uint64_t spills = Metrics::instance().spills.get();
+    size_t base = MemoryLease::total();
+
+    for (size_t i = 0; i < kCommands; ++i) {
+        for (size_t b = 0; b < kBlocks; ++b) {
+            std::string command = "b" + std::to_string(b) + "c" + std::to_string(i);
+            blocks[b] = manager.addCommandToBlock(blocks[b], command, true).blockIndex;
+            BOOST_REQUIRE_LE(MemoryLease::total() - base, kBudget);
+        }
+    }
+
+    BOOST_CHECK_GT(Metrics::instance().spills.get(), spills);
+
+    for (size_t block : blocks) {
+        BOOST_CHECK(!manager.isBlockEmpty(block));
+        manager.logBlock(block);
+    }
+
+    BOOST_CHECK_EQUAL(MemoryLease::total(), base);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,139 @@
+#include <chrono>
+#include <csignal>
+#include <filesystem>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include <pthread.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <boost/test/unit_test.hpp>
+#include "../cmdServer/commandServer.h"
+#include "testUtils.h"
+
+namespace {
+
+/**
+ * @brief Подключить сокет к Unix-сокету.
+ *
+ * @param fd Сокет.
+ * @param path Путь сокета.
+ * @return bool Возвращает true, если подключение установлено.
+ */
+bool connectUnix(int fd, const std::string& path) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    path.copy(addr.sun_path, sizeof(addr.sun_path) - 1);
+
+    return ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+}
+
+/**
+ * @brief Количество открытых дескрипторов процесса.
+ *
+ * @return size_t Количество записей /proc/self/fd.
+ */
+size_t openDescriptors() {
+    size_t count = 0;
+
+    for (const auto& entry : std::filesystem::directory_iterator("/proc/self/fd")) {
+        (void)entry;
+        ++count;
+    }
+
+    return count;
+}
+
+/**
+ * @brief Процессорное время процесса.
+ *
+ * @return std::chrono::microseconds Сумма пользовательского и системного времени всех потоков.
+ */
+std::chrono::microseconds cpuTime() {
+    rusage usage{};
+    ::getrusage(RUSAGE_SELF, &usage);
+    return std::chrono::seconds(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec)
+        + std::chrono::microseconds(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec);
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(commandServer)
+
+// Дескрипторы исчерпаны, а подключения ждут в очереди сокета: сервер не
+// занимает процессор и принимает их, когда закрываются прежние подключения
+BOOST_AUTO_TEST_CASE(exhausted_descriptors_do_not_spin) {
+    constexpr size_t kClients = 20;
+    constexpr size_t kSpare = 10;
+
+    TempDir dir(true);
+    StdoutCapture capture(dir.path() + "/stdout");
+    std::string path = dir.path() + "/server.sock";
+
+    LoggerOptions options;
+    options.pipeline = true;
+    options.sinks.push_back(SinkOptions());
+
+    std::thread thread([&]() {
+        CommandServer server(1, options, "unix:" + path);
+        server.run();
+    });
+
+    // Сокеты клиентов создаются до ограничения: свободные дескрипторы остаются только серверу
+    std::vector<int> clients;
+
+    for (size_t i = 0; i < kClients; ++i) {
+        clients.push_back(::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0));
+        BOOST_REQUIRE(clients.back() >= 0);
+    }
+
+    // Файл сокета появляется при bind(), подключения принимаются после listen()
+    while (!connectUnix(clients.front(), path)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    rlimit saved{};
+    ::getrlimit(RLIMIT_NOFILE, &saved);
+    rlimit capped = saved;
+    capped.rlim_cur = openDescriptors() + kSpare;
+    ::setrlimit(RLIMIT_NOFILE, &capped);
+
+    // Сервер принимает около kSpare подключений, остальные остаются в очереди сокета
+    for (size_t i = 1; i < kClients; ++i) {
+        BOOST_REQUIRE(connectUnix(clients[i], path));
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    auto before = cpuTime();
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    auto spent = cpuTime() - before;
+
+    BOOST_CHECK_LT(spent.count(), std::chrono::microseconds(std::chrono::milliseconds(100)).count());
+
+    for (size_t i = 0; i < clients.size(); ++i) {
+        std::string command = "client" + std::to_string(i) + "\n";
+        BOOST_REQUIRE_EQUAL(::write(clients[i], command.data(), command.size()), static_cast<ssize_t>(command.size()));
+        ::close(clients[i]);
+    }
+
+    // Все подключения, включая ожидавшие в очереди, обслуживаются
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    ::pthread_kill(thread.native_handle(), SIGTERM);
+    thread.join();
+    ::setrlimit(RLIMIT_NOFILE, &saved);
+
+    std::set<std::string> lines;
+
+    for (const auto& line : capture.restore()) {
+        lines.insert(line);
+    }
+
+    for (size_t i = 0; i < kClients; ++i) {
+        BOOST_CHECK_MESSAGE(lines.count("bulk: client" + std::to_string(i)) == 1, "client " << i << " is not served");
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,144 @@
+#include <fcntl.h>
+#include <fstream>
+#include <random>
+#include <string>
+#include <unistd.h>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "../cmdReader/commandReader.h"
+#include "../cmdReader/fileReplay.h"
+#include "testUtils.h"
+
+namespace {
+
+/**
+ * @brief Сгенерировать поток команд со вложенными блоками и пустыми строками.
+ *
+ * Поток заканчивается незакрытым динамическим блоком.
+ *
+ * @param lines Количество строк.
+ * @param seed Начальное значение генератора.
+ * @return std::string Текст с переводом строки в конце.
+ */
+std::string mixedStream(size_t lines, unsigned seed) {
+    std::mt19937 random(seed);
+    std::string text;
+    size_t depth = 0;
+
+    for (size_t i = 0; i < lines; ++i) {
+        unsigned roll = random() % 100;
+
+        if (roll < 6) {
+            text += "{\n";
+            ++depth;
+        } else if (roll < 12 && depth > 0) {
+            text += "}\n";
+            --depth;
+        } else if (roll < 14) {
+            text += "\n";
+        } else if (roll < 15) {
+            // Лишняя закрывающая скобка вне блока
+            text += "}\n";
+        } else {
+            text += "cmd" + std::to_string(i) + std::string(random() % 40, 'x') + "\n";
+        }
+    }
+
+    return text + "{\nopen1\nopen2\n";
+}
+
+/**
+ * @brief Записать текст в файл.
+ *
+ * @param path Путь.
+ * @param text Текст.
+ */
+void writeFile(const std::string& path, const std::string& text) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << text;
+}
+
+/**
+ * @brief Вывод последовательного чтения файла, как со стандартного ввода.
+ *
+ * @param path Файл команд.
+ * @return std::vector<std::string> Строки консольного вывода.
+ */
+std::vector<std::string> readerOutput(const std::string& path) {
+    StdoutCapture capture(path + ".reader");
+    int fd = ::open(path.c_str(), O_RDONLY);
+    BOOST_REQUIRE(fd >= 0);
+
+    {
+        CommandReader reader(3, LoggerOptions(), fd);
+        reader.execute();
+    }
+
+    ::close(fd);
+    return capture.restore();
+}
+
+/**
+ * @brief Вывод параллельного воспроизведения файла.
+ *
+ * @param path Файл команд.
+ * @param window Размер окна.
+ * @return std::vector<std::string> Строки консольного вывода.
+ */
+std::vector<std::string> replayOutput(const std::string& path, size_t window) {
+    StdoutCapture capture(path + ".replay");
+
+    {
+        FileReplay replay(3, LoggerOptions(), path, 4, window);
+        replay.execute();
+    }
+
+    return capture.restore();
+}
+
+/**
+ * @brief Сравнить вывод воспроизведения с последовательным чтением при разных окнах.
+ *
+ * @param text Текст файла команд.
+ * @param windows Размеры окон.
+ */
+void checkReplay(const std::string& text, const std::vector<size_t>& windows) {
+    TempDir dir(true);
+    std::string path = dir.path() + "/input";
+    writeFile(path, text);
+
+    std::vector<std::string> expected = readerOutput(path);
+    BOOST_REQUIRE(!expected.empty());
+
+    for (size_t window : windows) {
+        BOOST_TEST_CONTEXT("window " << window) {
+            BOOST_CHECK(replayOutput(path, window) == expected);
+        }
+    }
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(fileReplay)
+
+// Окна от одной строки до значения по умолчанию: границы окон попадают
+// внутрь статических, динамических и вложенных блоков
+BOOST_AUTO_TEST_CASE(replay_matches_sequential_reading) {
+    checkReplay(mixedStream(2000, 1), {1, 37, 4096});
+    checkReplay(mixedStream(40000, 2), {4096, 200000, FileReplay::kWindowSize});
+}
+
+BOOST_AUTO_TEST_CASE(missing_trailing_newline) {
+    std::string text = mixedStream(2000, 3);
+    checkReplay(text + "last", {1, 37, 4096, FileReplay::kWindowSize});
+    checkReplay(text + "}\nlast", {1, 37, FileReplay::kWindowSize});
+}
+
+BOOST_AUTO_TEST_CASE(open_and_closed_blocks_at_eof) {
+    std::string text = mixedStream(2000, 4);
+    checkReplay(text + "}\n}\n{", {1, 37, FileReplay::kWindowSize});
+    checkReplay(text + "}", {1, 37, FileReplay::kWindowSize});
+    checkReplay("a\nb\n{\nc\n{\nd\n}\ne\n}", {1, 2, 3, FileReplay::kWindowSize});
+}
+
+BOOST_AUTO_TEST_SUITE_END()
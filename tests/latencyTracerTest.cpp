@@ -0,0 +1,77 @@
+#include <sstream>
+#include <string>
+#include <thread>
+#include <boost/test/unit_test.hpp>
+#include "../cmdLogger/commandBlock.h"
+#include "../cmdLogger/latencyTracer.h"
+
+namespace {
+
+/**
+ * @brief Выгрузить отметки трассировки в строку.
+ *
+ * @return std::string Трассы в формате Chrome trace event.
+ */
+std::string chromeTrace() {
+    std::ostringstream os;
+    LatencyTracer::instance().writeChromeTrace(os);
+    return os.str();
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(latencyTracer)
+
+// Выбирается каждая K-я команда потока, в том числе команды уже трассируемого блока:
+// после шести команд первого блока восьмая команда выбирается во втором
+BOOST_AUTO_TEST_CASE(every_command_is_counted) {
+    LatencyTracer::instance().enable(4);
+    uint64_t first = 0;
+    uint64_t second = 0;
+
+    // Счетчик команд у каждого потока свой, новый поток начинает с нуля
+    std::thread([&first, &second]() {
+        CommandBlock a;
+        CommandBlock b;
+
+        for (size_t i = 0; i < 6; ++i) {
+            a.AddCommand<FixedClock>(Command("a" + std::to_string(i)));
+        }
+
+        for (size_t i = 0; i < 2; ++i) {
+            b.AddCommand<FixedClock>(Command("b" + std::to_string(i)));
+        }
+
+        first = a.getTraceId();
+        second = b.getTraceId();
+    }).join();
+
+    LatencyTracer::instance().enable(0);
+    BOOST_CHECK_NE(first, 0u);
+    BOOST_CHECK_NE(second, 0u);
+    BOOST_CHECK_NE(first, second);
+}
+
+// Заполненный буфер потока перезаписывает самые старые отметки
+BOOST_AUTO_TEST_CASE(full_buffer_keeps_latest_events) {
+    constexpr uint64_t kBase = 1000000000;
+    constexpr size_t kExtra = 10;
+    constexpr uint64_t kTraces = LatencyTracer::kBufferEvents / 2 + kExtra;
+
+    std::thread([]() {
+        for (uint64_t trace = kBase; trace < kBase + kTraces; ++trace) {
+            LatencyTracer::instance().record(trace, LatencyTracer::Stage::Read);
+            LatencyTracer::instance().record(trace, LatencyTracer::Stage::Close);
+        }
+    }).join();
+
+    std::string trace = chromeTrace();
+
+    BOOST_CHECK(trace.find("\"dropped_events\":" + std::to_string(kExtra * 2) + "}") != std::string::npos);
+    BOOST_CHECK(trace.find("\"trace\":" + std::to_string(kBase) + "}") == std::string::npos);
+    BOOST_CHECK(trace.find("\"trace\":" + std::to_string(kBase + kExtra - 1) + "}") == std::string::npos);
+    BOOST_CHECK(trace.find("\"trace\":" + std::to_string(kBase + kExtra) + "}") != std::string::npos);
+    BOOST_CHECK(trace.find("\"trace\":" + std::to_string(kBase + kTraces - 1) + "}") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,88 @@
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "../cmdReader/lineScanner.h"
+
+namespace {
+
+/**
+ * @brief Найти переводы строк побайтно.
+ *
+ * @param data Данные.
+ * @param size Размер данных.
+ * @return std::vector<uint32_t> Смещения переводов строк.
+ */
+std::vector<uint32_t> referenceNewlines(const char* data, size_t size) {
+    std::vector<uint32_t> result;
+
+    for (size_t i = 0; i < size; ++i) {
+        if (data[i] == '\n') {
+            result.push_back(static_cast<uint32_t>(i));
+        }
+    }
+
+    return result;
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(lineScanner)
+
+// Каждое поддерживаемое процессором ядро находит те же переводы строк, что
+// и побайтный поиск, при любой длине, выравнивании и плотности переводов строк
+BOOST_AUTO_TEST_CASE(kernels_match_reference) {
+    const std::string original = LineScanner::kernelName();
+    std::mt19937 random(7);
+    std::string buffer(LineScanner::kSliceSize + 64, '\0');
+    std::vector<uint32_t> found(LineScanner::kSliceSize);
+
+    for (const char* kernel : {"scalar", "sse2", "avx2"}) {
+        if (!LineScanner::setKernel(kernel)) {
+            BOOST_TEST_MESSAGE(kernel << " kernel is unsupported, skipped");
+            continue;
+        }
+
+        BOOST_TEST_CONTEXT("kernel " << kernel) {
+            for (unsigned density : {0u, 1u, 8u, 64u, 100u}) {
+                for (size_t i = 0; i < buffer.size(); ++i) {
+                    // Байты выше 0x7f проверяют знаковое сравнение в векторных ядрах
+                    buffer[i] = random() % 100 < density ? '\n' : static_cast<char>(random() % 256);
+                }
+
+                for (size_t offset = 0; offset < 64; offset += 5) {
+                    for (size_t size : {size_t(0), size_t(1), size_t(15), size_t(16), size_t(17), size_t(31),
+                                        size_t(63), size_t(64), size_t(65), size_t(1000), LineScanner::kSliceSize}) {
+                        const char* data = buffer.data() + offset;
+                        size_t count = LineScanner::findNewlines(data, size, found.data());
+                        std::vector<uint32_t> expected = referenceNewlines(data, size);
+
+                        BOOST_REQUIRE_EQUAL(count, expected.size());
+                        BOOST_REQUIRE(std::equal(expected.begin(), expected.end(), found.begin()));
+                    }
+                }
+            }
+        }
+    }
+
+    LineScanner::setKernel(original);
+}
+
+BOOST_AUTO_TEST_CASE(lines_are_split_like_getline) {
+    std::string text = "a\n\n{\nbb\n}\nunfinished";
+    std::vector<std::string> lines;
+
+    size_t rest = LineScanner::forEachLine(text.data(), text.size(), [&lines](std::string_view line) {
+        lines.emplace_back(line);
+    });
+
+    BOOST_CHECK((lines == std::vector<std::string>{"a", "", "{", "bb", "}"}));
+    BOOST_CHECK_EQUAL(text.substr(rest), "unfinished");
+    BOOST_CHECK(LineScanner::classify("{", 1) == LineKind::Open);
+    BOOST_CHECK(LineScanner::classify("}", 1) == LineKind::Close);
+    BOOST_CHECK(LineScanner::classify("", 0) == LineKind::Break);
+    BOOST_CHECK(LineScanner::classify("{}", 2) == LineKind::Command);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
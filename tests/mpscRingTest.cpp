@@ -0,0 +1,161 @@
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "../cmdLogger/mpscRing.h"
+
+namespace {
+
+constexpr size_t kProducers = 8;
+constexpr uint64_t kItems = 50000;
+
+/**
+ * @brief Элемент очереди: номер производителя в старших разрядах, порядковый номер - в младших.
+ *
+ * @param producer Номер производителя.
+ * @param number Порядковый номер элемента у производителя.
+ * @return uint64_t Элемент.
+ */
+uint64_t item(size_t producer, uint64_t number) {
+    return (static_cast<uint64_t>(producer) << 32) | number;
+}
+
+/**
+ * @brief Итог работы потребителя.
+ */
+struct Received {
+    std::vector<uint64_t> next = std::vector<uint64_t>(kProducers, 0); /**< Следующий ожидаемый номер каждого производителя. */
+    uint64_t total = 0; /**< Количество полученных элементов. */
+    bool ordered = true; /**< Элементы каждого производителя пришли по порядку. */
+};
+
+/**
+ * @brief Запустить производителей, забрать все элементы и закрыть очередь.
+ *
+ * Номера каждого производителя должны приходить строго по возрастанию:
+ * так видны и потеря, и повтор, и перестановка элементов. При отбрасывании
+ * элементов номера могут пропускаться, но не повторяться.
+ *
+ * @param ring Очередь.
+ * @param pushed Количество принятых очередью элементов каждого производителя.
+ * @return Received Итог потребителя.
+ */
+Received run(MpscRing<uint64_t>& ring, std::vector<uint64_t>& pushed) {
+    std::vector<std::thread> producers;
+    pushed.assign(kProducers, 0);
+
+    for (size_t p = 0; p < kProducers; ++p) {
+        producers.emplace_back([&ring, &pushed, p]() {
+            for (uint64_t i = 0; i < kItems; ++i) {
+                if (ring.push(item(p, i))) {
+                    ++pushed[p];
+                }
+            }
+        });
+    }
+
+    std::thread closer([&producers, &ring]() {
+        for (auto& producer : producers) {
+            producer.join();
+        }
+
+        ring.close();
+    });
+
+    Received received;
+    std::vector<uint64_t> batch;
+
+    while (ring.popBatch(batch, 128) > 0) {
+        for (uint64_t value : batch) {
+            size_t producer = value >> 32;
+            uint64_t number = value & 0xffffffffu;
+
+            if (producer >= kProducers || number < received.next[producer]) {
+                received.ordered = false;
+            } else {
+                received.next[producer] = number + 1;
+            }
+
+            ++received.total;
+        }
+
+        batch.clear();
+    }
+
+    closer.join();
+    return received;
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(mpscRing)
+
+// Маленькая емкость заставляет производителей засыпать на заполненной очереди
+BOOST_AUTO_TEST_CASE(block_policy_keeps_every_item_in_order) {
+    MpscRing<uint64_t> ring(64, FullPolicy::Block);
+    std::vector<uint64_t> pushed;
+    Received received = run(ring, pushed);
+
+    BOOST_CHECK(received.ordered);
+    BOOST_CHECK_EQUAL(received.total, kProducers * kItems);
+
+    for (size_t p = 0; p < kProducers; ++p) {
+        BOOST_CHECK_EQUAL(pushed[p], kItems);
+        BOOST_CHECK_EQUAL(received.next[p], kItems);
+    }
+
+    BOOST_CHECK_EQUAL(ring.dropped(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(spin_policy_keeps_every_item_in_order) {
+    MpscRing<uint64_t> ring(64, FullPolicy::Spin);
+    std::vector<uint64_t> pushed;
+    Received received = run(ring, pushed);
+
+    BOOST_CHECK(received.ordered);
+    BOOST_CHECK_EQUAL(received.total, kProducers * kItems);
+
+    for (size_t p = 0; p < kProducers; ++p) {
+        BOOST_CHECK_EQUAL(received.next[p], kItems);
+    }
+}
+
+// Отброшенные элементы учитываются, принятые доходят ровно один раз и по порядку
+BOOST_AUTO_TEST_CASE(drop_policy_accounts_for_every_item) {
+    MpscRing<uint64_t> ring(16, FullPolicy::Drop);
+    std::vector<uint64_t> pushed;
+    Received received = run(ring, pushed);
+
+    uint64_t accepted = 0;
+
+    for (uint64_t count : pushed) {
+        accepted += count;
+    }
+
+    BOOST_CHECK(received.ordered);
+    BOOST_CHECK_EQUAL(received.total, accepted);
+    BOOST_CHECK_EQUAL(accepted + ring.dropped(), kProducers * kItems);
+}
+
+BOOST_AUTO_TEST_CASE(push_after_close_is_rejected) {
+    MpscRing<uint64_t> ring(4);
+    BOOST_CHECK(ring.push(1));
+    ring.close();
+    BOOST_CHECK(!ring.push(2));
+
+    std::vector<uint64_t> batch;
+    BOOST_CHECK_EQUAL(ring.popBatch(batch, 16), 1u);
+    BOOST_CHECK_EQUAL(ring.popBatch(batch, 16), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(pop_until_deadline_returns_on_timeout) {
+    MpscRing<uint64_t> ring(4);
+    std::vector<uint64_t> batch;
+    auto start = std::chrono::steady_clock::now();
+
+    BOOST_CHECK_EQUAL(ring.popBatchUntil(batch, 16, start + std::chrono::milliseconds(20)), 0u);
+    BOOST_CHECK(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(20));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
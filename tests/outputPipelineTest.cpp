@@ -0,0 +1,262 @@
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <boost/test/unit_test.hpp>
+#include "../cmdLogger/commandBlock.h"
+#include "../cmdLogger/outputPipeline.h"
+#include "../cmdReader/programOptions.h"
+#include "testUtils.h"
+
+namespace {
+
+/**
+ * @brief Записанные приемником пачки, по тексту первого блока.
+ */
+struct Written {
+    std::mutex mutex; /**< Блокировка списка. */
+    std::vector<std::string> bulks; /**< Тексты пачек в порядке записи. */
+};
+
+/**
+ * @brief Класс TestSink запоминает пачки и отказывает в записи по заданным правилам.
+ */
+class TestSink final : public BulkSink {
+public:
+    /**
+     * @brief Конструктор TestSink.
+     *
+     * @param written Список записанных пачек.
+     * @param fail_prefix Пачки, текст которых начинается с префикса, не записываются; пустой - записываются все.
+     * @param fail_submit Отказывать в передаче отложенных записей.
+     */
+    explicit TestSink(Written& written, std::string fail_prefix = "", bool fail_submit = false)
+        : written_(written), fail_prefix_(std::move(fail_prefix)), fail_submit_(fail_submit) {}
+
+    void write(const Bulk& bulk) override {
+        std::string text(bulk.front().getBytes());
+
+        if (!fail_prefix_.empty() && text.compare(0, fail_prefix_.size(), fail_prefix_) == 0) {
+            throw std::runtime_error("injected write failure");
+        }
+
+        std::lock_guard<std::mutex> lock(written_.mutex);
+        written_.bulks.push_back(text);
+    }
+
+    void submit() override {
+        if (fail_submit_) {
+            throw std::runtime_error("injected submit failure");
+        }
+    }
+
+private:
+    Written& written_; /**< Список записанных пачек. */
+    std::string fail_prefix_; /**< Префикс текста пачек, запись которых завершается ошибкой. */
+    bool fail_submit_; /**< Отказывать в передаче отложенных записей. */
+};
+
+/**
+ * @brief Пачка из одного блока с одной командой.
+ *
+ * @param command Команда.
+ * @return Bulk Пачка.
+ */
+Bulk makeBulk(const std::string& command) {
+    CommandBlock block;
+    block.AddCommand<FixedClock>(Command(command));
+    Bulk bulk;
+    bulk.push_back(std::move(block));
+    return bulk;
+}
+
+/**
+ * @brief Вывести пачки при гарантии сохранности и отказе хранилища в записи части из них.
+ *
+ * @param options Настройки вывода.
+ * @return std::vector<std::string> Пачки, выведенные в консоль.
+ */
+std::vector<std::string> consoleAfterWriteFailure(const LoggerOptions& options) {
+    Written console;
+    Written store;
+
+    {
+        OutputPipeline pipeline(options, std::make_unique<TestSink>(console), std::make_unique<TestSink>(store, "bad"));
+
+        for (const char* command : {"good1", "bad1", "good2", "bad2", "good3"}) {
+            pipeline.submit(makeBulk(command));
+        }
+
+        BOOST_CHECK_THROW(pipeline.drain(), std::runtime_error);
+    }
+
+    BOOST_CHECK_EQUAL(store.bulks.size(), 3u);
+    return console.bulks;
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(outputPipeline)
+
+// Пачка, не сохраненная в хранилище, не подтверждается в консоли
+BOOST_AUTO_TEST_CASE(group_durability_skips_unsaved_bulks) {
+    LoggerOptions options;
+    options.durability = Durability::Group;
+    std::vector<std::string> console = consoleAfterWriteFailure(options);
+
+    BOOST_CHECK_EQUAL(console.size(), 3u);
+
+    for (const auto& text : console) {
+        BOOST_CHECK_EQUAL(text.compare(0, 4, "good"), 0);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(block_durability_skips_unsaved_bulks) {
+    LoggerOptions options;
+    options.pipeline = true;
+    options.durability = Durability::Block;
+    std::vector<std::string> console = consoleAfterWriteFailure(options);
+
+    BOOST_CHECK_EQUAL(console.size(), 3u);
+
+    for (const auto& text : console) {
+        BOOST_CHECK_EQUAL(text.compare(0, 4, "good"), 0);
+    }
+}
+
+// При сжатии пачки записывает пул потоков, поток фиксации только ждет их записи
+BOOST_AUTO_TEST_CASE(pooled_writes_skip_unsaved_bulks) {
+    for (Durability durability : {Durability::Group, Durability::Block}) {
+        LoggerOptions options;
+        options.pipeline = true;
+        options.durability = durability;
+        options.compression = Compression::Zlib;
+        options.fileThreads = 3;
+        std::vector<std::string> console = consoleAfterWriteFailure(options);
+
+        BOOST_CHECK((console == std::vector<std::string>{"good1\n", "good2\n", "good3\n"}));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(pooled_writes_keep_console_order) {
+    Written console;
+    Written store;
+    LoggerOptions options;
+    options.durability = Durability::Group;
+    options.compression = Compression::Zlib;
+    options.fileThreads = 4;
+    std::vector<std::string> expected;
+
+    {
+        OutputPipeline pipeline(options, std::make_unique<TestSink>(console), std::make_unique<TestSink>(store));
+
+        for (size_t i = 0; i < 1000; ++i) {
+            expected.push_back("bulk" + std::to_string(i) + "\n");
+            pipeline.submit(makeBulk("bulk" + std::to_string(i)));
+        }
+
+        pipeline.drain();
+    }
+
+    BOOST_CHECK(console.bulks == expected);
+    BOOST_CHECK_EQUAL(store.bulks.size(), expected.size());
+}
+
+// Если отложенные записи окна не переданы хранилищу, окно не подтверждается
+BOOST_AUTO_TEST_CASE(failed_submit_fails_the_window) {
+    Written console;
+    Written store;
+    LoggerOptions options;
+    options.durability = Durability::Group;
+
+    {
+        OutputPipeline pipeline(options, std::make_unique<TestSink>(console), std::make_unique<TestSink>(store, "", true));
+
+        for (const char* command : {"a", "b", "c"}) {
+            pipeline.submit(makeBulk(command));
+        }
+
+        BOOST_CHECK_THROW(pipeline.drain(), std::runtime_error);
+    }
+
+    BOOST_CHECK(console.bulks.empty());
+}
+
+// Консоль никто не читает: при настройках --sink по умолчанию очередь консоли
+// вытесняет старые пачки, а хранилище сохраняет все
+BOOST_AUTO_TEST_CASE(stalled_console_does_not_stall_store) {
+    constexpr size_t kBulks = 5000;
+
+    TempDir dir;
+    std::string segment_dir = "--segment-dir=" + dir.path();
+    const char* argv[] = {"bulk", "1", "--sink", "stdout,queue=4", "--sink", "store", segment_dir.c_str()};
+    ProgramOptions options = parseProgramOptions(7, const_cast<char**>(argv));
+
+    // Вывод в канал, который не читается, пока пачки передаются
+    int pipe_fds[2];
+    BOOST_REQUIRE_EQUAL(::pipe(pipe_fds), 0);
+    int saved = ::dup(STDOUT_FILENO);
+    ::dup2(pipe_fds[1], STDOUT_FILENO);
+    ::close(pipe_fds[1]);
+
+    std::atomic<bool> submitted{false};
+    std::thread reader;
+
+    {
+        OutputPipeline pipeline(options.logger);
+        std::thread submitter([&]() {
+            for (size_t i = 0; i < kBulks; ++i) {
+                pipeline.submit(makeBulk("stalled" + std::to_string(i)));
+            }
+
+            submitted = true;
+        });
+
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+
+        while (!submitted && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+
+        bool in_time = submitted;
+
+        // Канал начинает читаться, чтобы консоль завершилась; сообщения
+        // теста тоже идут в стандартный вывод, поэтому проверка после этого
+        reader = std::thread([fd = pipe_fds[0]]() {
+            char buffer[4096];
+
+            while (::read(fd, buffer, sizeof(buffer)) > 0) {
+            }
+        });
+
+        BOOST_CHECK(in_time);
+        submitter.join();
+        pipeline.drain();
+    }
+
+    ::dup2(saved, STDOUT_FILENO);
+    ::close(saved);
+    reader.join();
+    ::close(pipe_fds[0]);
+
+    std::set<std::string> stored;
+
+    for (const auto& entry : std::filesystem::directory_iterator(dir.path())) {
+        std::string text = readFile(entry.path().string());
+
+        for (size_t begin = text.find("\nstalled"); begin != std::string::npos; begin = text.find("\nstalled", begin + 1)) {
+            stored.insert(text.substr(begin + 1, text.find('\n', begin + 1) - begin - 1));
+        }
+    }
+
+    BOOST_CHECK_EQUAL(stored.size(), kBulks);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,4 @@
+#define BOOST_TEST_MODULE bulk_tests
+#include <boost/test/unit_test.hpp>
+
+// Точка входа модульных тестов: наборы тестов находятся в остальных файлах каталога
@@ -0,0 +1,140 @@
+#pragma once
+#include <cstdlib>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <system_error>
+#include <unistd.h>
+#include <vector>
+
+/**
+ * @brief Класс TempDir - временный каталог теста, удаляемый вместе с содержимым.
+ *
+ * Если задан переход в каталог, он становится текущим, а прежний текущий
+ * каталог восстанавливается при уничтожении: хранилища пишут файлы блоков
+ * в текущий каталог.
+ */
+class TempDir {
+public:
+    /**
+     * @brief Конструктор TempDir создает каталог в /tmp.
+     *
+     * @param enter Сделать каталог текущим.
+     */
+    explicit TempDir(bool enter = false) {
+        char pattern[] = "/tmp/bulk_test.XXXXXX";
+
+        if (!::mkdtemp(pattern)) {
+            throw std::system_error(errno, std::generic_category(), "mkdtemp");
+        }
+
+        path_ = pattern;
+
+        if (enter) {
+            previous_ = std::filesystem::current_path();
+            std::filesystem::current_path(path_);
+        }
+    }
+
+    // Запрещаем копирование и присваивание
+    TempDir(const TempDir&) = delete;
+    TempDir& operator=(const TempDir&) = delete;
+
+    ~TempDir() {
+        std::error_code error;
+
+        if (!previous_.empty()) {
+            std::filesystem::current_path(previous_, error);
+        }
+
+        std::filesystem::remove_all(path_, error);
+    }
+
+    /**
+     * @brief Получить путь к каталогу.
+     *
+     * @return const std::string& Путь.
+     */
+    const std::string& path() const {
+        return path_;
+    }
+
+private:
+    std::string path_; /**< Путь к каталогу. */
+    std::filesystem::path previous_; /**< Прежний текущий каталог. */
+};
+
+/**
+ * @brief Прочитать файл целиком.
+ *
+ * @param path Путь к файлу.
+ * @return std::string Содержимое файла.
+ */
+inline std::string readFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+/**
+ * @brief Класс StdoutCapture перенаправляет стандартный вывод в файл.
+ *
+ * Консольный вывод пишется прямо в дескриптор 1, поэтому перехватывается
+ * подменой дескриптора; прежний вывод восстанавливается методом restore()
+ * или при уничтожении.
+ */
+class StdoutCapture {
+public:
+    /**
+     * @brief Конструктор StdoutCapture.
+     *
+     * @param path Файл, куда пишется вывод.
+     */
+    explicit StdoutCapture(const std::string& path) : path_(path) {
+        int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        saved_ = ::dup(STDOUT_FILENO);
+        ::dup2(fd, STDOUT_FILENO);
+        ::close(fd);
+    }
+
+    // Запрещаем копирование и присваивание
+    StdoutCapture(const StdoutCapture&) = delete;
+    StdoutCapture& operator=(const StdoutCapture&) = delete;
+
+    ~StdoutCapture() {
+        restore();
+    }
+
+    /**
+     * @brief Вернуть прежний вывод и прочитать перехваченный.
+     *
+     * @return std::vector<std::string> Строки вывода.
+     */
+    std::vector<std::string> restore() {
+        std::vector<std::string> lines;
+
+        if (saved_ < 0) {
+            return lines;
+        }
+
+        ::dup2(saved_, STDOUT_FILENO);
+        ::close(saved_);
+        saved_ = -1;
+
+        std::string text = readFile(path_);
+
+        for (size_t begin = 0; begin < text.size();) {
+            size_t end = text.find('\n', begin);
+            end = end == std::string::npos ? text.size() : end;
+            lines.push_back(text.substr(begin, end - begin));
+            begin = end + 1;
+        }
+
+        return lines;
+    }
+
+private:
+    std::string path_; /**< Файл вывода. */
+    int saved_; /**< Копия прежнего дескриптора 1. */
+};
@@ -0,0 +1,65 @@
+#include <cstring>
+#include <string>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "../cmdLogger/timeIndex.h"
+#include "testUtils.h"
+
+namespace {
+
+/**
+ * @brief Добавить в индекс файлы отдельных блоков с заданным временем.
+ *
+ * @param dir Каталог хранилища.
+ * @param times Время начала блоков в порядке сохранения.
+ */
+void addBlocks(const std::string& dir, const std::vector<int64_t>& times) {
+    TimeIndex index(dir);
+
+    for (int64_t ts : times) {
+        TimeIndex::Entry part;
+        part.minTs = ts;
+        part.maxTs = ts;
+        part.fileTs = ts;
+        part.blocks = 1;
+        index.add(part);
+    }
+}
+
+/**
+ * @brief Прочитать границы записей индекса.
+ *
+ * @param dir Каталог хранилища.
+ * @return std::vector<int64_t> Значения TimeIndex::horizon() по порядку записей.
+ */
+std::vector<int64_t> horizons(const std::string& dir) {
+    std::string bytes = readFile(dir + "/" + TimeIndex::kFileName);
+    std::vector<int64_t> result;
+
+    for (size_t offset = sizeof(TimeIndex::Header); offset + sizeof(TimeIndex::Entry) <= bytes.size();
+         offset += sizeof(TimeIndex::Entry)) {
+        TimeIndex::Entry entry;
+        std::memcpy(&entry, bytes.data() + offset, sizeof(entry));
+        result.push_back(TimeIndex::horizon(entry));
+    }
+
+    return result;
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(timeIndex)
+
+// Долгий динамический блок сохраняется после более новых: граница записей
+// все равно не убывает, в том числе после повторного открытия индекса
+BOOST_AUTO_TEST_CASE(horizon_never_decreases) {
+    TempDir dir;
+
+    addBlocks(dir.path(), {100, 101, 50, 102});
+    BOOST_CHECK((horizons(dir.path()) == std::vector<int64_t>{100, 101, 101, 102}));
+
+    addBlocks(dir.path(), {40, 103});
+    BOOST_CHECK((horizons(dir.path()) == std::vector<int64_t>{100, 101, 101, 102, 102, 103}));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,89 @@
+#include <fcntl.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "../cmdLogger/uringWriter.h"
+#include "testUtils.h"
+
+namespace {
+
+/**
+ * @brief Текст заданной длины, по которому видно смещение каждого байта.
+ *
+ * @param size Длина.
+ * @param seed Начальное значение.
+ * @return std::string Текст.
+ */
+std::string pattern(size_t size, size_t seed) {
+    std::string text(size, '\0');
+
+    for (size_t i = 0; i < size; ++i) {
+        text[i] = static_cast<char>('a' + (i * 7 + seed) % 26);
+    }
+
+    return text;
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(uringWriter)
+
+// Маленький предел операции превращает каждую запись в цепочку продолжений,
+// как после коротких записей: файл должен совпасть целиком и закрыться в конце
+BOOST_AUTO_TEST_CASE(writes_are_continued_until_complete) {
+    auto uring = UringWriter::tryCreate(4, 4096);
+
+    if (!uring) {
+        BOOST_TEST_MESSAGE("io_uring is unavailable, test skipped");
+        return;
+    }
+
+    TempDir dir;
+    std::vector<std::string> heads;
+    std::vector<std::string> bodies;
+
+    for (size_t i = 0; i < 8; ++i) {
+        heads.push_back(pattern(100 + i, i));
+        bodies.push_back(pattern((1 << 20) + 123 * i, i + 1));
+    }
+
+    for (size_t i = 0; i < heads.size(); ++i) {
+        std::string path = dir.path() + "/file" + std::to_string(i);
+        int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        BOOST_REQUIRE(fd >= 0);
+        uring->write(fd, 0, heads[i], bodies[i], true);
+    }
+
+    uring->waitAll();
+    BOOST_CHECK(uring->idle());
+
+    for (size_t i = 0; i < heads.size(); ++i) {
+        BOOST_CHECK(readFile(dir.path() + "/file" + std::to_string(i)) == heads[i] + bodies[i]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(sync_waits_for_continued_writes) {
+    auto uring = UringWriter::tryCreate(2, 1000);
+
+    if (!uring) {
+        BOOST_TEST_MESSAGE("io_uring is unavailable, test skipped");
+        return;
+    }
+
+    TempDir dir;
+    std::string path = dir.path() + "/file";
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    BOOST_REQUIRE(fd >= 0);
+
+    std::string first = pattern(300000, 1);
+    std::string second = pattern(200000, 2);
+    uring->write(fd, 0, first, "");
+    uring->write(fd, static_cast<off_t>(first.size()), "", second);
+    uring->sync(fd);
+    ::close(fd);
+
+    BOOST_CHECK(readFile(path) == first + second);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,196 @@
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <zlib.h>
+
+// Потоковая распаковка сжатого вывода bulk (--compress): файлов блоков
+// bulk<время>.log.gz и сегментов bulk<время>-<номер>.seg.gz. Каждый член gzip
+// распаковывается по порядку, результат - тот же текст, что bulk записал бы
+// без сжатия. Несжатые файлы выводятся без изменений, нулевые байты
+// предварительно выделенного хвоста сегмента пропускаются.
+
+namespace {
+
+constexpr size_t kBufferSize = 64 * 1024; /**< Размер буферов чтения и записи. */
+
+void throwSystemError(const std::string& what) {
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+void writeAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t written = ::write(fd, data, size);
+
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            throwSystemError("write");
+        }
+
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+}
+
+/**
+ * @brief Класс GzipStreamReader - распаковка последовательности членов gzip.
+ */
+class GzipStreamReader {
+public:
+    GzipStreamReader() {
+        if (inflateInit2(&stream_, 16 + MAX_WBITS) != Z_OK) {
+            throw std::runtime_error("Unable to initialize zlib");
+        }
+    }
+
+    ~GzipStreamReader() {
+        inflateEnd(&stream_);
+    }
+
+    // Запрещаем копирование и присваивание
+    GzipStreamReader(const GzipStreamReader&) = delete;
+    GzipStreamReader& operator=(const GzipStreamReader&) = delete;
+
+    /**
+     * @brief Распаковать файл в стандартный вывод.
+     *
+     * @param fd Дескриптор файла.
+     * @param name Имя файла для сообщений об ошибках.
+     * @throws std::runtime_error Если файл поврежден или обрывается внутри члена gzip.
+     */
+    void copy(int fd, const std::string& name) {
+        std::vector<char> input(kBufferSize);
+        std::vector<char> output(kBufferSize);
+        bool first = true;
+        bool plain = false;
+        bool in_member = false;
+
+        for (;;) {
+            ssize_t size = ::read(fd, input.data(), input.size());
+
+            if (size < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+
+                throwSystemError("read " + name);
+            }
+
+            if (size == 0) {
+                break;
+            }
+
+            std::string_view chunk(input.data(), static_cast<size_t>(size));
+
+            // Файл без сигнатуры gzip выводится как есть
+            if (first) {
+                first = false;
+                plain = chunk.size() < 2 || static_cast<unsigned char>(chunk[0]) != 0x1f
+                    || static_cast<unsigned char>(chunk[1]) != 0x8b;
+            }
+
+            if (plain) {
+                writeAll(STDOUT_FILENO, chunk.data(), chunk.size());
+                continue;
+            }
+
+            while (!chunk.empty()) {
+                if (!in_member) {
+                    // Между членами и после последнего может быть нулевой хвост сегмента
+                    size_t start = chunk.find_first_not_of('\0');
+
+                    if (start == std::string_view::npos) {
+                        break;
+                    }
+
+                    chunk.remove_prefix(start);
+                    in_member = true;
+                }
+
+                stream_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(chunk.data()));
+                stream_.avail_in = static_cast<uInt>(chunk.size());
+                int rc = Z_OK;
+
+                do {
+                    stream_.next_out = reinterpret_cast<Bytef*>(output.data());
+                    stream_.avail_out = static_cast<uInt>(output.size());
+                    rc = inflate(&stream_, Z_NO_FLUSH);
+
+                    if (rc != Z_OK && rc != Z_STREAM_END && rc != Z_BUF_ERROR) {
+                        throw std::runtime_error(name + ": corrupted gzip data"
+                                                 + (stream_.msg ? std::string(" (") + stream_.msg + ")" : ""));
+                    }
+
+                    writeAll(STDOUT_FILENO, output.data(), output.size() - stream_.avail_out);
+                } while (stream_.avail_out == 0 && rc != Z_STREAM_END);
+
+                chunk.remove_prefix(chunk.size() - stream_.avail_in);
+
+                if (rc == Z_STREAM_END) {
+                    inflateReset(&stream_);
+                    in_member = false;
+                }
+            }
+        }
+
+        if (in_member) {
+            throw std::runtime_error(name + ": unexpected end of gzip data");
+        }
+    }
+
+private:
+    z_stream stream_{}; /**< Поток zlib. */
+};
+
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> files(argv + 1, argv + argc);
+
+    if (files.empty()) {
+        files.push_back("-");
+    }
+
+    for (const auto& file : files) {
+        if (file.size() > 1 && file[0] == '-') {
+            std::cerr << "Ошибка: Неизвестный параметр: " << file << "\n"
+                      << "Использование: bulk_cat [FILE...]\n";
+            return 1;
+        }
+    }
+
+    int status = 0;
+
+    for (const auto& file : files) {
+        int fd = file == "-" ? STDIN_FILENO : ::open(file.c_str(), O_RDONLY | O_CLOEXEC);
+
+        if (fd < 0) {
+            std::cerr << "Ошибка: Unable to open " << file << ": " << std::strerror(errno) << std::endl;
+            status = 1;
+            continue;
+        }
+
+        try {
+            GzipStreamReader reader;
+            reader.copy(fd, file);
+        } catch (const std::exception& e) {
+            std::cerr << "Ошибка: " << e.what() << std::endl;
+            status = 1;
+        }
+
+        if (fd != STDIN_FILENO) {
+            ::close(fd);
+        }
+    }
+
+    return status;
+}
@@ -0,0 +1,672 @@
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "../cmdLogger/metrics.h"
+
+// Генератор нагрузки для bulk: формирует поток команд с заданными темпом,
+// распределением длины команд, долей и вложенностью динамических блоков
+// и пачками отправки. Поток передается на стандартный ввод дочернего bulk,
+// в файл или в сокет сервера bulk --listen. Для дочернего bulk по его
+// консольному выводу измеряется сквозная задержка каждой команды.
+
+namespace {
+
+constexpr size_t kWriteSize = 64 << 10; /**< Размер записи при отправке без ограничения темпа. */
+
+/**
+ * @brief Распределение длины команд.
+ */
+enum class LengthDistribution {
+    Fixed,       /**< Все команды одной длины. */
+    Uniform,     /**< Равномерное на [1, 2 * length - 1]. */
+    Exponential  /**< Экспоненциальное со средним length. */
+};
+
+/**
+ * @brief Параметры генератора.
+ */
+struct LoadgenOptions {
+    size_t commands = 1000000; /**< Количество команд. */
+    double rate = 0; /**< Темп, команд/с; 0 - без ограничения. */
+    size_t burst = 1; /**< Команд в одной пачке отправки. */
+    size_t length = 16; /**< Средняя длина команды. */
+    LengthDistribution distribution = LengthDistribution::Fixed; /**< Распределение длины. */
+    double dynamic = 0; /**< Доля команд в динамических блоках. */
+    size_t block_length = 8; /**< Команд в одном динамическом блоке. */
+    size_t depth = 1; /**< Глубина вложенности динамических блоков. */
+    unsigned seed = 1; /**< Зерно генератора. */
+    std::string output; /**< Файл вывода, "-" - стандартный вывод. */
+    std::string connect; /**< Адрес сервера: unix:/путь или tcp:порт. */
+    std::vector<std::string> exec; /**< Команда запуска дочернего bulk. */
+};
+
+void throwSystemError(const std::string& what) {
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+void writeAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t written = ::write(fd, data, size);
+
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            throwSystemError("write");
+        }
+
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+}
+
+/**
+ * @brief Класс StreamGenerator - источник строк потока команд.
+ *
+ * Поток состоит из единиц: одиночной статической команды или динамического
+ * блока из block_length команд. Динамический блок выбирается с такой
+ * вероятностью, чтобы доля команд в динамических блоках равнялась dynamic.
+ * При depth > 1 команды блока делятся пополам между ним и вложенным блоком,
+ * пока не будет достигнута заданная глубина.
+ * Команда начинается с "c<номер>_", по которому ищется ее время отправки.
+ */
+class StreamGenerator {
+public:
+    /**
+     * @brief Конструктор StreamGenerator.
+     *
+     * @param options Параметры генератора.
+     */
+    explicit StreamGenerator(const LoadgenOptions& options)
+        : options_(options), rng_(options.seed), letter_(0, 25),
+          exponential_(1.0 / static_cast<double>(options.length)) {
+        double dynamic = options.dynamic;
+        double block = static_cast<double>(options.block_length);
+        unit_dynamic_ = dynamic >= 1 ? 1 : dynamic / (dynamic + block * (1 - dynamic));
+    }
+
+    /**
+     * @brief Дописать следующую строку потока.
+     *
+     * @param out Буфер, в который дописывается строка с переводом строки.
+     * @return long long Номер команды или -1 для "{" и "}".
+     */
+    long long next(std::string& out) {
+        if (pending_.empty()) {
+            if (unit_(rng_) < unit_dynamic_) {
+                size_t commands = std::min(options_.block_length, options_.commands - generated_);
+                planBlock(commands, options_.depth);
+            } else {
+                pending_.push_back(kCommand);
+            }
+        }
+
+        char kind = pending_.front();
+        pending_.pop_front();
+
+        if (kind != kCommand) {
+            out.push_back(kind);
+            out.push_back('\n');
+            return -1;
+        }
+
+        size_t seq = generated_++;
+        size_t begin = out.size();
+        out += 'c';
+        out += std::to_string(seq);
+        out += '_';
+
+        for (size_t length = commandLength(); out.size() - begin < length;) {
+            out.push_back(static_cast<char>('a' + letter_(rng_)));
+        }
+
+        out.push_back('\n');
+        return static_cast<long long>(seq);
+    }
+
+    /**
+     * @brief Проверить, остались ли строки потока.
+     *
+     * @return bool Возвращает true, если не все команды сгенерированы или блок не закрыт.
+     */
+    bool hasNext() const {
+        return generated_ < options_.commands || !pending_.empty();
+    }
+
+private:
+    static constexpr char kCommand = 'c'; /**< Отметка команды в плане строк. */
+
+    /**
+     * @brief Запланировать динамический блок.
+     *
+     * @param commands Команд в блоке вместе с вложенными.
+     * @param depth Оставшаяся глубина вложенности.
+     */
+    void planBlock(size_t commands, size_t depth) {
+        pending_.push_back('{');
+
+        size_t own = depth > 1 ? commands - commands / 2 : commands;
+        pending_.insert(pending_.end(), own, kCommand);
+
+        if (depth > 1 && commands > own) {
+            planBlock(commands - own, depth - 1);
+        }
+
+        pending_.push_back('}');
+    }
+
+    /**
+     * @brief Выбрать длину очередной команды.
+     *
+     * @return size_t Длина без перевода строки.
+     */
+    size_t commandLength() {
+        switch (options_.distribution) {
+        case LengthDistribution::Uniform:
+            return std::uniform_int_distribution<size_t>(1, 2 * options_.length - 1)(rng_);
+        case LengthDistribution::Exponential:
+            return std::max<size_t>(1, static_cast<size_t>(exponential_(rng_)));
+        case LengthDistribution::Fixed:
+            break;
+        }
+
+        return options_.length;
+    }
+
+    const LoadgenOptions& options_; /**< Параметры генератора. */
+    std::mt19937_64 rng_; /**< Генератор случайных чисел. */
+    std::uniform_int_distribution<int> letter_; /**< Буква заполнения команды. */
+    std::uniform_real_distribution<double> unit_; /**< Выбор вида единицы потока. */
+    std::exponential_distribution<double> exponential_; /**< Экспоненциальная длина команды. */
+    double unit_dynamic_ = 0; /**< Вероятность динамического блока среди единиц. */
+    std::deque<char> pending_; /**< План строк текущей единицы. */
+    size_t generated_ = 0; /**< Сгенерировано команд. */
+};
+
+/**
+ * @brief Класс LatencyTracker - сопоставление отправленных и выведенных команд.
+ *
+ * Время отправки каждой команды хранится по ее номеру. Поток чтения
+ * разбирает строки "bulk: c1_..., c2_..." вывода дочернего bulk и
+ * записывает задержку каждой найденной команды в гистограмму.
+ */
+class LatencyTracker {
+public:
+    /**
+     * @brief Конструктор LatencyTracker.
+     *
+     * @param commands Количество команд.
+     */
+    explicit LatencyTracker(size_t commands)
+        : start_(std::chrono::steady_clock::now()), sent_(new std::atomic<int64_t>[commands]), commands_(commands) {
+        for (size_t i = 0; i < commands; ++i) {
+            sent_[i].store(-1, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Отметить отправку команды.
+     *
+     * @param seq Номер команды.
+     * @param now Время отправки.
+     */
+    void sent(size_t seq, std::chrono::steady_clock::time_point now) {
+        sent_[seq].store((now - start_).count(), std::memory_order_release);
+    }
+
+    /**
+     * @brief Прочитать вывод дочернего bulk до конца потока.
+     *
+     * @param fd Дескриптор стандартного вывода дочернего процесса.
+     */
+    void consume(int fd) {
+        std::vector<char> buffer(1 << 16);
+        std::string line;
+
+        for (;;) {
+            ssize_t size = ::read(fd, buffer.data(), buffer.size());
+
+            if (size < 0 && errno == EINTR) {
+                continue;
+            }
+
+            if (size <= 0) {
+                break;
+            }
+
+            auto now = std::chrono::steady_clock::now();
+            const char* data = buffer.data();
+            const char* end = data + size;
+
+            while (data < end) {
+                const char* newline = static_cast<const char*>(std::memchr(data, '\n', end - data));
+
+                if (newline == nullptr) {
+                    line.append(data, end);
+                    break;
+                }
+
+                line.append(data, newline);
+                onLine(line, now);
+                line.clear();
+                data = newline + 1;
+            }
+        }
+    }
+
+    /**
+     * @brief Гистограмма сквозных задержек.
+     */
+    const LatencyHistogram& histogram() const {
+        return histogram_;
+    }
+
+    /**
+     * @brief Количество команд, найденных в выводе.
+     */
+    size_t received() const {
+        return received_;
+    }
+
+private:
+    void onLine(std::string_view line, std::chrono::steady_clock::time_point now) {
+        constexpr std::string_view kPrefix = "bulk: ";
+
+        if (line.substr(0, kPrefix.size()) != kPrefix) {
+            return;
+        }
+
+        int64_t at = (now - start_).count();
+        line.remove_prefix(kPrefix.size());
+
+        while (!line.empty()) {
+            size_t seq = 0;
+            size_t i = 1;
+            bool valid = line[0] == 'c';
+
+            for (; i < line.size() && line[i] >= '0' && line[i] <= '9'; ++i) {
+                seq = seq * 10 + static_cast<size_t>(line[i] - '0');
+            }
+
+            if (valid && i > 1 && seq < commands_) {
+                int64_t sent = sent_[seq].load(std::memory_order_acquire);
+
+                if (sent >= 0) {
+                    histogram_.record(static_cast<uint64_t>(std::max<int64_t>(0, at - sent)));
+                    ++received_;
+                }
+            }
+
+            size_t separator = line.find(", ");
+            line.remove_prefix(separator == std::string_view::npos ? line.size() : separator + 2);
+        }
+    }
+
+    std::chrono::steady_clock::time_point start_; /**< Начало отсчета. */
+    std::unique_ptr<std::atomic<int64_t>[]> sent_; /**< Время отправки команд в нс, -1 - не отправлена. */
+    size_t commands_; /**< Количество команд. */
+    LatencyHistogram histogram_; /**< Сквозные задержки. */
+    size_t received_ = 0; /**< Найдено команд в выводе. */
+};
+
+/**
+ * @brief Дочерний процесс bulk со связанными каналами ввода и вывода.
+ */
+struct Child {
+    pid_t pid = -1; /**< Идентификатор процесса. */
+    int input = -1; /**< Запись в стандартный ввод процесса. */
+    int output = -1; /**< Чтение стандартного вывода процесса. */
+};
+
+Child spawn(const std::vector<std::string>& command) {
+    int input[2];
+    int output[2];
+
+    if (::pipe2(input, O_CLOEXEC) != 0 || ::pipe2(output, O_CLOEXEC) != 0) {
+        throwSystemError("pipe2");
+    }
+
+    std::vector<char*> argv;
+
+    for (const auto& arg : command) {
+        argv.push_back(const_cast<char*>(arg.c_str()));
+    }
+
+    argv.push_back(nullptr);
+
+    Child child;
+    child.pid = ::fork();
+
+    if (child.pid < 0) {
+        throwSystemError("fork");
+    }
+
+    if (child.pid == 0) {
+        ::dup2(input[0], STDIN_FILENO);
+        ::dup2(output[1], STDOUT_FILENO);
+        ::execvp(argv[0], argv.data());
+        std::fprintf(stderr, "Unable to exec %s: %s\n", argv[0], std::strerror(errno));
+        ::_exit(127);
+    }
+
+    ::close(input[0]);
+    ::close(output[1]);
+    child.input = input[1];
+    child.output = output[0];
+    return child;
+}
+
+int connectTo(const std::string& address) {
+    int fd = -1;
+
+    if (address.rfind("unix:", 0) == 0) {
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        std::string path = address.substr(5);
+
+        if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+            throw std::invalid_argument("Некорректный путь сокета: " + path);
+        }
+
+        std::strcpy(addr.sun_path, path.c_str());
+        fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+        if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            throwSystemError("Unable to connect to " + address);
+        }
+    } else if (address.rfind("tcp:", 0) == 0) {
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        try {
+            std::string text = address.substr(4);
+            size_t pos = 0;
+            unsigned long port = std::stoul(text, &pos);
+
+            if (pos != text.size() || port > 65535) {
+                throw std::out_of_range("port");
+            }
+
+            addr.sin_port = htons(static_cast<uint16_t>(port));
+        } catch (const std::exception&) {
+            throw std::invalid_argument("Некорректный порт: " + address.substr(4));
+        }
+
+        fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+        if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            throwSystemError("Unable to connect to " + address);
+        }
+    } else {
+        throw std::invalid_argument("Некорректный адрес: " + address + " (ожидается unix:/путь или tcp:порт)");
+    }
+
+    return fd;
+}
+
+/**
+ * @brief Итоги отправки потока.
+ */
+struct SendResult {
+    size_t commands = 0; /**< Отправлено команд. */
+    size_t bytes = 0; /**< Отправлено байтов. */
+    double seconds = 0; /**< Время отправки. */
+};
+
+SendResult sendStream(const LoadgenOptions& options, int fd, LatencyTracker* tracker) {
+    StreamGenerator generator(options);
+    std::string buffer;
+    std::vector<size_t> seqs;
+    SendResult result;
+
+    auto start = std::chrono::steady_clock::now();
+    auto interval = std::chrono::duration<double>(options.rate > 0 ? options.burst / options.rate : 0);
+    size_t burst = 0;
+
+    while (generator.hasNext()) {
+        buffer.clear();
+        seqs.clear();
+
+        // Пачка заканчивается после burst команд; скобки блока дописываются к ней.
+        // Без ограничения темпа пачки укрупняются до kWriteSize байтов
+        while (generator.hasNext()
+               && (seqs.size() < options.burst || buffer.empty() || (options.rate == 0 && buffer.size() < kWriteSize))) {
+            long long seq = generator.next(buffer);
+
+            if (seq >= 0) {
+                seqs.push_back(static_cast<size_t>(seq));
+            }
+        }
+
+        if (options.rate > 0) {
+            std::this_thread::sleep_until(start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(interval * burst));
+        }
+
+        if (tracker != nullptr) {
+            auto now = std::chrono::steady_clock::now();
+
+            for (size_t seq : seqs) {
+                tracker->sent(seq, now);
+            }
+        }
+
+        writeAll(fd, buffer.data(), buffer.size());
+        result.commands += seqs.size();
+        result.bytes += buffer.size();
+        ++burst;
+    }
+
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+void report(const SendResult& sent, const LatencyTracker* tracker) {
+    double seconds = std::max(sent.seconds, 1e-9);
+
+    std::fprintf(stderr, "sent: %zu commands, %.1f MB in %.3f s (%.0f cmd/s, %.1f MB/s)\n",
+                 sent.commands,
+                 sent.bytes / 1048576.0,
+                 sent.seconds,
+                 sent.commands / seconds,
+                 sent.bytes / seconds / 1048576.0);
+
+    if (tracker == nullptr) {
+        return;
+    }
+
+    const LatencyHistogram& histogram = tracker->histogram();
+    auto ms = [&histogram](double q) { return histogram.quantile(q) / 1e6; };
+
+    std::fprintf(stderr, "latency: received %zu of %zu, p50 %.3f ms, p90 %.3f ms, p99 %.3f ms, p99.9 %.3f ms, max %.3f ms\n",
+                 tracker->received(),
+                 sent.commands,
+                 ms(0.5),
+                 ms(0.9),
+                 ms(0.99),
+                 ms(0.999),
+                 ms(1.0));
+}
+
+double parseFraction(const std::string& text) {
+    size_t pos = 0;
+    double value = std::stod(text, &pos);
+
+    if (pos != text.size() || value < 0 || value > 1) {
+        throw std::invalid_argument("Доля должна быть в диапазоне [0, 1]: " + text);
+    }
+
+    return value;
+}
+
+LoadgenOptions parseOptions(int argc, char* argv[]) {
+    LoadgenOptions options;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+
+        // Все после "--" - команда запуска дочернего bulk
+        if (arg == "--") {
+            options.exec.assign(argv + i + 1, argv + argc);
+            break;
+        }
+
+        if (i + 1 >= argc) {
+            throw std::invalid_argument("Не задано значение параметра " + arg);
+        }
+
+        if (arg == "--commands") {
+            options.commands = std::stoul(argv[++i]);
+        } else if (arg == "--rate") {
+            options.rate = std::stod(argv[++i]);
+        } else if (arg == "--burst") {
+            options.burst = std::stoul(argv[++i]);
+        } else if (arg == "--length") {
+            options.length = std::stoul(argv[++i]);
+        } else if (arg == "--length-dist") {
+            std::string name = argv[++i];
+
+            if (name == "fixed") {
+                options.distribution = LengthDistribution::Fixed;
+            } else if (name == "uniform") {
+                options.distribution = LengthDistribution::Uniform;
+            } else if (name == "exp") {
+                options.distribution = LengthDistribution::Exponential;
+            } else {
+                throw std::invalid_argument("Неизвестное распределение длины: " + name);
+            }
+        } else if (arg == "--dynamic") {
+            options.dynamic = parseFraction(argv[++i]);
+        } else if (arg == "--block-length") {
+            options.block_length = std::stoul(argv[++i]);
+        } else if (arg == "--depth") {
+            options.depth = std::stoul(argv[++i]);
+        } else if (arg == "--seed") {
+            options.seed = static_cast<unsigned>(std::stoul(argv[++i]));
+        } else if (arg == "--output") {
+            options.output = argv[++i];
+        } else if (arg == "--connect") {
+            options.connect = argv[++i];
+        } else {
+            throw std::invalid_argument("Неизвестный параметр: " + arg);
+        }
+    }
+
+    if (options.rate < 0) {
+        throw std::invalid_argument("Темп не может быть отрицательным");
+    }
+
+    if (options.burst == 0 || options.length == 0 || options.block_length == 0 || options.depth == 0) {
+        throw std::invalid_argument("--burst, --length, --block-length и --depth должны быть больше 0");
+    }
+
+    if (!options.output.empty() + !options.connect.empty() + !options.exec.empty() > 1) {
+        throw std::invalid_argument("--output, --connect и запуск bulk несовместимы");
+    }
+
+    return options;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    LoadgenOptions options;
+
+    try {
+        options = parseOptions(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << "Ошибка: " << e.what() << "\n"
+                  << "Использование: bulk_loadgen [--commands M] [--rate R] [--burst B] [--length L]"
+                     " [--length-dist fixed|uniform|exp] [--dynamic F] [--block-length K] [--depth D] [--seed S]"
+                     " [--output FILE | --connect unix:/путь|tcp:порт | -- bulk N ...]\n";
+        return 1;
+    }
+
+    // Ошибка записи в закрытый канал обрабатывается как исключение
+    std::signal(SIGPIPE, SIG_IGN);
+
+    try {
+        if (!options.exec.empty()) {
+            Child child = spawn(options.exec);
+            LatencyTracker tracker(options.commands);
+            std::thread reader([&tracker, &child]() { tracker.consume(child.output); });
+
+            SendResult sent;
+            std::exception_ptr error;
+
+            try {
+                sent = sendStream(options, child.input, &tracker);
+            } catch (...) {
+                error = std::current_exception();
+            }
+
+            ::close(child.input);
+            reader.join();
+            ::close(child.output);
+
+            int status = 0;
+            ::waitpid(child.pid, &status, 0);
+
+            if (error) {
+                std::rethrow_exception(error);
+            }
+
+            report(sent, &tracker);
+
+            if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+                std::cerr << "Ошибка: bulk завершился с кодом " << (WIFEXITED(status) ? WEXITSTATUS(status) : -1) << std::endl;
+                return 1;
+            }
+        } else if (!options.connect.empty()) {
+            int fd = connectTo(options.connect);
+            SendResult sent = sendStream(options, fd, nullptr);
+            ::close(fd);
+            report(sent, nullptr);
+        } else {
+            int fd = STDOUT_FILENO;
+
+            if (!options.output.empty() && options.output != "-") {
+                fd = ::open(options.output.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+                if (fd < 0) {
+                    throwSystemError("Unable to open " + options.output);
+                }
+            }
+
+            SendResult sent = sendStream(options, fd, nullptr);
+
+            if (fd != STDOUT_FILENO) {
+                ::close(fd);
+            }
+
+            report(sent, nullptr);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Ошибка: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
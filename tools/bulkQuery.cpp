@@ -0,0 +1,485 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "../cmdLogger/ioVector.h"
+#include "../cmdLogger/timeIndex.h"
+#include "../cmdReader/mappedFile.h"
+
+#ifdef BULK_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+// Поиск блоков по времени в сохраненном выводе bulk --index. Индекс bulk.idx
+// каталога хранилища отображается в память, открываются только файлы
+// участков, пересекающих запрошенный интервал, и из них выбираются блоки
+// с временем начала в интервале (и, с --grep, содержащие строку). Блоки
+// выводятся в порядке времени и номера в формате записей сегмента.
+
+namespace {
+
+constexpr size_t kOutputBatch = 1024; /**< Блоков в одной векторной записи вывода. */
+
+/**
+ * @brief Параметры запроса.
+ */
+struct QueryOptions {
+    std::string dir = "."; /**< Каталог хранилища с индексом. */
+    long long from = std::numeric_limits<long long>::min(); /**< Начало интервала, секунды. */
+    long long to = std::numeric_limits<long long>::max(); /**< Конец интервала включительно, секунды. */
+    std::string grep; /**< Строка, которую должен содержать блок. */
+};
+
+/**
+ * @brief Найденный блок.
+ */
+struct Match {
+    long long ts; /**< Время начала блока. */
+    uint64_t seq; /**< Номер блока. */
+    std::string_view header; /**< Заголовок записи. */
+    std::string_view text; /**< Команды блока. */
+};
+
+void throwSystemError(const std::string& what) {
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+/**
+ * @brief Прочитать часть файла.
+ *
+ * @param path Путь к файлу.
+ * @param offset Смещение части.
+ * @param length Длина части.
+ * @return std::string Прочитанные байты.
+ * @throws std::system_error Если файл не удается прочитать.
+ * @throws std::runtime_error Если файл короче части.
+ */
+std::string readRange(const std::string& path, uint64_t offset, uint64_t length) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+    if (fd < 0) {
+        throwSystemError("Unable to open " + path);
+    }
+
+    std::string data(length, '\0');
+    size_t done = 0;
+
+    while (done < data.size()) {
+        ssize_t size = ::pread(fd, &data[done], data.size() - done, static_cast<off_t>(offset + done));
+
+        if (size < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if (size <= 0) {
+            int error = size < 0 ? errno : 0;
+            ::close(fd);
+
+            if (error != 0) {
+                throw std::system_error(error, std::generic_category(), "read " + path);
+            }
+
+            throw std::runtime_error(path + ": file is shorter than the index entry");
+        }
+
+        done += static_cast<size_t>(size);
+    }
+
+    ::close(fd);
+    return data;
+}
+
+/**
+ * @brief Распаковать последовательность членов gzip.
+ *
+ * @param data Сжатые данные из целых членов gzip.
+ * @param name Имя файла для сообщений об ошибках.
+ * @return std::string Распакованные данные.
+ * @throws std::runtime_error Если данные повреждены или bulk_query собран без zlib.
+ */
+std::string inflateMembers(std::string_view data, const std::string& name) {
+#ifdef BULK_HAVE_ZLIB
+    z_stream stream{};
+
+    if (inflateInit2(&stream, 16 + MAX_WBITS) != Z_OK) {
+        throw std::runtime_error("Unable to initialize zlib");
+    }
+
+    std::string out;
+    char buffer[64 << 10];
+
+    // Между членами и после последнего может быть нулевой хвост сегмента
+    while (!data.empty() && data.find_first_not_of('\0') != std::string_view::npos) {
+        data.remove_prefix(data.find_first_not_of('\0'));
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+        stream.avail_in = static_cast<uInt>(std::min<size_t>(data.size(), std::numeric_limits<uInt>::max()));
+        uInt avail = stream.avail_in;
+        int rc = Z_OK;
+
+        do {
+            stream.next_out = reinterpret_cast<Bytef*>(buffer);
+            stream.avail_out = sizeof(buffer);
+            rc = inflate(&stream, Z_NO_FLUSH);
+
+            if (rc != Z_OK && rc != Z_STREAM_END && rc != Z_BUF_ERROR) {
+                inflateEnd(&stream);
+                throw std::runtime_error(name + ": corrupted gzip data");
+            }
+
+            out.append(buffer, sizeof(buffer) - stream.avail_out);
+        } while (rc != Z_STREAM_END && (stream.avail_in > 0 || stream.avail_out == 0));
+
+        data.remove_prefix(avail - stream.avail_in);
+
+        if (rc != Z_STREAM_END) {
+            if (data.empty()) {
+                inflateEnd(&stream);
+                throw std::runtime_error(name + ": unexpected end of gzip data");
+            }
+
+            continue;
+        }
+
+        inflateReset(&stream);
+    }
+
+    inflateEnd(&stream);
+    return out;
+#else
+    (void)data;
+    throw std::runtime_error(name + ": bulk_query is built without zlib");
+#endif
+}
+
+/**
+ * @brief Класс IndexQuery - выбор блоков по индексу каталога хранилища.
+ */
+class IndexQuery {
+public:
+    /**
+     * @brief Конструктор IndexQuery.
+     *
+     * @param options Параметры запроса.
+     */
+    explicit IndexQuery(const QueryOptions& options) : options_(options) {}
+
+    /**
+     * @brief Найти блоки запроса.
+     *
+     * @throws std::system_error Если индекс не удается открыть.
+     * @throws std::runtime_error Если индекс имеет другой формат.
+     */
+    void run() {
+        MappedFile index(options_.dir + "/" + TimeIndex::kFileName);
+        std::string_view bytes = index.bytes();
+        TimeIndex::Header header{};
+
+        if (bytes.size() < sizeof(header)) {
+            throw std::runtime_error("Unsupported index format: " + options_.dir + "/" + TimeIndex::kFileName);
+        }
+
+        std::memcpy(&header, bytes.data(), sizeof(header));
+
+        if (std::memcmp(header.magic, TimeIndex::kMagic, sizeof(TimeIndex::kMagic)) != 0
+            || header.version != TimeIndex::kVersion || header.entrySize != sizeof(TimeIndex::Entry)) {
+            throw std::runtime_error("Unsupported index format: " + options_.dir + "/" + TimeIndex::kFileName);
+        }
+
+        // Последний файл блока с тем же именем перезаписывает предыдущие
+        std::map<std::string, TimeIndex::Entry> files;
+        size_t count = (bytes.size() - sizeof(header)) / sizeof(TimeIndex::Entry);
+        auto entryAt = [&bytes](size_t i) {
+            TimeIndex::Entry entry;
+            std::memcpy(&entry, bytes.data() + sizeof(TimeIndex::Header) + i * sizeof(entry), sizeof(entry));
+            return entry;
+        };
+
+        // Граница записей не убывает: записи до первой с границей не меньше
+        // начала интервала целиком раньше интервала и не читаются
+        size_t first = 0;
+
+        for (size_t last = count; first < last;) {
+            size_t middle = first + (last - first) / 2;
+
+            if (TimeIndex::horizon(entryAt(middle)) < options_.from) {
+                first = middle + 1;
+            } else {
+                last = middle;
+            }
+        }
+
+        for (size_t i = first; i < count; ++i) {
+            TimeIndex::Entry entry = entryAt(i);
+
+            if (entry.maxTs < options_.from || entry.minTs > options_.to) {
+                continue;
+            }
+
+            if ((entry.flags & TimeIndex::kSegment) == 0) {
+                files[TimeIndex::dataFileName(entry)] = entry;
+                continue;
+            }
+
+            guard([this, &entry]() { readSegmentSpan(entry); });
+        }
+
+        for (const auto& [name, entry] : files) {
+            guard([this, &entry]() { readBlockFile(entry); });
+        }
+
+        std::stable_sort(matches_.begin(), matches_.end(), [](const Match& a, const Match& b) {
+            return a.ts != b.ts ? a.ts < b.ts : a.seq < b.seq;
+        });
+    }
+
+    /**
+     * @brief Вывести найденные блоки в стандартный вывод.
+     *
+     * @throws std::system_error Если вывод не удается записать.
+     */
+    void print() const {
+        IoVector iov;
+
+        for (size_t i = 0; i < matches_.size(); ++i) {
+            iov.add(matches_[i].header);
+            iov.add(matches_[i].text);
+
+            if ((i + 1) % kOutputBatch == 0) {
+                iov.writeTo(STDOUT_FILENO);
+                iov.clear();
+            }
+        }
+
+        iov.writeTo(STDOUT_FILENO);
+    }
+
+    /**
+     * @brief Получить признак пропущенных участков.
+     *
+     * @return bool Возвращает true, если часть файлов не удалось прочитать.
+     */
+    bool incomplete() const {
+        return incomplete_;
+    }
+
+private:
+    /**
+     * @brief Выполнить чтение участка, сообщив об ошибке и продолжив запрос.
+     *
+     * Файлы могли быть удалены или повреждены после записи индекса.
+     *
+     * @param read Чтение участка.
+     */
+    template <typename Read>
+    void guard(Read read) {
+        try {
+            read();
+        } catch (const std::exception& e) {
+            std::cerr << "Ошибка: " << e.what() << std::endl;
+            incomplete_ = true;
+        }
+    }
+
+    /**
+     * @brief Выбрать блоки участка сегмента.
+     *
+     * @param entry Запись индекса.
+     */
+    void readSegmentSpan(const TimeIndex::Entry& entry) {
+        std::string path = options_.dir + "/" + TimeIndex::dataFileName(entry);
+        std::string_view data;
+
+        if ((entry.flags & TimeIndex::kCompressed) != 0) {
+            data = keep(inflateMembers(readRange(path, entry.offset, entry.length), path));
+        } else {
+            const MappedFile& segment = mapped(path);
+
+            if (entry.offset + entry.length > segment.bytes().size()) {
+                throw std::runtime_error(path + ": file is shorter than the index entry");
+            }
+
+            data = segment.bytes().substr(entry.offset, entry.length);
+        }
+
+        while (!data.empty()) {
+            size_t end = data.find('\n');
+            long long ts = 0;
+            unsigned long long seq = 0;
+            size_t count = 0;
+            size_t size = 0;
+
+            if (end == std::string_view::npos
+                || std::sscanf(std::string(data.substr(0, end)).c_str(), "bulk ts=%lld seq=%llu count=%zu bytes=%zu",
+                               &ts, &seq, &count, &size) != 4
+                || data.size() - end - 1 < size) {
+                throw std::runtime_error(path + ": corrupted segment record at index offset "
+                                         + std::to_string(entry.offset));
+            }
+
+            add(ts, seq, data.substr(0, end + 1), data.substr(end + 1, size));
+            data.remove_prefix(end + 1 + size);
+        }
+    }
+
+    /**
+     * @brief Выбрать блок из файла отдельного блока.
+     *
+     * @param entry Запись индекса.
+     */
+    void readBlockFile(const TimeIndex::Entry& entry) {
+        std::string path = options_.dir + "/" + TimeIndex::dataFileName(entry);
+        std::string_view text;
+
+        if ((entry.flags & TimeIndex::kCompressed) != 0) {
+            struct stat st {};
+
+            if (::stat(path.c_str(), &st) != 0) {
+                throwSystemError("Unable to open " + path);
+            }
+
+            text = keep(inflateMembers(readRange(path, 0, static_cast<uint64_t>(st.st_size)), path));
+        } else {
+            text = mapped(path).bytes();
+        }
+
+        // Файл блока не содержит заголовка, он составляется по записи индекса
+        std::string_view header = keep("bulk ts=" + std::to_string(entry.fileTs)
+                                       + " seq=" + std::to_string(entry.fileSeq)
+                                       + " count=" + std::to_string(std::count(text.begin(), text.end(), '\n'))
+                                       + " bytes=" + std::to_string(text.size()) + "\n");
+
+        add(entry.fileTs, entry.fileSeq, header, text);
+    }
+
+    /**
+     * @brief Добавить блок, если он подходит под запрос.
+     */
+    void add(long long ts, uint64_t seq, std::string_view header, std::string_view text) {
+        if (ts < options_.from || ts > options_.to) {
+            return;
+        }
+
+        if (!options_.grep.empty() && text.find(options_.grep) == std::string_view::npos) {
+            return;
+        }
+
+        matches_.push_back(Match{ts, seq, header, text});
+    }
+
+    /**
+     * @brief Сохранить данные до вывода.
+     *
+     * @param data Данные.
+     * @return std::string_view Сохраненные данные.
+     */
+    std::string_view keep(std::string data) {
+        buffers_.push_back(std::move(data));
+        return buffers_.back();
+    }
+
+    /**
+     * @brief Получить отображение файла, открыв его при первом обращении.
+     *
+     * @param path Путь к файлу.
+     * @return const MappedFile& Отображение файла.
+     */
+    const MappedFile& mapped(const std::string& path) {
+        auto it = files_.find(path);
+
+        if (it == files_.end()) {
+            it = files_.emplace(path, std::make_unique<MappedFile>(path)).first;
+        }
+
+        return *it->second;
+    }
+
+    QueryOptions options_; /**< Параметры запроса. */
+    std::vector<Match> matches_; /**< Найденные блоки. */
+    std::deque<std::string> buffers_; /**< Распакованные данные и составленные заголовки. */
+    std::map<std::string, std::unique_ptr<MappedFile>> files_; /**< Отображенные файлы данных. */
+    bool incomplete_ = false; /**< Часть участков не удалось прочитать. */
+};
+
+long long parseTime(const std::string& name, const std::string& text) {
+    size_t pos = 0;
+    long long value = 0;
+
+    try {
+        value = std::stoll(text, &pos);
+    } catch (const std::exception&) {
+        pos = 0;
+    }
+
+    if (pos == 0 || pos != text.size()) {
+        throw std::invalid_argument("Некорректное значение параметра " + name + ": " + text);
+    }
+
+    return value;
+}
+
+QueryOptions parseOptions(int argc, char* argv[]) {
+    QueryOptions options;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+
+        if (i + 1 >= argc) {
+            throw std::invalid_argument("Не задано значение параметра " + arg);
+        }
+
+        if (arg == "--dir") {
+            options.dir = argv[++i];
+        } else if (arg == "--from") {
+            options.from = parseTime(arg, argv[++i]);
+        } else if (arg == "--to") {
+            options.to = parseTime(arg, argv[++i]);
+        } else if (arg == "--grep") {
+            options.grep = argv[++i];
+        } else {
+            throw std::invalid_argument("Неизвестный параметр: " + arg);
+        }
+    }
+
+    if (options.from > options.to) {
+        throw std::invalid_argument("--from не может быть больше --to");
+    }
+
+    return options;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    QueryOptions options;
+
+    try {
+        options = parseOptions(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << "Ошибка: " << e.what() << "\n"
+                  << "Использование: bulk_query [--dir DIR] [--from TS] [--to TS] [--grep TEXT]\n";
+        return 1;
+    }
+
+    try {
+        IndexQuery query(options);
+        query.run();
+        query.print();
+        return query.incomplete() ? 1 : 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Ошибка: " << e.what() << std::endl;
+        return 1;
+    }
+}